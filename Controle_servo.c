@@ -1,12 +1,37 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
-#include <gpiod.h>
 #include <string.h>
+#include <getopt.h>
+
+#include "pwm.h"
+#include "agendador.h"
+#include "tempo_real.h"
+#include "registro.h"
+#include "tabela.h"
+#include "leds.h"
+#include "indicador.h"
+#include "servos.h"
+#include "instrumentacao.h"
+#include "backend.h"
+#include "simulado.h"
+#include "servidor.h"
+#include "protocolo.h"
+#include "memoria.h"
+#include "entradas.h"
+#include "realimentacao.h"
+#include "encerramento.h"
+#include "metricas.h"
+#include "gravador.h"
+#include "reproducao.h"
+#include "configuracao.h"
+#include "supervisor.h"
+
+// Padrões de partida; o arquivo de --config sobrepõe cada um
 
 // Define as macros para os diretórios PWM
 #define PWM_CHIP "/sys/class/pwm/pwmchip0"
-#define PWM0 PWM_CHIP "/pwm0"
+#define PWM_CANAL 0                 // Canal pwm0 do chip
 
 // Parâmetros do servomotor (em nanosegundos)
 #define PERIODO_PWM 20000000        // 20ms = 50Hz
@@ -19,181 +44,929 @@
 #define LED1_PIN 0                 // Pino Led do GPIOC0
 #define LED2_PIN 26                 // Pino Led do GPIOC26
 
-// Número de passos para movimentação suave
+// Número de passos da varredura linear (define a velocidade do perfil linear)
 #define NUM_PASSOS 100
 #define DELAY_PASSO 20000           // 20ms entre passos
+#define PAUSA_EXTREMOS 1000000      // 1s parado em 0° e 180° (em us)
+
+// Modo sincronizado com os quadros do PWM
+#define MARGEM_QUADRO 2000          // Escrita 2ms antes da borda do quadro (em us)
+
+// Estado compartilhado com o laço de controle
+typedef struct {
+    GrupoServos *servos;
+    LedsIndicadores *leds;
+    FilaRegistro *log;
+    long periodo_passo_ns;          // Intervalo entre ticks
+    int sincronizar;                // 1 = ticks em fase com o quadro do PWM
+    long margem_ns;                 // Antecedência da escrita no quadro
+    const Relogio *relogio;         // Relógio do backend
+    unsigned long ciclos;           // Ciclos a executar (0 = infinito)
+    int silencioso;                 // 1 = não registrar cada passo
+    Servidor *servidor;             // Modo servidor de comandos (NULL = varredura)
+    MemoriaControle *memoria;       // Modo memória compartilhada (NULL = varredura)
+    Encerramento *encerramento;     // Sinal de encerramento e estacionamento
+    Metricas *metricas;             // Exportador de métricas (NULL = desligado)
+    Gravador *gravador;             // Gravador de telemetria (NULL = desligado)
+    Reproducao *reproducao;         // Modo roteiro (NULL = varredura)
+    const PerfilMovimento *perfil;  // Perfil das aproximações do roteiro
+    Supervisor *supervisor;         // Batimento e escalada dos deadlines perdidos
+} ContextoServo;
+
+// LEDs e console acompanham o primeiro servo do grupo
+static void mostrarPasso(ContextoServo *ctx) {
+    const Servo *s = &ctx->servos->servos[0];
+    const PassoTabela *p = s->ultimo;
+    INSTR_INICIO(t_gpio);
+    unsigned int leds = indicarLeds(ctx->leds, estadoServo(s), p->angulo);
+    INSTR_FIM(FASE_GPIO, t_gpio);
+    
+    if (!ctx->silencioso) {
+        INSTR_INICIO(t_reg);
+        registrarPasso(ctx->log, p->duty, p->angulo, leds);
+        INSTR_FIM(FASE_REGISTRO, t_reg);
+    }
+}
+
+// Avança os movimentos iniciados até todos terminarem; retorna 0 se o
+// encerramento foi pedido no meio
+static int acompanharMovimentos(ContextoServo *ctx, Agendador *agendador) {
+    GrupoServos *servos = ctx->servos;
+    
+    while (!encerramentoPedido(ctx->encerramento)) {
+        INSTR_INICIO(t_pwm);
+        if (avancarServos(servos) == 0) {
+            return 1;
+        }
+        INSTR_FIM(FASE_PWM, t_pwm);
+        
+        // ===== 7 e 8) Controlar LEDs baseado no ângulo =====
+        mostrarPasso(ctx);
+        publicarMetricas(ctx->metricas, agendador, 1);
+        gravarPassos(ctx->gravador, agendador, 1);
+        baterSupervisor(ctx->supervisor, agendador);
+        
+        esperarProximoTick(agendador);
+    }
+    return 0;
+}
+
+// Reproduz a trajetória de subida ou de descida em todos os servos;
+// retorna 0 se o encerramento foi pedido no meio
+static int reproduzirMovimento(ContextoServo *ctx, Agendador *agendador,
+                               int descida) {
+    GrupoServos *servos = ctx->servos;
+    
+    for (int i = 0; i < servos->num; i++) {
+        Servo *s = &servos->servos[i];
+        iniciarMovimento(s, descida ? &s->cal->descida : &s->cal->subida);
+    }
+    return acompanharMovimentos(ctx, agendador);
+}
+
+// Estaciona os servos no fim do laço; o movimento ganha o prazo do
+// estacionamento até o próximo batimento
+static void estacionar(ContextoServo *ctx) {
+    renovarSupervisor(ctx->supervisor, ctx->encerramento->prazo_ms * 1000000LL);
+    estacionarServos(ctx->encerramento, ctx->servos, ctx->leds, ctx->relogio);
+}
 
-// Função que escreve em arquivos do sysfs
-void writeToFile(const char *path, const char *value) {
-    FILE *fp = fopen(path, "w");
-    if (fp == NULL) {
-        perror("Erro ao abrir arquivo");
-        exit(1);
+// Pausa nos extremos; retorna 0 se o encerramento foi pedido no meio. Em
+// malha fechada o controle continua em cada tick, segurando a posição
+// medida; em malha aberta nada é escrito, mas os ticks contam o prazo de
+// repouso dos servos parados
+static int pausar(ContextoServo *ctx, Agendador *agendador, int ticks) {
+    GrupoServos *servos = ctx->servos;
+    
+    if (!servos->realimentacao) {
+        const Servo *s = &servos->servos[0];
+        indicarLeds(ctx->leds, estadoServo(s), s->ultimo->angulo);
+    }
+    for (int i = 0; i < ticks; i++) {
+        if (encerramentoPedido(ctx->encerramento)) {
+            return 0;
+        }
+        const PassoTabela *anterior = servos->servos[0].ultimo;
+        avancarServos(servos);
+        int escreveu = servos->servos[0].ultimo != anterior;
+        if (escreveu) {
+            mostrarPasso(ctx);
+        }
+        publicarMetricas(ctx->metricas, agendador, escreveu);
+        gravarPassos(ctx->gravador, agendador, escreveu);
+        baterSupervisor(ctx->supervisor, agendador);
+        esperarProximoTick(agendador);
     }
-    fprintf(fp, "%s", value);
-    fclose(fp);
+    return 1;
 }
 
-// Função para inicializar o PWM
-void inicializarPWM() {
-    printf("Inicializando PWM...\n");
+// Laço de varredura 0° -> 180° -> 0° (executado na thread de controle)
+static void *executarVarredura(void *arg) {
+    ContextoServo *ctx = arg;
     
-    // Exportar PWM0
-    writeToFile(PWM_CHIP "/export", "0");
-    sleep(1); // Aguardar a criação dos arquivos
+    // Iniciar a grade de ticks com deadlines absolutos. No modo
+    // sincronizado o tick é o próprio período do PWM, ancorado no instante
+    // em que o primeiro canal foi habilitado, e a escrita acontece
+    // margem_ns antes de cada borda: cada quadro recebe exatamente uma
+    // atualização
+    Agendador agendador;
+    if (ctx->sincronizar) {
+        iniciarAgendadorEm(&agendador, ctx->relogio, ctx->periodo_passo_ns,
+                           &ctx->servos->servos[0].pwm.habilitado_em,
+                           -ctx->margem_ns);
+    } else {
+        iniciarAgendador(&agendador, ctx->relogio, ctx->periodo_passo_ns);
+    }
+    int ticks_pausa = (int)(PAUSA_EXTREMOS * 1000LL / ctx->periodo_passo_ns);
+    unsigned long ciclo = 0;
     
-    // Configurar o período para 20ms (50Hz)
-    char periodo[20];
-    sprintf(periodo, "%d", PERIODO_PWM);
-    writeToFile(PWM0 "/period", periodo);
+    // Loop infinito (ou até completar ctx->ciclos ciclos ou chegar o
+    // sinal de encerramento)
+    while (ctx->ciclos == 0 || ciclo < ctx->ciclos) {
+        // ===== 4) Incrementar duty cycle: 0° -> 180° =====
+        registrarEvento(ctx->log, REG_SUBIDA);
+        if (!reproduzirMovimento(ctx, &agendador, 0)) {
+            break;
+        }
+        
+        registrarEvento(ctx->log, REG_FIM_VARREDURA);
+        if (!pausar(ctx, &agendador, ticks_pausa)) { // Pausa na posição 180°
+            break;
+        }
+        
+        // ===== 5) Decrementar duty cycle: 180° -> 0° =====
+        registrarEvento(ctx->log, REG_DESCIDA);
+        if (!reproduzirMovimento(ctx, &agendador, 1)) {
+            break;
+        }
+        
+        // Relatório de deadlines perdidos no ciclo
+        RegistroLog reg;
+        reg.tipo = REG_CICLO;
+        reg.ciclo.numero = (uint32_t)++ciclo;
+        reg.ciclo.overruns = (uint32_t)agendador.overruns_ciclo;
+        reg.ciclo.atraso_max_us = (uint32_t)(agendador.atraso_max_ns / 1000);
+        reg.ciclo.overruns_total = (uint32_t)agendador.overruns_total;
+        registrar(ctx->log, &reg);
+        zerarCicloAgendador(&agendador);
+        
+        if (!pausar(ctx, &agendador, ticks_pausa)) { // Pausa na posição 0°
+            break;
+        }
+        
+        // ===== 6) Loop se repete indefinidamente =====
+    }
     
-    // Configurar duty cycle inicial (posição 0°)
-    char duty[20];
-    sprintf(duty, "%d", DUTY_MIN);
-    writeToFile(PWM0 "/duty_cycle", duty);
+    estacionar(ctx);
+    return NULL;
+}
+
+// Registra o início ou o fim da passada atual do roteiro
+static void registrarPassada(ContextoServo *ctx, int inicio) {
+    RegistroLog reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.tipo = REG_ROTEIRO;
+    reg.roteiro.passada = (uint32_t)ctx->reproducao->passadas + 1;
+    reg.roteiro.posicao_ms = (uint32_t)(ctx->reproducao->posicao_ns / 1000000);
+    reg.roteiro.inicio = (uint8_t)inicio;
+    registrar(ctx->log, &reg);
+}
+
+// Laço do roteiro (executado na thread de controle): cada passada começa
+// com a aproximação do primeiro ângulo e segue o arquivo tick a tick
+static void *executarRoteiro(void *arg) {
+    ContextoServo *ctx = arg;
+    Reproducao *r = ctx->reproducao;
+    Agendador agendador;
     
-    // Ativar PWM
-    writeToFile(PWM0 "/enable", "1");
+    iniciarAgendador(&agendador, ctx->relogio, ctx->periodo_passo_ns);
+    do {
+        registrarPassada(ctx, 1);
+        if (planejarEntradaReproducao(r, ctx->servos, ctx->perfil) < 0 ||
+            !acompanharMovimentos(ctx, &agendador)) {
+            break;
+        }
+        
+        int continua = 1;
+        while (continua && !encerramentoPedido(ctx->encerramento)) {
+            INSTR_INICIO(t_pwm);
+            continua = avancarReproducao(r, ctx->servos);
+            INSTR_FIM(FASE_PWM, t_pwm);
+            
+            mostrarPasso(ctx);
+            publicarMetricas(ctx->metricas, &agendador, 1);
+            gravarPassos(ctx->gravador, &agendador, 1);
+            baterSupervisor(ctx->supervisor, &agendador);
+            esperarProximoTick(&agendador);
+        }
+        if (continua) {
+            break;                  // Encerramento no meio da passada
+        }
+        registrarPassada(ctx, 0);
+    } while (proximaPassadaReproducao(r));
     
-    printf("PWM inicializado com sucesso!\n");
+    estacionar(ctx);
+    return NULL;
 }
 
-// Função para definir o duty cycle do PWM
-void setPWMDutyCycle(int duty_cycle) {
-    char duty[20];
-    sprintf(duty, "%d", duty_cycle);
-    writeToFile(PWM0 "/duty_cycle", duty);
+// Laço do servidor de comandos (executado na thread de controle)
+static void *executarComandos(void *arg) {
+    ContextoServo *ctx = arg;
+    executarServidor(ctx->servidor);
+    estacionar(ctx);
+    return NULL;
 }
 
-// Função para converter duty cycle em ângulo (0-180°)
-int dutyParaAngulo(int duty_cycle) {
-    return ((duty_cycle - DUTY_MIN) * 180) / (DUTY_MAX - DUTY_MIN);
+// Laço da memória compartilhada (executado na thread de controle)
+static void *executarAlvosMemoria(void *arg) {
+    ContextoServo *ctx = arg;
+    executarMemoria(ctx->memoria);
+    estacionar(ctx);
+    return NULL;
 }
 
-// Função para desativar PWM
-void desativarPWM() {
-    printf("Desativando PWM...\n");
-    writeToFile(PWM0 "/enable", "0");
-    writeToFile(PWM_CHIP "/unexport", "0");
+// Mostra as opções de linha de comando
+static void mostrarUso(const char *programa) {
+    printf("Uso: %s [opções]\n"
+           "  --servo C:N[:MIN:MAX] adiciona o canal N do pwmchip C (repetível)\n"
+           "  --perfil P         linear, trapezoidal ou scurve (padrão scurve)\n"
+           "  --vel V            velocidade máxima em graus/s\n"
+           "  --acel A           aceleração máxima em graus/s² (padrão %.0f)\n"
+           "  --jerk J           jerk máximo em graus/s³ (padrão %.0f)\n"
+           "  --duracao S        duração de cada varredura em segundos\n"
+           "  --sincronizar      um passo por quadro do PWM, em fase com o quadro\n"
+           "  --margem US        antecedência da escrita no quadro (padrão %d us)\n"
+           "  --servidor         recebe posições pela rede em vez da varredura\n"
+           "  --porta N          porta UDP do servidor (padrão %d, 0 = sem UDP)\n"
+           "  --socket CAMINHO   socket Unix do servidor (padrão %s)\n"
+           "  --atraso-fluxo MS  profundidade do buffer de jitter (padrão %d ms)\n"
+           "  --subfluxo M       buffer vazio: manter ou extrapolar (padrão manter)\n"
+           "  --entrada T:P[:S]  entrada do servidor: emergencia:PINO, min:PINO:SERVO\n"
+           "                     ou max:PINO:SERVO (repetível)\n"
+           "  --chip-entradas C  gpiochip das entradas (padrão %s)\n"
+           "  --adc DISP         realimentação pelo ADC IIO DISP (ex.: iio:device0)\n"
+           "  --sensor C[:B0:B180] canal do ADC do próximo servo e leituras em 0/180°\n"
+           "  --gatilho-adc NOME trigger IIO da captura (padrão: o atual)\n"
+           "  --pid KP:KI:KD     ganhos do controlador (padrão %.1f:%.1f:%.1f)\n"
+           "  --antecipacao S    feed-forward da velocidade da referência (s)\n"
+           "  --leds S,S,...     saídas dos LEDs: linha do gpiochip, LED da classe\n"
+           "                     leds ou pwmchipN/C (padrão %d,%d)\n"
+           "  --indicador ARQ    tabela estado/ângulo -> LEDs, recarregada ao salvar\n"
+           "  --repouso MS[:M]   desliga a saída após MS parado (M = desligar ou zerar)\n"
+           "  --parque GRAUS     posição de estacionamento no encerramento (padrão %.0f)\n"
+           "  --prazo-parque MS  prazo do estacionamento (padrão %d)\n"
+           "  --memoria[=NOME]   alvos e estado em memória compartilhada (padrão %s)\n"
+           "  --metricas[=PORTA] exporta métricas Prometheus em HTTP (padrão %d)\n"
+           "  --roteiro ARQ      reproduz o roteiro ARQ em vez da varredura\n"
+           "  --velocidade F     escala de tempo do roteiro (padrão 1.0)\n"
+           "  --repetir[=N]      repete o roteiro N vezes (sem N: sem fim)\n"
+           "  --inicio S         começa a primeira passada em S segundos do roteiro\n"
+           "  --gravar ARQ[:N]   grava cada passo em um anel de N registros mapeado\n"
+           "                     do arquivo ARQ (padrão %d)\n"
+           "  --config ARQ       arquivo de configuração (SIGHUP recarrega as faixas)\n"
+           "  --watchdog[=DISP]  alimenta o watchdog de hardware (padrão %s)\n"
+           "  --prazo-batimento MS laço sem batimento por MS = travado (padrão %d)\n"
+           "  --escalada A:D:P   deadlines perdidos seguidos para aviso, degradação e\n"
+           "                     estacionamento (padrão %d:%d:%d, 0 = desligado)\n"
+           "  --pwm-direto       escreve o duty nos registros do PWM (/dev/mem)\n"
+           "  --simulado         backend em memória com relógio virtual\n"
+           "  --ciclos N         encerra após N ciclos (padrão: infinito)\n"
+           "  --latencia-sim US  custo virtual de cada escrita simulada\n"
+           "  --silencioso       não imprime cada passo\n"
+           "  --rt               executa o laço em uma thread SCHED_FIFO\n"
+           "  --prioridade N     prioridade SCHED_FIFO (padrão %d)\n"
+           "  --cpu N            núcleo da thread de controle (padrão: isolado)\n"
+           "  --ajuda            mostra esta mensagem\n",
+           programa, ACEL_MAX_PADRAO, JERK_MAX_PADRAO, MARGEM_QUADRO,
+           PROTOCOLO_PORTA, PROTOCOLO_SOCKET, FLUXO_ATRASO_PADRAO_MS, GPIO_CHIP,
+           KP_PADRAO, KI_PADRAO, KD_PADRAO, LED1_PIN, LED2_PIN,
+           PARQUE_ANGULO_PADRAO, PARQUE_PRAZO_MS_PADRAO, SEGMENTO_NOME_PADRAO, METRICAS_PORTA_PADRAO,
+           GRAVACAO_REGISTROS_PADRAO, SUPERVISOR_WATCHDOG_PADRAO, SUPERVISOR_PRAZO_MS_PADRAO,
+           SUPERVISOR_AVISO_PADRAO, SUPERVISOR_DEGRADAR_PADRAO, SUPERVISOR_PARQUE_PADRAO,
+           PRIORIDADE_RT_PADRAO);
 }
 
-int main() {
-    struct gpiod_chip *chip;
-    struct gpiod_line *led1, *led2;
-    int ret;
+int main(int argc, char *argv[]) {
+    static GrupoServos servos;
+    ConfigServo canais[SERVOS_MAX];
+    int num_canais = 0;
+    LedsIndicadores leds;
+    Configuracao config = {
+        .pwm_chip = PWM_CHIP, .pwm_canal = PWM_CANAL, .periodo_pwm = PERIODO_PWM,
+        .duty_min = DUTY_MIN, .duty_max = DUTY_MAX, .gpio_chip = GPIO_CHIP,
+        .leds = { { SAIDA_GPIO, LED1_PIN, "", 0 }, { SAIDA_GPIO, LED2_PIN, "", 0 } },
+        .num_leds = 2, .num_passos = NUM_PASSOS, .passo_us = DELAY_PASSO,
+    };
+    const Configuracao padroes = config;
+    const char *arquivo_config = NULL;
+    ConfigTempoReal rt = { 0, PRIORIDADE_RT_PADRAO, -1 };
+    PerfilMovimento perfil = { PERFIL_SCURVE, 0.0, ACEL_MAX_PADRAO, JERK_MAX_PADRAO };
+    double duracao = 0.0;
+    int sincronizar = 0;
+    long margem_us = MARGEM_QUADRO;
+    const Backend *backend = &BACKEND_SYSFS;
+    unsigned long ciclos = 0;
+    int silencioso = 0;
+    int modo_servidor = 0;
+    const char *nome_memoria = NULL;
+    int porta_metricas = -1;
+    char arquivo_gravacao[256] = "";
+    uint32_t capacidade_gravacao = GRAVACAO_REGISTROS_PADRAO;
+    const char *arquivo_roteiro = NULL;
+    double velocidade_roteiro = 1.0;
+    double inicio_roteiro = 0.0;
+    unsigned long repeticoes_roteiro = 1;
+    ConfigServidor cfg_servidor = { PROTOCOLO_PORTA, PROTOCOLO_SOCKET,
+                                    FLUXO_ATRASO_PADRAO_MS * 1000000L,
+                                    SUBFLUXO_MANTER };
+    ConfigEntrada cfg_entradas[ENTRADAS_MAX];
+    unsigned int num_entradas = 0;
+    const char *chip_entradas = NULL;
+    const char *dispositivo_adc = NULL;
+    const char *gatilho_adc = NULL;
+    ConfigSensor sensores[SERVOS_MAX];
+    int num_sensores = 0;
+    ConfigSaidaLed saidas_leds[LEDS_MAX];
+    unsigned int num_leds;
+    const char *arquivo_indicador = NULL;
+    long repouso_ms = 0;
+    ModoRepouso modo_repouso = REPOUSO_DESLIGAR;
+    double angulo_parque = PARQUE_ANGULO_PADRAO;
+    long prazo_parque = PARQUE_PRAZO_MS_PADRAO;
+    GanhosControle ganhos = { KP_PADRAO, KI_PADRAO, KD_PADRAO, 0.0,
+                              INTEGRAL_MAX_PADRAO, LIMITE_ERRO_PADRAO };
+    ConfigSupervisor cfg_supervisor = { NULL, SUPERVISOR_PRAZO_MS_PADRAO,
+                                        { SUPERVISOR_AVISO_PADRAO, SUPERVISOR_DEGRADAR_PADRAO,
+                                          SUPERVISOR_PARQUE_PADRAO } };
+    
+    static const struct option opcoes[] = {
+        { "servo",      required_argument, NULL, 's' },
+        { "perfil",     required_argument, NULL, 'P' },
+        { "vel",        required_argument, NULL, 'v' },
+        { "acel",       required_argument, NULL, 'a' },
+        { "jerk",       required_argument, NULL, 'j' },
+        { "duracao",    required_argument, NULL, 'd' },
+        { "sincronizar", no_argument,      NULL, 'S' },
+        { "margem",     required_argument, NULL, 'm' },
+        { "servidor",   no_argument,       NULL, 'e' },
+        { "porta",      required_argument, NULL, 'u' },
+        { "socket",     required_argument, NULL, 'U' },
+        { "atraso-fluxo", required_argument, NULL, 'A' },
+        { "subfluxo",   required_argument, NULL, 'F' },
+        { "entrada",    required_argument, NULL, 'i' },
+        { "chip-entradas", required_argument, NULL, 'g' },
+        { "adc",        required_argument, NULL, 'I' },
+        { "sensor",     required_argument, NULL, 'N' },
+        { "gatilho-adc", required_argument, NULL, 'G' },
+        { "pid",        required_argument, NULL, 'K' },
+        { "antecipacao", required_argument, NULL, 'f' },
+        { "leds",       required_argument, NULL, 'l' },
+        { "indicador",  required_argument, NULL, 't' },
+        { "repouso",    required_argument, NULL, 'o' },
+        { "parque",     required_argument, NULL, 'k' },
+        { "prazo-parque", required_argument, NULL, 'w' },
+        { "memoria",    optional_argument, NULL, 'M' },
+        { "metricas",   optional_argument, NULL, 'E' },
+        { "gravar",     required_argument, NULL, 'R' },
+        { "roteiro",    required_argument, NULL, 'T' },
+        { "velocidade", required_argument, NULL, 'V' },
+        { "repetir",    optional_argument, NULL, 'Y' },
+        { "inicio",     required_argument, NULL, 'B' },
+        { "config",     required_argument, NULL, 'C' },
+        { "watchdog",   optional_argument, NULL, 'W' },
+        { "prazo-batimento", required_argument, NULL, 'b' },
+        { "escalada",   required_argument, NULL, 'z' },
+        { "pwm-direto", no_argument,       NULL, 'D' },
+        { "simulado",   no_argument,       NULL, 'x' },
+        { "ciclos",     required_argument, NULL, 'n' },
+        { "latencia-sim", required_argument, NULL, 'L' },
+        { "silencioso", no_argument,       NULL, 'q' },
+        { "rt",         no_argument,       NULL, 'r' },
+        { "prioridade", required_argument, NULL, 'p' },
+        { "cpu",        required_argument, NULL, 'c' },
+        { "ajuda",      no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    static const char curtas[] =
+        "s:P:v:a:j:d:Sm:eu:U:A:F:i:g:I:N:G:K:f:l:t:o:k:w:M::E::R:T:V:Y::B:C:W::b:z:Dxn:L:qrp:c:h";
+    int opt;
+    
+    // O arquivo é lido antes das demais opções, que o sobrepõem
+    opterr = 0;
+    while ((opt = getopt_long(argc, argv, curtas, opcoes, NULL)) != -1) {
+        if (opt == 'C') {
+            arquivo_config = optarg;
+        }
+    }
+    if (arquivo_config && carregarConfiguracao(&config, arquivo_config) < 0) {
+        return 1;
+    }
+    memcpy(saidas_leds, config.leds, sizeof(saidas_leds));
+    num_leds = config.num_leds;
+    chip_entradas = config.gpio_chip;
+    optind = 0;
+    opterr = 1;
+    
+    while ((opt = getopt_long(argc, argv, curtas, opcoes, NULL)) != -1) {
+        switch (opt) {
+        case 's':
+            if (num_canais == SERVOS_MAX) {
+                fprintf(stderr, "No máximo %d servos\n", SERVOS_MAX);
+                return 1;
+            }
+            if (interpretarConfigServo(&canais[num_canais], optarg,
+                                       config.duty_min, config.duty_max) < 0) {
+                return 1;
+            }
+            num_canais++;
+            break;
+        case 'P':
+            if (interpretarPerfil(optarg, &perfil.tipo) < 0) {
+                return 1;
+            }
+            break;
+        case 'v': perfil.vel_max = atof(optarg); break;
+        case 'a': perfil.acel_max = atof(optarg); break;
+        case 'j': perfil.jerk_max = atof(optarg); break;
+        case 'd': duracao = atof(optarg); break;
+        case 'S': sincronizar = 1; break;
+        case 'm': margem_us = atol(optarg); break;
+        case 'e': modo_servidor = 1; break;
+        case 'u': cfg_servidor.porta = atoi(optarg); break;
+        case 'U': cfg_servidor.caminho = optarg[0] ? optarg : NULL; break;
+        case 'A': cfg_servidor.atraso_fluxo_ns = atol(optarg) * 1000000L; break;
+        case 'F':
+            if (interpretarModoSubfluxo(optarg, &cfg_servidor.subfluxo) < 0) {
+                return 1;
+            }
+            break;
+        case 'i':
+            if (num_entradas == ENTRADAS_MAX) {
+                fprintf(stderr, "No máximo %d entradas\n", ENTRADAS_MAX);
+                return 1;
+            }
+            if (interpretarEntrada(&cfg_entradas[num_entradas], optarg) < 0) {
+                return 1;
+            }
+            num_entradas++;
+            break;
+        case 'g': chip_entradas = optarg; break;
+        case 'I': dispositivo_adc = optarg; break;
+        case 'N':
+            if (num_sensores == SERVOS_MAX) {
+                fprintf(stderr, "No máximo %d sensores\n", SERVOS_MAX);
+                return 1;
+            }
+            if (interpretarSensor(&sensores[num_sensores], optarg) < 0) {
+                return 1;
+            }
+            num_sensores++;
+            break;
+        case 'G': gatilho_adc = optarg; break;
+        case 'K':
+            if (interpretarGanhos(&ganhos, optarg) < 0) {
+                return 1;
+            }
+            break;
+        case 'f': ganhos.antecipacao = atof(optarg); break;
+        case 'l': {
+            char *saida = strtok(optarg, ",");
+            num_leds = 0;
+            while (saida && num_leds < LEDS_MAX &&
+                   interpretarSaidaLed(&saidas_leds[num_leds], saida) == 0) {
+                num_leds++;
+                saida = strtok(NULL, ",");
+            }
+            if (saida || num_leds == 0) {
+                fprintf(stderr, "Saídas inválidas em --leds (até %d, separadas por vírgula)\n",
+                        LEDS_MAX);
+                return 1;
+            }
+            break;
+        }
+        case 't': arquivo_indicador = optarg; break;
+        case 'o': {
+            char *modo;
+            repouso_ms = strtol(optarg, &modo, 10);
+            if (*modo == ':') {
+                modo++;
+                modo_repouso = strcmp(modo, "zerar") == 0 ? REPOUSO_ZERAR : REPOUSO_DESLIGAR;
+            }
+            if (repouso_ms <= 0 || (*modo && strcmp(modo, "zerar") != 0 &&
+                                    strcmp(modo, "desligar") != 0)) {
+                fprintf(stderr, "Repouso inválido: '%s' (use MS[:desligar|:zerar])\n", optarg);
+                return 1;
+            }
+            break;
+        }
+        case 'k': angulo_parque = atof(optarg); break;
+        case 'w': prazo_parque = atol(optarg); break;
+        case 'M': nome_memoria = optarg ? optarg : SEGMENTO_NOME_PADRAO; break;
+        case 'E': porta_metricas = optarg ? atoi(optarg) : METRICAS_PORTA_PADRAO; break;
+        case 'T': arquivo_roteiro = optarg; break;
+        case 'V': velocidade_roteiro = atof(optarg); break;
+        case 'Y': repeticoes_roteiro = optarg ? strtoul(optarg, NULL, 10) : 0; break;
+        case 'B': inicio_roteiro = atof(optarg); break;
+        case 'R':
+            if (interpretarGravacao(optarg, arquivo_gravacao, sizeof(arquivo_gravacao),
+                                    &capacidade_gravacao) < 0) {
+                return 1;
+            }
+            break;
+        case 'C': break;            // Já lido acima
+        case 'W': cfg_supervisor.watchdog = optarg ? optarg : SUPERVISOR_WATCHDOG_PADRAO; break;
+        case 'b': cfg_supervisor.prazo_ms = atol(optarg); break;
+        case 'z':
+            if (interpretarEscalada(optarg, cfg_supervisor.limites) < 0) {
+                return 1;
+            }
+            break;
+        case 'D': backend = &BACKEND_DIRETO; break;
+        case 'x': backend = &BACKEND_SIMULADO; break;
+        case 'n': ciclos = strtoul(optarg, NULL, 10); break;
+        case 'L': configurarSimulado(atol(optarg) * 1000L); break;
+        case 'q': silencioso = 1; break;
+        case 'r': rt.ativo = 1; break;
+        case 'p': rt.prioridade = atoi(optarg); break;
+        case 'c': rt.cpu = atoi(optarg); break;
+        case 'h': mostrarUso(argv[0]); return 0;
+        default:  mostrarUso(argv[0]); return 1;
+        }
+    }
+    
+    if (modo_servidor && nome_memoria) {
+        fprintf(stderr, "--servidor e --memoria não podem ser usados juntos\n");
+        return 1;
+    }
+    if (arquivo_roteiro && (modo_servidor || nome_memoria)) {
+        fprintf(stderr, "--roteiro substitui a varredura e não combina com "
+                "--servidor ou --memoria\n");
+        return 1;
+    }
+    if (arquivo_roteiro && dispositivo_adc) {
+        fprintf(stderr, "--roteiro escreve os ângulos direto e não combina com --adc\n");
+        return 1;
+    }
+    if (num_entradas > 0 && !modo_servidor) {
+        fprintf(stderr, "--entrada só é usada com --servidor\n");
+        return 1;
+    }
+    if (repouso_ms > 0 && dispositivo_adc) {
+        fprintf(stderr, "--repouso não se aplica com --adc: a malha fechada segura a posição\n");
+        return 1;
+    }
+    if (repouso_ms > 0 && sincronizar && modo_repouso == REPOUSO_DESLIGAR) {
+        fprintf(stderr, "Com --sincronizar use --repouso MS:zerar: religar a saída "
+                "recomeça o quadro do PWM\n");
+        return 1;
+    }
     
     printf("===== Controle de Servomotor e LEDs - Labrador =====\n\n");
+    if (backend != &BACKEND_SYSFS) {
+        printf("Backend: %s\n", backend->nome);
+    }
     
-    // ===== 1) Inicializar PWM =====
-    inicializarPWM();
+    // Sem --servo, usa os servos do arquivo ou o canal padrão com a
+    // calibração padrão; só essas faixas são recarregadas pelo SIGHUP
+    int calibrar_config = num_canais == 0;
+    if (num_canais == 0) {
+        num_canais = canaisConfiguracao(&config, canais);
+    }
     
-    // ===== 2) Inicializar GPIOs para os LEDs =====
-    printf("Inicializando GPIOs dos LEDs...\n");
+    // ===== 1) Inicializar PWM e tabelas de cada servo =====
+    if (abrirServos(&servos, backend, canais, num_canais, config.periodo_pwm) < 0) {
+        fprintf(stderr, "Erro ao inicializar PWM\n");
+        return 1;
+    }
     
-    // Abrir o chip GPIO
-    chip = gpiod_chip_open_by_name(GPIO_CHIP);
-    if (!chip) {
-        perror("Erro ao abrir GPIO chip");
-        desativarPWM();
+    // O perfil linear mantém a velocidade da varredura original de
+    // NUM_PASSOS passos; os demais partem de VEL_MAX_PADRAO
+    if (perfil.vel_max <= 0.0) {
+        perfil.vel_max = perfil.tipo == PERFIL_LINEAR
+            ? ANGULO_MAX / (config.num_passos * (config.passo_us / 1e6))
+            : VEL_MAX_PADRAO;
+    }
+    // A duração da varredura é independente do número de passos: o perfil
+    // é escalado no tempo e amostrado a cada tick com resolução de 1 ns
+    if (duracao > 0.0 && escalarPerfil(&perfil, ANGULO_MAX, duracao) < 0) {
+        fecharServos(&servos);
+        return 1;
+    }
+    long periodo_passo = sincronizar ? config.periodo_pwm : config.passo_us * 1000L;
+    if (planejarVarredura(&servos, &perfil, periodo_passo) < 0) {
+        fecharServos(&servos);
         return 1;
     }
     
-    // Obter as linhas GPIO dos LEDs
-    led1 = gpiod_chip_get_line(chip, LED1_PIN);
-    led2 = gpiod_chip_get_line(chip, LED2_PIN);
+    // Repouso dos servos parados, contado em ticks da grade
+    if (repouso_ms > 0) {
+        long ticks = repouso_ms * 1000000L / periodo_passo;
+        servos.ticks_repouso = ticks > 0 ? (int)ticks : 1;
+        servos.modo_repouso = modo_repouso;
+    }
+    
+    // SIGTERM e SIGINT passam a chegar pelo signalfd do laço de controle;
+    // bloqueados aqui, antes de qualquer thread ser criada
+    static Encerramento encerramento;
+    if (abrirEncerramento(&encerramento, angulo_parque, prazo_parque, &perfil,
+                          periodo_passo) < 0) {
+        fecharServos(&servos);
+        return 1;
+    }
     
-    if (!led1 || !led2) {
-        perror("Erro ao obter linhas GPIO");
-        gpiod_chip_close(chip);
-        desativarPWM();
+    // O SIGHUP também: a recarga da configuração o lê em uma thread própria
+    static RecargaConfiguracao recarga;
+    if (arquivo_config &&
+        abrirRecargaConfiguracao(&recarga, arquivo_config, &padroes, &config,
+                                 calibrar_config) < 0) {
+        fecharServos(&servos);
         return 1;
     }
     
-    // Configurar as linhas como saída
-    ret = gpiod_line_request_output(led1, "led1_control", 0);
-    if (ret < 0) {
-        perror("Erro ao configurar LED1 como saída");
-        gpiod_chip_close(chip);
-        desativarPWM();
+    // ===== 2) Inicializar GPIOs para os LEDs =====
+    printf("Inicializando GPIOs dos LEDs...\n");
+    
+    // Pedir as linhas GPIO em bloco e preparar as saídas temporizadas
+    // (bit i = i-ésima saída; por padrão bit 0 = LED1 e bit 1 = LED2)
+    if (backend->abrirLeds(&leds, config.gpio_chip, saidas_leds, num_leds) < 0) {
+        fecharServos(&servos);
         return 1;
     }
     
-    ret = gpiod_line_request_output(led2, "led2_control", 0);
-    if (ret < 0) {
-        perror("Erro ao configurar LED2 como saída");
-        gpiod_line_release(led1);
-        gpiod_chip_close(chip);
-        desativarPWM();
+    // O que cada linha mostra vem da tabela do indicador
+    static Indicador indicador;
+    if (iniciarIndicador(&indicador, arquivo_indicador, num_leds) < 0) {
+        fecharLeds(&leds);
+        fecharServos(&servos);
         return 1;
     }
+    leds.indicador = &indicador;
     
     printf("GPIOs inicializadas com sucesso!\n\n");
     
+    // ===== Realimentação de posição (opcional) =====
+    // Sem --sensor, o servo i usa o canal i do ADC em fundo de escala
+    static Realimentacao realimentacao;
+    if (dispositivo_adc) {
+        if (num_sensores != 0 && num_sensores != servos.num) {
+            fprintf(stderr, "Informe um --sensor para cada um dos %d servo(s)\n",
+                    servos.num);
+            fecharLeds(&leds);
+            fecharIndicador(&indicador);
+            fecharServos(&servos);
+            return 1;
+        }
+        for (int i = num_sensores; i < servos.num; i++) {
+            sensores[i].canal_adc = i;
+            sensores[i].bruto_min = 0;
+            sensores[i].bruto_max = -1;
+        }
+        if (abrirRealimentacao(&realimentacao, dispositivo_adc, gatilho_adc,
+                               sensores, servos.num, &ganhos, periodo_passo) < 0) {
+            fecharLeds(&leds);
+            fecharIndicador(&indicador);
+            fecharServos(&servos);
+            return 1;
+        }
+    }
+    
     // ===== 3) Frequência já configurada em inicializarPWM() =====
-    printf("Frequência PWM: 50Hz (período de 20ms)\n");
+    printf("Frequência PWM: %gHz (período de %gms) | %d servo(s)\n",
+           1e9 / config.periodo_pwm, config.periodo_pwm / 1e6, servos.num);
+    if (sincronizar) {
+        printf("Sincronizado com o quadro do PWM (escrita %ld us antes da borda)\n",
+               margem_us);
+    }
+    printf("Perfil %s: %.0f°/s | %d ticks por varredura (%.2fs)\n",
+           nomePerfil(perfil.tipo), perfil.vel_max, servos.servos[0].cal->subida.num_ticks,
+           duracaoMovimento(&perfil, ANGULO_MAX));
     printf("Iniciando controle do servomotor...\n\n");
     
-    // Calcular incremento de duty cycle para movimentação suave
-    int incremento = (DUTY_MAX - DUTY_MIN) / NUM_PASSOS;
+    // Histogramas de latência (somente com -DINSTRUMENTACAO)
+    INSTR_INICIAR();
     
-    // Loop infinito
-    while (1) {
-        // ===== 4) Incrementar duty cycle: 0° -> 180° =====
-        printf("Movendo de 0° para 180°...\n");
-        
-        for (int duty = DUTY_MIN; duty <= DUTY_MAX; duty += incremento) {
-            setPWMDutyCycle(duty);
-            int angulo = dutyParaAngulo(duty);
-            
-            // ===== 7 e 8) Controlar LEDs baseado no ângulo =====
-            if (angulo <= 90) {
-                gpiod_line_set_value(led1, 1);  // LED1 aceso
-                gpiod_line_set_value(led2, 0);  // LED2 apagado
-                printf("Ângulo: %3d° | LED1: ON  | LED2: OFF\n", angulo);
-            } else {
-                gpiod_line_set_value(led1, 0);  // LED1 apagado
-                gpiod_line_set_value(led2, 1);  // LED2 aceso
-                printf("Ângulo: %3d° | LED1: OFF | LED2: ON\n", angulo);
+    // Console fora do caminho de controle: o laço só enfileira registros
+    static FilaRegistro registros;
+    fflush(stdout);
+    iniciarFilaRegistro(&registros);
+    iniciarConsumidorRegistro(&registros);
+    if (dispositivo_adc) {
+        conectarRealimentacao(&realimentacao, &servos, &registros);
+    }
+    iniciarRecargaIndicador(&indicador);
+    
+    // Métricas: o laço só publica um instantâneo, e a coleta HTTP roda em
+    // uma thread de baixa prioridade
+    static Metricas metricas;
+    iniciarMetricas(&metricas, &servos, &leds, &registros);
+    if (porta_metricas >= 0 && iniciarExportadorMetricas(&metricas, porta_metricas) < 0) {
+        pararConsumidorRegistro(&registros);
+        fecharRealimentacao(&realimentacao);
+        fecharLeds(&leds);
+        fecharIndicador(&indicador);
+        fecharServos(&servos);
+        return 1;
+    }
+    
+    // Gravador de telemetria: o laço só copia registros para o arquivo
+    // mapeado. O servidor marca o tempo no relógio monotônico real, mesmo
+    // com o backend simulado
+    static Gravador gravador;
+    const Relogio *relogio_gravacao = modo_servidor ? &RELOGIO_MONOTONICO : backend->relogio;
+    if (arquivo_gravacao[0] &&
+        abrirGravador(&gravador, arquivo_gravacao, capacidade_gravacao, &servos,
+                      &leds, relogio_gravacao, periodo_passo) < 0) {
+        fecharMetricas(&metricas);
+        pararConsumidorRegistro(&registros);
+        fecharRealimentacao(&realimentacao);
+        fecharLeds(&leds);
+        fecharIndicador(&indicador);
+        fecharServos(&servos);
+        return 1;
+    }
+    
+    // Recarga da configuração: as calibrações novas são montadas fora do
+    // laço e adotadas por ele com uma troca de ponteiro
+    if (arquivo_config &&
+        iniciarRecargaConfiguracao(&recarga, &servos, &perfil, periodo_passo,
+                                   &indicador) < 0) {
+        fecharGravador(&gravador);
+        fecharMetricas(&metricas);
+        pararConsumidorRegistro(&registros);
+        fecharRealimentacao(&realimentacao);
+        fecharLeds(&leds);
+        fecharIndicador(&indicador);
+        fecharServos(&servos);
+        return 1;
+    }
+    
+    // Supervisor: o laço só grava o batimento a cada tick; a thread que o
+    // confere alimenta o watchdog e o systemd enquanto ele for recente
+    static Supervisor supervisor;
+    if (iniciarSupervisor(&supervisor, &cfg_supervisor, &registros,
+                          porta_metricas >= 0 ? &metricas : NULL) < 0) {
+        fecharRecargaConfiguracao(&recarga);
+        fecharGravador(&gravador);
+        fecharMetricas(&metricas);
+        pararConsumidorRegistro(&registros);
+        fecharRealimentacao(&realimentacao);
+        fecharLeds(&leds);
+        fecharIndicador(&indicador);
+        fecharServos(&servos);
+        return 1;
+    }
+    
+    ContextoServo ctx = { &servos, &leds, &registros, periodo_passo,
+                          sincronizar, margem_us * 1000L, backend->relogio,
+                          ciclos, silencioso, NULL, NULL, &encerramento,
+                          porta_metricas >= 0 ? &metricas : NULL,
+                          arquivo_gravacao[0] ? &gravador : NULL, NULL, &perfil,
+                          &supervisor };
+    
+    // No modo servidor os movimentos vêm da rede: mesmo perfil e mesmo
+    // período de tick, mas o laço é dirigido por eventos
+    static Servidor servidor;
+    static EntradasDigitais entradas;
+    static Reproducao reproducao;
+    if (modo_servidor) {
+        int erro = abrirServidor(&servidor, &cfg_servidor, &servos, &leds,
+                                 &registros, &perfil, periodo_passo) < 0;
+        if (!erro && num_entradas > 0) {
+            for (unsigned int i = 0; i < num_entradas && !erro; i++) {
+                if (cfg_entradas[i].tipo != ENTRADA_EMERGENCIA &&
+                    cfg_entradas[i].canal >= servos.num) {
+                    fprintf(stderr, "Entrada da linha %u: servo %d inexistente\n",
+                            cfg_entradas[i].pino, cfg_entradas[i].canal);
+                    erro = 1;
+                }
             }
-            
-            usleep(DELAY_PASSO);
+            erro = erro ||
+                   abrirEntradas(&entradas, chip_entradas, cfg_entradas, num_entradas) < 0 ||
+                   adicionarEntradasServidor(&servidor, &entradas) < 0;
         }
-        
-        printf("\n");
-        sleep(1); // Pausa na posição 180°
-        
-        // ===== 5) Decrementar duty cycle: 180° -> 0° =====
-        printf("Movendo de 180° para 0°...\n");
-        
-        for (int duty = DUTY_MAX; duty >= DUTY_MIN; duty -= incremento) {
-            setPWMDutyCycle(duty);
-            int angulo = dutyParaAngulo(duty);
-            
-            // ===== 7 e 8) Controlar LEDs baseado no ângulo =====
-            if (angulo <= 90) {
-                gpiod_line_set_value(led1, 1);  // LED1 aceso
-                gpiod_line_set_value(led2, 0);  // LED2 apagado
-                printf("Ângulo: %3d° | LED1: ON  | LED2: OFF\n", angulo);
-            } else {
-                gpiod_line_set_value(led1, 0);  // LED1 apagado
-                gpiod_line_set_value(led2, 1);  // LED2 aceso
-                printf("Ângulo: %3d° | LED1: OFF | LED2: ON\n", angulo);
-            }
-            
-            usleep(DELAY_PASSO);
+        erro = erro || adicionarEncerramentoServidor(&servidor, &encerramento) < 0;
+        if (erro) {
+            fecharEntradas(&entradas);
+            fecharServidor(&servidor);
+            fecharSupervisor(&supervisor);
+            fecharRecargaConfiguracao(&recarga);
+            fecharGravador(&gravador);
+            fecharMetricas(&metricas);
+            pararConsumidorRegistro(&registros);
+            fecharRealimentacao(&realimentacao);
+            fecharLeds(&leds);
+            fecharIndicador(&indicador);
+            fecharServos(&servos);
+            return 1;
         }
-        
-        printf("\n");
-        sleep(1); // Pausa na posição 0°
-        
-        // ===== 6) Loop se repete indefinidamente =====
+        servidor.silencioso = silencioso;
+        servidor.metricas = ctx.metricas;
+        servidor.gravador = ctx.gravador;
+        servidor.supervisor = ctx.supervisor;
+        metricas.fluxo = &servidor.fluxo;
+        metricas.comandos = &servidor.comandos;
+        metricas.rejeitados = &servidor.rejeitados;
+        metricas.substituidos = &servidor.substituidos;
+        ctx.servidor = &servidor;
+        executarTempoReal(&rt, executarComandos, &ctx);
+        fecharServidor(&servidor);
+        fecharEntradas(&entradas);
+    } else if (nome_memoria) {
+        static MemoriaControle memoria;
+        if (abrirMemoria(&memoria, nome_memoria, &servos, &leds, &registros,
+                         &perfil, periodo_passo, backend->relogio) < 0) {
+            fecharSupervisor(&supervisor);
+            fecharRecargaConfiguracao(&recarga);
+            fecharGravador(&gravador);
+            fecharMetricas(&metricas);
+            pararConsumidorRegistro(&registros);
+            fecharRealimentacao(&realimentacao);
+            fecharLeds(&leds);
+            fecharIndicador(&indicador);
+            fecharServos(&servos);
+            return 1;
+        }
+        memoria.silencioso = silencioso;
+        memoria.encerramento = &encerramento;
+        memoria.metricas = ctx.metricas;
+        memoria.gravador = ctx.gravador;
+        memoria.supervisor = ctx.supervisor;
+        ctx.memoria = &memoria;
+        executarTempoReal(&rt, executarAlvosMemoria, &ctx);
+        fecharMemoria(&memoria);
+    } else if (arquivo_roteiro) {
+        // O arquivo é lido direto do mapeamento; com --rt o mlockall da
+        // thread de controle o mantém inteiro na memória
+        if (abrirReproducao(&reproducao, arquivo_roteiro, servos.num, velocidade_roteiro,
+                            inicio_roteiro, repeticoes_roteiro, periodo_passo) < 0) {
+            fecharSupervisor(&supervisor);
+            fecharRecargaConfiguracao(&recarga);
+            fecharGravador(&gravador);
+            fecharMetricas(&metricas);
+            pararConsumidorRegistro(&registros);
+            fecharRealimentacao(&realimentacao);
+            fecharLeds(&leds);
+            fecharIndicador(&indicador);
+            fecharServos(&servos);
+            return 1;
+        }
+        ctx.reproducao = &reproducao;
+        executarTempoReal(&rt, executarRoteiro, &ctx);
+    } else {
+        executarTempoReal(&rt, executarVarredura, &ctx);
     }
     
-    // Limpeza (código inalcançável, mas boa prática)
-    gpiod_line_release(led1);
-    gpiod_line_release(led2);
-    gpiod_chip_close(chip);
-    desativarPWM();
+    fecharSupervisor(&supervisor);
+    fecharRecargaConfiguracao(&recarga);
+    fecharGravador(&gravador);
+    fecharMetricas(&metricas);
+    pararConsumidorRegistro(&registros);
+    INSTR_ENCERRAR();
+    
+    if (encerramento.sinal) {
+        printf("\nEncerrando (%s)\n", strsignal(encerramento.sinal));
+    }
+    printf("Estacionamento em %.0f°: %s em %ld ms\n", encerramento.angulo,
+           encerramento.concluido ? "concluído" : "interrompido",
+           encerramento.duracao_ms);
+    
+    imprimirRepousoServos(&servos);
+    printf("Supervisor: pior sequência de %lu deadline(s) perdido(s) | %lu degradação(ões) | "
+           "%lu travamento(s)%s\n", supervisor.pior_sequencia, supervisor.degradacoes,
+           supervisor.travamentos,
+           supervisor.nivel == SUPERVISOR_PARQUE ? " | estacionamento pedido" : "");
+    if (modo_servidor) {
+        printf("Comandos: %lu aplicado(s) | %lu rejeitado(s) | %lu substituído(s) na caixa\n",
+               servidor.comandos, servidor.rejeitados, servidor.substituidos);
+    }
+    if (arquivo_config) {
+        printf("Configuração: %lu recarga(s) | geração %lu em uso\n",
+               recarga.recargas, servos.calibracao->geracao);
+    }
+    if (porta_metricas >= 0) {
+        printf("Métricas: %lu coleta(s)\n", metricas.coletas);
+    }
+    if (arquivo_gravacao[0]) {
+        printf("Gravador: %lu registro(s) nesta execução\n", gravador.gravados);
+    }
+    if (arquivo_roteiro) {
+        printf("Roteiro: %lu passada(s) concluída(s)\n", reproducao.passadas);
+        if (reproducao.quadros_invalidos) {
+            fprintf(stderr, "Roteiro interrompido: quadro inválido (ângulo fora do "
+                    "curso ou instante fora de ordem)\n");
+        }
+    }
+    
+    // Limpeza
+    fecharReproducao(&reproducao);
+    fecharRealimentacao(&realimentacao);
+    fecharLeds(&leds);
+    fecharIndicador(&indicador);
+    fecharServos(&servos);
+    fecharEncerramento(&encerramento);
+    if (backend->relatorio) {
+        backend->relatorio();
+    }
     
     return 0;
 }
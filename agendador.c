@@ -0,0 +1,132 @@
+#include <errno.h>
+
+#include "agendador.h"
+#include "instrumentacao.h"
+
+#define NS_POR_S 1000000000L
+
+// Soma nanosegundos a um timespec mantendo tv_nsec normalizado
+static void somarNs(struct timespec *t, long long ns) {
+    long long total = t->tv_nsec + ns;
+    t->tv_sec += total / NS_POR_S;
+    total %= NS_POR_S;
+    if (total < 0) {
+        total += NS_POR_S;
+        t->tv_sec--;
+    }
+    t->tv_nsec = total;
+}
+
+// Diferença a - b em nanosegundos
+static long long diferencaNs(const struct timespec *a, const struct timespec *b) {
+    return (long long)(a->tv_sec - b->tv_sec) * NS_POR_S +
+           (a->tv_nsec - b->tv_nsec);
+}
+
+// Relógio monotônico real
+static void agoraMonotonico(const Relogio *r, struct timespec *t) {
+    (void)r;
+    clock_gettime(CLOCK_MONOTONIC, t);
+}
+
+static void dormirMonotonico(const Relogio *r, const struct timespec *t) {
+    (void)r;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, t, NULL) == EINTR) {
+    }
+}
+
+const Relogio RELOGIO_MONOTONICO = { agoraMonotonico, dormirMonotonico, NULL };
+
+// Função para iniciar o agendador
+void iniciarAgendador(Agendador *ag, const Relogio *relogio, long periodo_ns) {
+    ag->relogio = relogio;
+    ag->periodo_ns = periodo_ns;
+    ag->ticks = 0;
+    ag->overruns_ciclo = 0;
+    ag->overruns_total = 0;
+    ag->atraso_max_ns = 0;
+    relogio->agora(relogio, &ag->proximo);
+    somarNs(&ag->proximo, periodo_ns);
+}
+
+// Função para iniciar o agendador em fase com uma origem
+void iniciarAgendadorEm(Agendador *ag, const Relogio *relogio, long periodo_ns,
+                        const struct timespec *origem, long long fase_ns) {
+    struct timespec agora;
+    struct timespec base = *origem;
+
+    iniciarAgendador(ag, relogio, periodo_ns);
+    relogio->agora(relogio, &agora);
+    somarNs(&base, fase_ns);
+
+    long long decorrido = diferencaNs(&agora, &base);
+    long long quadros = decorrido >= 0 ? decorrido / periodo_ns + 1 : 0;
+    ag->proximo = base;
+    somarNs(&ag->proximo, quadros * periodo_ns);
+}
+
+// Função para contar os deadlines já vencidos antes da espera
+int prepararTick(Agendador *ag) {
+    struct timespec agora;
+    int perdidos = 0;
+
+    ag->relogio->agora(ag->relogio, &agora);
+    long long atraso = diferencaNs(&agora, &ag->proximo);
+
+    if (atraso > 0) {
+        // Deadline já passou: conta o overrun e, se o atraso passou de um
+        // período inteiro, pula os ticks perdidos em vez de recuperá-los
+        // em rajada
+        perdidos = (int)(atraso / ag->periodo_ns) + 1;
+        ag->overruns_ciclo += perdidos;
+        ag->overruns_total += perdidos;
+        if (atraso > ag->atraso_max_ns) {
+            ag->atraso_max_ns = (long)atraso;
+        }
+        somarNs(&ag->proximo, (long long)(perdidos - 1) * ag->periodo_ns);
+    }
+    return perdidos;
+}
+
+// Função para fechar o tick do deadline atual
+void concluirTick(Agendador *ag) {
+    somarNs(&ag->proximo, ag->periodo_ns);
+    ag->ticks++;
+}
+
+// Função para aguardar o próximo deadline da grade
+int esperarProximoTick(Agendador *ag) {
+    int perdidos = prepararTick(ag);
+
+    if (perdidos == 0) {
+        ag->relogio->dormirAte(ag->relogio, &ag->proximo);
+#ifdef INSTRUMENTACAO
+        struct timespec agora;
+        ag->relogio->agora(ag->relogio, &agora);
+        INSTR_AMOSTRA(FASE_DESPERTAR, diferencaNs(&agora, &ag->proximo));
+#endif
+    }
+
+    concluirTick(ag);
+    return perdidos;
+}
+
+// Função para medir o tempo desde o deadline do tick em curso
+long long atrasoTick(const Agendador *ag) {
+    struct timespec agora;
+    ag->relogio->agora(ag->relogio, &agora);
+    return diferencaNs(&agora, &ag->proximo) + ag->periodo_ns;
+}
+
+// Função para aguardar vários ticks sem sair da grade
+void esperarTicks(Agendador *ag, int n) {
+    for (int i = 0; i < n; i++) {
+        esperarProximoTick(ag);
+    }
+}
+
+// Função para zerar as estatísticas do ciclo
+void zerarCicloAgendador(Agendador *ag) {
+    ag->overruns_ciclo = 0;
+    ag->atraso_max_ns = 0;
+}
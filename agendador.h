@@ -0,0 +1,59 @@
+#ifndef AGENDADOR_H
+#define AGENDADOR_H
+
+#include <time.h>
+
+// Fonte de tempo do agendador: o relógio monotônico real ou um relógio
+// virtual (backend simulado), que avança direto para o deadline
+typedef struct Relogio {
+    void (*agora)(const struct Relogio *r, struct timespec *t);
+    void (*dormirAte)(const struct Relogio *r, const struct timespec *t);
+    void *dados;
+} Relogio;
+
+// CLOCK_MONOTONIC com clock_nanosleep(TIMER_ABSTIME)
+extern const Relogio RELOGIO_MONOTONICO;
+
+// Agendador de passos com deadlines absolutos.
+// Os ticks ficam em uma grade fixa no relógio: o próximo deadline
+// é sempre o anterior mais um período, então o tempo gasto com escrita no
+// sysfs, GPIO e console não se acumula como deriva.
+typedef struct {
+    const Relogio *relogio;
+    struct timespec proximo;        // Próximo deadline absoluto
+    long periodo_ns;                // Período entre ticks
+    unsigned long ticks;            // Ticks executados desde o início
+    unsigned long overruns_ciclo;   // Deadlines perdidos no ciclo atual
+    unsigned long overruns_total;   // Deadlines perdidos desde o início
+    long atraso_max_ns;             // Maior atraso observado no ciclo atual
+} Agendador;
+
+// Inicia a grade de ticks a partir do instante atual
+void iniciarAgendador(Agendador *ag, const Relogio *relogio, long periodo_ns);
+
+// Inicia a grade em fase com origem: os deadlines caem em
+// origem + fase_ns + k * periodo_ns (o primeiro ainda no futuro)
+void iniciarAgendadorEm(Agendador *ag, const Relogio *relogio, long periodo_ns,
+                        const struct timespec *origem, long long fase_ns);
+
+// Dorme até o próximo deadline; retorna quantos ticks foram perdidos
+int esperarProximoTick(Agendador *ag);
+
+// Metades de esperarProximoTick() para quem espera por conta própria (por
+// exemplo, um timerfd em um laço de eventos): prepararTick() conta os
+// deadlines já perdidos e deixa em ag->proximo o deadline a aguardar;
+// concluirTick() fecha o tick depois que ele chegou
+int prepararTick(Agendador *ag);
+void concluirTick(Agendador *ag);
+
+// Tempo decorrido desde o deadline do tick em curso (o último concluído,
+// ag->proximo menos um período), no relógio do agendador (ns)
+long long atrasoTick(const Agendador *ag);
+
+// Aguarda n ticks mantendo a grade
+void esperarTicks(Agendador *ag, int n);
+
+// Zera as estatísticas do ciclo atual
+void zerarCicloAgendador(Agendador *ag);
+
+#endif
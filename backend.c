@@ -0,0 +1,18 @@
+#include "backend.h"
+#include "pwm_direto.h"
+
+const Backend BACKEND_SYSFS = {
+    "sysfs",
+    inicializarPWM,
+    abrirLeds,
+    &RELOGIO_MONOTONICO,
+    NULL,
+};
+
+const Backend BACKEND_DIRETO = {
+    "direto",
+    inicializarPWMDireto,
+    abrirLeds,
+    &RELOGIO_MONOTONICO,
+    NULL,
+};
@@ -0,0 +1,33 @@
+#ifndef BACKEND_H
+#define BACKEND_H
+
+#include "pwm.h"
+#include "leds.h"
+#include "agendador.h"
+
+// Conjunto de implementações usado pelo laço de controle: como abrir os
+// canais PWM e os LEDs e qual relógio dirige o agendador. Depois de
+// abertos, canais e LEDs são usados só pelas suas próprias operações.
+typedef struct {
+    const char *nome;
+    int (*abrirPWM)(CanalPWM *pwm, const char *chip, int canal,
+                    int periodo, int duty_inicial);
+    int (*abrirLeds)(LedsIndicadores *leds, const char *chip,
+                     const ConfigSaidaLed *saidas, unsigned int num);
+    const Relogio *relogio;
+    void (*relatorio)(void);        // Resumo ao encerrar (NULL = nenhum)
+} Backend;
+
+// Hardware real: PWM via sysfs, LEDs via libgpiod (e classe leds ou PWM
+// para os padrões temporizados), CLOCK_MONOTONIC
+extern const Backend BACKEND_SYSFS;
+
+// Como o sysfs, mas com o duty escrito direto no registro do controlador
+// PWM mapeado de /dev/mem (ver pwm_direto.h); canais em que o mapeamento
+// ou a calibração falham seguem pelo sysfs
+extern const Backend BACKEND_DIRETO;
+
+// Simulação em memória com relógio virtual (ver simulado.h)
+extern const Backend BACKEND_SIMULADO;
+
+#endif
@@ -0,0 +1,303 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/signalfd.h>
+
+#include "configuracao.h"
+
+// Converte um inteiro positivo; retorna 0 ou -1
+static int interpretarPositivo(const char *texto, long *valor) {
+    char *fim;
+    *valor = strtol(texto, &fim, 10);
+    return (fim != texto && *fim == '\0' && *valor > 0) ? 0 : -1;
+}
+
+// Interpreta a lista de saídas dos LEDs (como em --leds)
+static int interpretarLeds(Configuracao *c, char *texto) {
+    char *saida = strtok(texto, ",");
+    c->num_leds = 0;
+    while (saida && c->num_leds < LEDS_MAX &&
+           interpretarSaidaLed(&c->leds[c->num_leds], saida) == 0) {
+        c->num_leds++;
+        saida = strtok(NULL, ",");
+    }
+    return (saida || c->num_leds == 0) ? -1 : 0;
+}
+
+// Aplica uma linha "chave valor"; servo só é guardado, para usar a faixa
+// padrão do arquivo inteiro. Retorna 0 ou -1
+static int aplicarChave(Configuracao *c, const char *chave, char *valor,
+                        char servos[][CONFIG_TAM_LINHA], int *num_servos) {
+    long n;
+
+    if (strcmp(chave, "servo") == 0) {
+        if (*num_servos == SERVOS_MAX) {
+            return -1;
+        }
+        snprintf(servos[(*num_servos)++], CONFIG_TAM_LINHA, "%s", valor);
+        return 0;
+    }
+    if (strcmp(chave, "pwm_chip") == 0) {
+        if (valor[0] == '/') {
+            snprintf(c->pwm_chip, sizeof(c->pwm_chip), "%s", valor);
+        } else {
+            snprintf(c->pwm_chip, sizeof(c->pwm_chip), PWM_CLASSE "/%.79s", valor);
+        }
+        return 0;
+    }
+    if (strcmp(chave, "gpio_chip") == 0) {
+        snprintf(c->gpio_chip, sizeof(c->gpio_chip), "%s", valor);
+        return 0;
+    }
+    if (strcmp(chave, "leds") == 0) {
+        return interpretarLeds(c, valor);
+    }
+    if (strcmp(chave, "pwm_canal") == 0) {
+        char *fim;
+        n = strtol(valor, &fim, 10);
+        if (fim == valor || *fim != '\0' || n < 0) {
+            return -1;
+        }
+        c->pwm_canal = (int)n;
+        return 0;
+    }
+    if (interpretarPositivo(valor, &n) < 0) {
+        return -1;
+    }
+    if (strcmp(chave, "periodo_pwm") == 0) {
+        c->periodo_pwm = (int)n;
+    } else if (strcmp(chave, "duty_min") == 0) {
+        c->duty_min = (int)n;
+    } else if (strcmp(chave, "duty_max") == 0) {
+        c->duty_max = (int)n;
+    } else if (strcmp(chave, "passos") == 0) {
+        c->num_passos = (int)n;
+    } else if (strcmp(chave, "passo_us") == 0) {
+        c->passo_us = n;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+// Função para ler o arquivo de configuração
+int carregarConfiguracao(Configuracao *c, const char *caminho) {
+    char linha[CONFIG_TAM_LINHA];
+    char servos[SERVOS_MAX][CONFIG_TAM_LINHA];
+    int num_servos = 0;
+    int numero = 0;
+    Configuracao nova = *c;
+
+    FILE *fp = fopen(caminho, "r");
+    if (!fp) {
+        perror(caminho);
+        return -1;
+    }
+    while (fgets(linha, sizeof(linha), fp)) {
+        numero++;
+        char *comentario = strchr(linha, '#');
+        if (comentario) *comentario = '\0';
+
+        char *chave = linha;
+        while (isspace((unsigned char)*chave)) chave++;
+        if (*chave == '\0') {
+            continue;
+        }
+        char *valor = chave;
+        while (*valor && !isspace((unsigned char)*valor)) valor++;
+        if (*valor) *valor++ = '\0';
+        while (isspace((unsigned char)*valor)) valor++;
+        char *fim = valor + strlen(valor);
+        while (fim > valor && isspace((unsigned char)fim[-1])) *--fim = '\0';
+
+        if (*valor == '\0' || aplicarChave(&nova, chave, valor, servos, &num_servos) < 0) {
+            fprintf(stderr, "%s:%d: valor inválido para '%s'\n", caminho, numero, chave);
+            fclose(fp);
+            return -1;
+        }
+    }
+    fclose(fp);
+
+    if (nova.duty_max <= nova.duty_min || nova.duty_max > nova.periodo_pwm) {
+        fprintf(stderr, "%s: faixa %d..%d ns inválida para o período de %d ns\n",
+                caminho, nova.duty_min, nova.duty_max, nova.periodo_pwm);
+        return -1;
+    }
+    if (num_servos > 0) {
+        nova.num_servos = 0;
+        for (int i = 0; i < num_servos; i++) {
+            if (interpretarConfigServo(&nova.servos[i], servos[i],
+                                       nova.duty_min, nova.duty_max) < 0) {
+                return -1;
+            }
+            nova.num_servos++;
+        }
+    }
+    *c = nova;
+    return 0;
+}
+
+// Função para obter os canais efetivos
+int canaisConfiguracao(const Configuracao *c, ConfigServo *canais) {
+    if (c->num_servos > 0) {
+        memcpy(canais, c->servos, (size_t)c->num_servos * sizeof(*canais));
+        return c->num_servos;
+    }
+    snprintf(canais[0].chip, sizeof(canais[0].chip), "%s", c->pwm_chip);
+    canais[0].canal = c->pwm_canal;
+    canais[0].duty_min = c->duty_min;
+    canais[0].duty_max = c->duty_max;
+    return 1;
+}
+
+// Função para preparar a recarga
+int abrirRecargaConfiguracao(RecargaConfiguracao *r, const char *caminho,
+                             const Configuracao *inicial, const Configuracao *atual,
+                             int calibrar) {
+    sigset_t sinais;
+
+    memset(r, 0, sizeof(*r));
+    r->fd = -1;
+    r->inicial = *inicial;
+    r->atual = *atual;
+    r->calibrar = calibrar;
+
+    sigemptyset(&sinais);
+    sigaddset(&sinais, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &sinais, NULL);
+    r->fd = signalfd(-1, &sinais, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (r->fd < 0) {
+        perror("signalfd");
+        pthread_sigmask(SIG_UNBLOCK, &sinais, NULL);
+        return -1;
+    }
+    r->caminho = caminho;
+    atomic_init(&r->ativo, 0);
+    return 0;
+}
+
+// Avisa das chaves que só valem na próxima partida
+static void avisarPartida(const Configuracao *antes, const Configuracao *depois) {
+    if (antes->periodo_pwm != depois->periodo_pwm ||
+        strcmp(antes->gpio_chip, depois->gpio_chip) != 0 ||
+        antes->num_leds != depois->num_leds ||
+        memcmp(antes->leds, depois->leds, sizeof(antes->leds)) != 0 ||
+        antes->num_passos != depois->num_passos || antes->passo_us != depois->passo_us) {
+        printf("Configuração: período, LEDs e passos mudam só na próxima partida\n");
+    }
+}
+
+// Tenta publicar a geração montada; o laço pode ainda não ter adotado a
+// anterior (na varredura, só nas pausas dos extremos)
+static void publicarPendente(RecargaConfiguracao *r) {
+    if (r->pendente && publicarCalibracao(r->servos, r->pendente) == 0) {
+        printf("Configuração: calibração publicada (geração %lu)\n", r->pendente->geracao);
+        fflush(stdout);
+        r->pendente = NULL;
+    }
+}
+
+// Função para recarregar o arquivo
+int recarregarConfiguracao(RecargaConfiguracao *r) {
+    Configuracao nova = r->inicial;
+
+    if (r->indicador && r->indicador->caminho) {
+        recarregarIndicador(r->indicador);
+    }
+    if (carregarConfiguracao(&nova, r->caminho) < 0) {
+        fprintf(stderr, "Configuração: mantendo a atual\n");
+        return -1;
+    }
+    avisarPartida(&r->atual, &nova);
+    r->atual = nova;
+    r->recargas++;
+    if (!r->calibrar) {
+        printf("Configuração recarregada: %s (servos de --servo mantidos)\n", r->caminho);
+        fflush(stdout);
+        return 0;
+    }
+
+    // Os canais já estão abertos: a recarga só troca a faixa de cada um
+    ConfigServo canais[SERVOS_MAX];
+    int num = canaisConfiguracao(&nova, canais);
+    for (int i = 0; i < r->servos->num; i++) {
+        const ConfigServo *s = &r->servos->servos[i].cfg;
+        if (num != r->servos->num || canais[i].canal != s->canal ||
+            strcmp(canais[i].chip, s->chip) != 0) {
+            fprintf(stderr, "Configuração: os canais mudaram; a calibração nova "
+                    "vale só na próxima partida\n");
+            return -1;
+        }
+    }
+
+    CalibracaoGrupo *c = montarCalibracao(r->servos, canais, &r->perfil, r->periodo_tick_ns);
+    if (!c) {
+        fprintf(stderr, "Configuração: mantendo a calibração atual\n");
+        return -1;
+    }
+    free(r->pendente);              // Nunca publicada: ninguém a viu
+    r->pendente = c;
+    printf("Configuração recarregada: %s (%d servo(s))\n", r->caminho, num);
+    publicarPendente(r);
+    fflush(stdout);
+    return 0;
+}
+
+// Thread de recarga: espera o SIGHUP e, enquanto houver uma geração
+// montada e não publicada, tenta publicá-la a cada intervalo
+static void *vigiarConfiguracao(void *arg) {
+    RecargaConfiguracao *r = arg;
+
+    setpriority(PRIO_PROCESS, 0, 19);
+    while (atomic_load_explicit(&r->ativo, memory_order_relaxed)) {
+        struct pollfd pfd = { r->fd, POLLIN, 0 };
+        if (poll(&pfd, 1, CONFIG_INTERVALO_MS) > 0) {
+            struct signalfd_siginfo info;
+            while (read(r->fd, &info, sizeof(info)) == sizeof(info)) {
+            }
+            recarregarConfiguracao(r);
+        } else {
+            publicarPendente(r);
+        }
+    }
+    return NULL;
+}
+
+// Função para criar a thread de recarga
+int iniciarRecargaConfiguracao(RecargaConfiguracao *r, GrupoServos *servos,
+                               const PerfilMovimento *perfil, long periodo_tick_ns,
+                               Indicador *indicador) {
+    r->servos = servos;
+    r->perfil = *perfil;
+    r->periodo_tick_ns = periodo_tick_ns;
+    r->indicador = indicador;
+
+    atomic_store(&r->ativo, 1);
+    if (pthread_create(&r->thread, NULL, vigiarConfiguracao, r) != 0) {
+        atomic_store(&r->ativo, 0);
+        fprintf(stderr, "Erro ao criar a thread de recarga da configuração\n");
+        return -1;
+    }
+    printf("Configuração: %s (kill -HUP %d para recarregar)\n", r->caminho, (int)getpid());
+    return 0;
+}
+
+// Função para encerrar a recarga
+void fecharRecargaConfiguracao(RecargaConfiguracao *r) {
+    if (!r->caminho) {
+        return;
+    }
+    if (atomic_exchange(&r->ativo, 0)) {
+        pthread_join(r->thread, NULL);
+    }
+    free(r->pendente);
+    r->pendente = NULL;
+    close(r->fd);
+    r->fd = -1;
+    r->caminho = NULL;
+}
@@ -0,0 +1,92 @@
+#ifndef CONFIGURACAO_H
+#define CONFIGURACAO_H
+
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "servos.h"
+#include "leds.h"
+#include "indicador.h"
+#include "trajetoria.h"
+
+// Tamanho máximo de uma linha do arquivo de configuração
+#define CONFIG_TAM_LINHA 256
+
+// Intervalo com que a thread de recarga confere se deve encerrar (ms)
+#define CONFIG_INTERVALO_MS 200
+
+// Parâmetros de partida que antes eram fixos na compilação. Os valores
+// padrão vêm das macros do programa principal; o arquivo sobrepõe o que
+// trouxer e as opções de linha de comando sobrepõem o arquivo.
+typedef struct {
+    char pwm_chip[PWM_TAM_CAMINHO];     // Canal usado sem nenhum servo
+    int pwm_canal;
+    int periodo_pwm;                    // ns
+    int duty_min;                       // Faixa dos servos sem faixa própria
+    int duty_max;
+    char gpio_chip[PWM_TAM_CAMINHO];
+    ConfigSaidaLed leds[LEDS_MAX];
+    unsigned int num_leds;
+    int num_passos;                     // Velocidade do perfil linear
+    long passo_us;                      // Intervalo entre ticks
+    ConfigServo servos[SERVOS_MAX];     // Calibração de cada canal
+    int num_servos;
+} Configuracao;
+
+// Lê o arquivo "CHAVE VALOR" por linha (# começa um comentário) sobre os
+// valores atuais de c. Chaves: pwm_chip, pwm_canal, periodo_pwm,
+// duty_min, duty_max, gpio_chip, leds (como em --leds), passos, passo_us
+// e servo CHIP:CANAL[:MIN:MAX] (repetível). Em erro c fica intacto.
+// Retorna 0 ou -1
+int carregarConfiguracao(Configuracao *c, const char *caminho);
+
+// Canais efetivos da configuração: os servos do arquivo ou, sem nenhum,
+// o canal padrão com a faixa padrão; retorna quantos
+int canaisConfiguracao(const Configuracao *c, ConfigServo *canais);
+
+// Recarga da configuração por SIGHUP.
+// O sinal fica bloqueado em todas as threads e chega por um signalfd
+// lido por uma thread de baixa prioridade, que relê o arquivo e monta
+// fora do laço uma geração nova das calibrações (tabela inversa e
+// trajetórias da varredura de cada servo) e a publica no grupo (ver
+// GrupoServos); o laço a adota com uma troca de ponteiro, sem trava. O
+// indicador é recompilado no mesmo sinal. Só a faixa de cada canal muda
+// com o programa rodando: canais, período, LEDs e passos valem na
+// próxima partida, e a recarga avisa quando eles mudam.
+typedef struct {
+    const char *caminho;                // NULL = sem recarga
+    Configuracao inicial;               // Padrões antes do arquivo
+    Configuracao atual;                 // Última carregada
+    int calibrar;                       // 0 = servos vieram de --servo
+    GrupoServos *servos;
+    PerfilMovimento perfil;
+    long periodo_tick_ns;
+    Indicador *indicador;
+    CalibracaoGrupo *pendente;          // Montada, ainda não publicada
+    int fd;                             // signalfd do SIGHUP
+    atomic_int ativo;                   // 1 = thread de recarga rodando
+    pthread_t thread;
+    unsigned long recargas;
+} RecargaConfiguracao;
+
+// Bloqueia o SIGHUP e abre o signalfd. Chamada antes de criar qualquer
+// thread, com os padrões de antes do arquivo e a configuração já
+// carregada; calibrar = 0 quando os servos vieram da linha de comando.
+// Retorna 0 ou -1
+int abrirRecargaConfiguracao(RecargaConfiguracao *r, const char *caminho,
+                             const Configuracao *inicial, const Configuracao *atual,
+                             int calibrar);
+
+// Cria a thread de recarga para o grupo, com o perfil e o tick da
+// varredura; retorna 0 ou -1
+int iniciarRecargaConfiguracao(RecargaConfiguracao *r, GrupoServos *servos,
+                               const PerfilMovimento *perfil, long periodo_tick_ns,
+                               Indicador *indicador);
+
+// Relê o arquivo e publica as calibrações novas; retorna 0 ou -1
+int recarregarConfiguracao(RecargaConfiguracao *r);
+
+// Encerra a thread e fecha o signalfd
+void fecharRecargaConfiguracao(RecargaConfiguracao *r);
+
+#endif
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/signalfd.h>
+
+#include "encerramento.h"
+
+// Lê um sinal pendente; retorna o número ou 0 se não houver
+static int lerSinal(Encerramento *e) {
+    struct signalfd_siginfo info;
+
+    if (read(e->fd, &info, sizeof(info)) != sizeof(info)) {
+        return 0;
+    }
+    return (int)info.ssi_signo;
+}
+
+// Função para preparar o encerramento
+int abrirEncerramento(Encerramento *e, double angulo, long prazo_ms,
+                      const PerfilMovimento *perfil, long periodo_ns) {
+    sigset_t sinais;
+
+    memset(e, 0, sizeof(*e));
+    e->fd = -1;
+    if (angulo < 0.0 || angulo > ANGULO_MAX) {
+        fprintf(stderr, "Ângulo de estacionamento inválido: %.1f\n", angulo);
+        return -1;
+    }
+    if (prazo_ms <= 0 || prazo_ms * 1000000LL / periodo_ns >= TRAJETORIA_TICKS_MAX) {
+        fprintf(stderr, "Prazo de estacionamento inválido: %ld ms (até %lld ms)\n",
+                prazo_ms, (long long)periodo_ns * (TRAJETORIA_TICKS_MAX - 1) / 1000000);
+        return -1;
+    }
+    e->angulo = angulo;
+    e->prazo_ms = prazo_ms;
+    e->periodo_ns = periodo_ns;
+
+    // O perfil do programa, acelerado só se o curso inteiro não couber no
+    // prazo (com folga de um tick para o passo final)
+    e->perfil = *perfil;
+    double prazo_s = (prazo_ms * 1000000LL - periodo_ns) / 1e9;
+    if (duracaoMovimento(&e->perfil, ANGULO_MAX) > prazo_s &&
+        escalarPerfil(&e->perfil, ANGULO_MAX, prazo_s) < 0) {
+        return -1;
+    }
+
+    sigemptyset(&sinais);
+    sigaddset(&sinais, SIGTERM);
+    sigaddset(&sinais, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &sinais, NULL);
+    e->fd = signalfd(-1, &sinais, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (e->fd < 0) {
+        perror("signalfd");
+        pthread_sigmask(SIG_UNBLOCK, &sinais, NULL);
+        return -1;
+    }
+    return 0;
+}
+
+// Função para conferir se o encerramento foi pedido
+int encerramentoPedido(Encerramento *e) {
+    if (!e->sinal) {
+        e->sinal = lerSinal(e);
+    }
+    return e->sinal != 0;
+}
+
+// 1 se algum dos servos estacionados ainda tem passos do movimento
+static int estacionamentoPendente(const GrupoServos *grupo, const int *indices,
+                                  int num) {
+    for (int i = 0; i < num; i++) {
+        if (grupo->servos[indices[i]].atual) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Função para estacionar os servos
+void estacionarServos(Encerramento *e, GrupoServos *grupo,
+                      LedsIndicadores *leds, const Relogio *relogio) {
+    int indices[SERVOS_MAX];
+    double alvos[SERVOS_MAX];
+    Trajetoria *destinos[SERVOS_MAX];
+    int movendo = 0;
+    int planejado = 1;
+
+    // Todos os servos livres chegam juntos ao estacionamento
+    for (int i = 0; i < grupo->num; i++) {
+        Servo *s = &grupo->servos[i];
+        s->atual = NULL;
+        if (s->falhas & (FALHA_EMERGENCIA | FALHA_FIM_DE_CURSO)) {
+            continue;
+        }
+        indices[movendo] = i;
+        alvos[movendo] = e->angulo;
+        destinos[movendo] = &e->trajetorias[i];
+        movendo++;
+    }
+    if (movendo > 0 &&
+        planejarMovimentoCoordenado(grupo, indices, alvos, movendo, destinos,
+                                    &e->perfil, 0.0, e->periodo_ns) < 0) {
+        movendo = 0;
+        planejado = 0;
+    }
+    for (int i = 0; i < movendo; i++) {
+        iniciarMovimento(&grupo->servos[indices[i]], destinos[i]);
+    }
+
+    // Mesmo que algum servo não chegue (travado, em malha fechada), o
+    // movimento nunca passa do prazo. O fim é o último passo escrito, e
+    // não o tick seguinte, em que avancarServos() já não teria o que
+    // escrever: o curso inteiro usa todos os ticks do prazo
+    Agendador agendador;
+    long limite = (long)(e->prazo_ms * 1000000LL / e->periodo_ns);
+    iniciarAgendador(&agendador, relogio, e->periodo_ns);
+    while (estacionamentoPendente(grupo, indices, movendo) &&
+           agendador.ticks < (unsigned long)limite) {
+        if (lerSinal(e)) {
+            break;                  // Segundo sinal: desiste do estacionamento
+        }
+        avancarServos(grupo);
+        esperarProximoTick(&agendador);
+    }
+    int pendente = estacionamentoPendente(grupo, indices, movendo);
+    for (int i = 0; i < grupo->num; i++) {
+        grupo->servos[i].atual = NULL;
+    }
+
+    e->duracao_ms = (long)(agendador.ticks * e->periodo_ns / 1000000);
+    e->concluido = planejado && !pendente;
+    aplicarLeds(leds, 0);
+}
+
+// Função para fechar o encerramento
+void fecharEncerramento(Encerramento *e) {
+    if (e->fd >= 0) {
+        close(e->fd);
+        e->fd = -1;
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef ENCERRAMENTO_H
+#define ENCERRAMENTO_H
+
+#include "servos.h"
+#include "leds.h"
+#include "agendador.h"
+#include "trajetoria.h"
+
+// Posição de estacionamento padrão (graus) e prazo do movimento (ms)
+#define PARQUE_ANGULO_PADRAO 0.0
+#define PARQUE_PRAZO_MS_PADRAO 1000
+
+// Encerramento por sinal.
+// SIGTERM e SIGINT ficam bloqueados em todas as threads e chegam por um
+// signalfd lido pelo próprio laço de controle: no servidor, como mais uma
+// fonte do epoll; na varredura e na memória, sem bloquear, a cada tick.
+// O laço então termina e a thread de controle leva os servos à posição de
+// estacionamento com o perfil preparado na partida, que percorre o curso
+// inteiro dentro do prazo. Só depois o processo apaga os LEDs e libera
+// canais e linhas, e o próximo início encontra o PWM desexportado. Um
+// segundo sinal durante o estacionamento o interrompe.
+typedef struct {
+    int fd;                         // signalfd de SIGTERM e SIGINT
+    int sinal;                      // Primeiro sinal recebido (0 = nenhum)
+    double angulo;                  // Posição de estacionamento (graus)
+    long prazo_ms;
+    long periodo_ns;                // Tick do movimento
+    PerfilMovimento perfil;         // Percorre 180° em até prazo_ms
+    Trajetoria trajetorias[SERVOS_MAX];
+    long duracao_ms;                // Tempo gasto no estacionamento
+    int concluido;                  // 1 = todos chegaram dentro do prazo
+} Encerramento;
+
+// Bloqueia os sinais e abre o signalfd. Chamada antes de criar qualquer
+// thread, que herdam a máscara. Retorna 0 ou -1
+int abrirEncerramento(Encerramento *e, double angulo, long prazo_ms,
+                      const PerfilMovimento *perfil, long periodo_ns);
+
+// Descritor a acompanhar em um laço de eventos
+static inline int descritorEncerramento(const Encerramento *e) {
+    return e->fd;
+}
+
+// Lê o signalfd sem bloquear; retorna 1 se o encerramento foi pedido
+int encerramentoPedido(Encerramento *e);
+
+// Leva os servos à posição de estacionamento em no máximo prazo_ms e
+// apaga os LEDs (roda na thread de controle, no relógio do backend).
+// O movimento é coordenado: os servos chegam juntos. Servos em emergência
+// ou em fim de curso ficam onde estão
+void estacionarServos(Encerramento *e, GrupoServos *grupo,
+                      LedsIndicadores *leds, const Relogio *relogio);
+
+// Fecha o signalfd
+void fecharEncerramento(Encerramento *e);
+
+#endif
@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "entradas.h"
+#include "gpio.h"
+
+// Função para interpretar uma entrada na linha de comando
+int interpretarEntrada(ConfigEntrada *cfg, const char *texto) {
+    char tipo[16];
+    unsigned int pino;
+    int canal = -1;
+    int campos = sscanf(texto, "%15[^:]:%u:%d", tipo, &pino, &canal);
+
+    if (campos >= 2 && strcmp(tipo, "emergencia") == 0 && campos == 2) {
+        cfg->tipo = ENTRADA_EMERGENCIA;
+    } else if (campos == 3 && strcmp(tipo, "min") == 0 && canal >= 0) {
+        cfg->tipo = ENTRADA_FIM_MIN;
+    } else if (campos == 3 && strcmp(tipo, "max") == 0 && canal >= 0) {
+        cfg->tipo = ENTRADA_FIM_MAX;
+    } else {
+        fprintf(stderr, "Entrada inválida: '%s' (use emergencia:PINO, "
+                "min:PINO:SERVO ou max:PINO:SERVO)\n", texto);
+        return -1;
+    }
+    cfg->pino = pino;
+    cfg->canal = canal;
+    return 0;
+}
+
+// Função para pedir as entradas
+int abrirEntradas(EntradasDigitais *e, const char *chip,
+                  const ConfigEntrada *cfg, unsigned int num) {
+    unsigned int pinos[ENTRADAS_MAX];
+    enum gpiod_line_value valores[ENTRADAS_MAX];
+
+    memset(e, 0, sizeof(*e));
+    if (num == 0 || num > ENTRADAS_MAX) {
+        fprintf(stderr, "Número de entradas inválido: %u\n", num);
+        return -1;
+    }
+    for (unsigned int i = 0; i < num; i++) {
+        for (unsigned int j = 0; j < i; j++) {
+            if (cfg[j].pino == cfg[i].pino) {
+                fprintf(stderr, "Linha %u usada em duas entradas\n", cfg[i].pino);
+                return -1;
+            }
+        }
+        e->cfg[i] = cfg[i];
+        pinos[i] = cfg[i].pino;
+    }
+
+    e->chip = abrirChipGpio(chip);
+    if (!e->chip) {
+        return -1;
+    }
+
+    struct gpiod_line_settings *config = gpiod_line_settings_new();
+    if (config) {
+        gpiod_line_settings_set_direction(config, GPIOD_LINE_DIRECTION_INPUT);
+        gpiod_line_settings_set_edge_detection(config, GPIOD_LINE_EDGE_BOTH);
+        gpiod_line_settings_set_bias(config, GPIOD_LINE_BIAS_PULL_UP);
+        gpiod_line_settings_set_active_low(config, true);
+        gpiod_line_settings_set_debounce_period_us(config, ENTRADAS_DEBOUNCE_US);
+        gpiod_line_settings_set_event_clock(config, GPIOD_LINE_CLOCK_MONOTONIC);
+        e->pedido = pedirLinhasGpio(e->chip, pinos, num, config,
+                                    "servo_entradas", ENTRADAS_EVENTOS);
+        gpiod_line_settings_free(config);
+    }
+    e->buffer = gpiod_edge_event_buffer_new(ENTRADAS_EVENTOS);
+    if (!e->pedido || !e->buffer) {
+        perror("Erro ao configurar as entradas");
+        fecharEntradas(e);
+        return -1;
+    }
+
+    // Estado inicial: uma entrada já acionada não gera borda
+    if (gpiod_line_request_get_values_subset(e->pedido, num, pinos, valores) < 0) {
+        perror("Erro ao ler as entradas");
+        fecharEntradas(e);
+        return -1;
+    }
+    e->num = num;
+    for (unsigned int i = 0; i < num; i++) {
+        if (valores[i] == GPIOD_LINE_VALUE_ACTIVE) {
+            e->ativas |= 1u << i;
+        }
+    }
+    return 0;
+}
+
+// Função para obter o descritor de eventos
+int descritorEntradas(const EntradasDigitais *e) {
+    return gpiod_line_request_get_fd(e->pedido);
+}
+
+// Função para ler os eventos de borda pendentes
+int lerEventosEntradas(EntradasDigitais *e, EventoEntrada *eventos, int max) {
+    if (max > ENTRADAS_EVENTOS) {
+        max = ENTRADAS_EVENTOS;
+    }
+    int n = gpiod_line_request_read_edge_events(e->pedido, e->buffer, (size_t)max);
+    if (n < 0) {
+        return 0;
+    }
+
+    int saida = 0;
+    for (int k = 0; k < n; k++) {
+        struct gpiod_edge_event *ev = gpiod_edge_event_buffer_get_event(e->buffer, k);
+        unsigned int pino = gpiod_edge_event_get_line_offset(ev);
+        // Com active_low as bordas já vêm no sentido lógico: subida = acionada
+        int ativo = gpiod_edge_event_get_event_type(ev) == GPIOD_EDGE_EVENT_RISING_EDGE;
+
+        for (unsigned int i = 0; i < e->num; i++) {
+            if (e->cfg[i].pino != pino) {
+                continue;
+            }
+            // O filtro de repique pode entregar bordas repetidas
+            if (((e->ativas >> i) & 1u) == (unsigned int)ativo) {
+                break;
+            }
+            e->ativas ^= 1u << i;
+            e->eventos++;
+            eventos[saida].indice = (int)i;
+            eventos[saida].ativo = ativo;
+            eventos[saida].instante_ns = gpiod_edge_event_get_timestamp_ns(ev);
+            saida++;
+            break;
+        }
+    }
+    return saida;
+}
+
+// Função para consultar se uma entrada do tipo está acionada
+int entradaAtiva(const EntradasDigitais *e, TipoEntrada tipo, int canal) {
+    if (!e) {
+        return 0;
+    }
+    for (unsigned int i = 0; i < e->num; i++) {
+        if (e->cfg[i].tipo == tipo && ((e->ativas >> i) & 1u) &&
+            (tipo == ENTRADA_EMERGENCIA || e->cfg[i].canal == canal)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Função para liberar as entradas
+void fecharEntradas(EntradasDigitais *e) {
+    if (e->buffer) gpiod_edge_event_buffer_free(e->buffer);
+    if (e->pedido) gpiod_line_request_release(e->pedido);
+    if (e->chip) gpiod_chip_close(e->chip);
+    e->buffer = NULL;
+    e->pedido = NULL;
+    e->chip = NULL;
+}
@@ -0,0 +1,73 @@
+#ifndef ENTRADAS_H
+#define ENTRADAS_H
+
+#include <stdint.h>
+#include <gpiod.h>
+
+// Número máximo de entradas digitais
+#define ENTRADAS_MAX 8
+
+// Filtro de repique aplicado pelo kernel em cada entrada (us)
+#define ENTRADAS_DEBOUNCE_US 5000
+
+// Eventos lidos por chamada
+#define ENTRADAS_EVENTOS 16
+
+// Função de uma entrada
+typedef enum {
+    ENTRADA_EMERGENCIA,     // Botão de emergência: corta o PWM de todos os servos
+    ENTRADA_FIM_MIN,        // Fim de curso do lado de 0°
+    ENTRADA_FIM_MAX         // Fim de curso do lado de 180°
+} TipoEntrada;
+
+// Uma entrada: função, linha do chip e servo afetado (fins de curso)
+typedef struct {
+    TipoEntrada tipo;
+    unsigned int pino;
+    int canal;
+} ConfigEntrada;
+
+// Mudança de estado de uma entrada
+typedef struct {
+    int indice;                     // Posição em EntradasDigitais.cfg
+    int ativo;                      // 1 = acionada
+    uint64_t instante_ns;           // CLOCK_MONOTONIC do kernel
+} EventoEntrada;
+
+// Entradas digitais em um único gpiod_line_request (API v2).
+// As linhas são ativas em nível baixo (contato para o terra com pull-up),
+// com detecção das duas bordas e filtro de repique no kernel. As bordas
+// chegam como eventos no descritor do pedido, que vai para o laço de
+// eventos: nada é lido por polling.
+typedef struct {
+    struct gpiod_chip *chip;
+    struct gpiod_line_request *pedido;
+    struct gpiod_edge_event_buffer *buffer;
+    ConfigEntrada cfg[ENTRADAS_MAX];
+    unsigned int num;
+    unsigned int ativas;            // Máscara (bit i = entrada i acionada)
+    unsigned long eventos;
+} EntradasDigitais;
+
+// Interpreta "emergencia:PINO", "min:PINO:SERVO" ou "max:PINO:SERVO";
+// retorna 0 ou -1 se o texto for inválido
+int interpretarEntrada(ConfigEntrada *cfg, const char *texto);
+
+// Pede as linhas do chip como entradas com eventos de borda e lê o estado
+// inicial
+int abrirEntradas(EntradasDigitais *e, const char *chip,
+                  const ConfigEntrada *cfg, unsigned int num);
+
+// Descritor que fica legível quando há eventos
+int descritorEntradas(const EntradasDigitais *e);
+
+// Lê os eventos pendentes (até max) e atualiza ativas; retorna quantos
+int lerEventosEntradas(EntradasDigitais *e, EventoEntrada *eventos, int max);
+
+// 1 se alguma entrada do tipo está acionada (para fins de curso, do servo)
+int entradaAtiva(const EntradasDigitais *e, TipoEntrada tipo, int canal);
+
+// Libera o pedido e o chip
+void fecharEntradas(EntradasDigitais *e);
+
+#endif
@@ -0,0 +1,326 @@
+// Micro-benchmark dos caminhos de escrita do PWM e do GPIO.
+//
+// Mede o custo por escrita de cada alternativa (fopen/fprintf, open/write
+// por escrita, descritor persistente, pwrite com texto pronto, gpiod v2
+// linha a linha e em bloco no mesmo pedido, e GPIO via sysfs) e imprime o resultado
+// em CSV ou JSON para comparação entre versões.
+//
+// Compilação (a partir da raiz do projeto):
+//   gcc -O2 -Wall -I. -o bench_escrita ferramentas/bench_escrita.c pwm.c gpio.c -lgpiod
+//
+// Sem hardware, --falso cria uma árvore sysfs falsa (arquivos comuns) em
+// --raiz, de preferência em um tmpfs como /dev/shm.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <gpiod.h>
+
+#include "pwm.h"
+#include "gpio.h"
+
+#define ITERACOES_PADRAO 10000
+#define DUTY_BASE 1000000
+#define DUTY_FAIXA 1000000
+
+// Resultado de um método
+typedef struct {
+    const char *metodo;
+    int iteracoes;
+    double media_ns;
+    long p50_ns;
+    long p99_ns;
+    long max_ns;
+} Resultado;
+
+// Estado comum aos métodos medidos
+typedef struct {
+    char duty[PWM_TAM_CAMINHO + 32];    // Caminho do duty_cycle
+    char gpio_sysfs[PWM_TAM_CAMINHO];   // Caminho do value de um GPIO sysfs
+    CanalPWM pwm;                       // Só fd_duty é usado
+    struct gpiod_line_request *pedido;
+    unsigned int pinos[2];
+    int fd_gpio_sysfs;
+} Bancada;
+
+static long *amostras;
+
+static long agoraNs(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &t);
+    return t.tv_sec * 1000000000L + t.tv_nsec;
+}
+
+static int compararLong(const void *a, const void *b) {
+    long x = *(const long *)a, y = *(const long *)b;
+    return (x > y) - (x < y);
+}
+
+// Uma escrita do método i; retorna -1 em erro
+typedef int (*Metodo)(Bancada *b, int i);
+
+static int pwmFopen(Bancada *b, int i) {
+    FILE *fp = fopen(b->duty, "w");
+    if (!fp) return -1;
+    fprintf(fp, "%d", DUTY_BASE + i % DUTY_FAIXA);
+    fclose(fp);
+    return 0;
+}
+
+static int pwmOpenWrite(Bancada *b, int i) {
+    char buf[PWM_TAM_VALOR];
+    int len = formatarInteiro(buf, DUTY_BASE + i % DUTY_FAIXA);
+    int fd = open(b->duty, O_WRONLY);
+    if (fd < 0) return -1;
+    int ret = write(fd, buf, len) == len ? 0 : -1;
+    close(fd);
+    return ret;
+}
+
+static int pwmFdWrite(Bancada *b, int i) {
+    char buf[PWM_TAM_VALOR];
+    int len = formatarInteiro(buf, DUTY_BASE + i % DUTY_FAIXA);
+    if (lseek(b->pwm.fd_duty, 0, SEEK_SET) < 0) return -1;
+    return write(b->pwm.fd_duty, buf, len) == len ? 0 : -1;
+}
+
+static int pwmPwrite(Bancada *b, int i) {
+    return setPWMDutyCycle(&b->pwm, DUTY_BASE + i % DUTY_FAIXA);
+}
+
+static int pwmPwriteTexto(Bancada *b, int i) {
+    // Texto pré-formatado, como nos passos das trajetórias
+    static char textos[2][PWM_TAM_VALOR];
+    static int lens[2];
+    if (lens[0] == 0) {
+        lens[0] = formatarInteiro(textos[0], DUTY_BASE);
+        lens[1] = formatarInteiro(textos[1], DUTY_BASE + DUTY_FAIXA);
+    }
+    return setPWMDutyCycleTexto(&b->pwm, DUTY_BASE + (i & 1) * DUTY_FAIXA,
+                                textos[i & 1], lens[i & 1]);
+}
+
+static int gpioSimples(Bancada *b, int i) {
+    if (gpiod_line_request_set_value(b->pedido, b->pinos[0],
+                                     (enum gpiod_line_value)(i & 1)) < 0) return -1;
+    return gpiod_line_request_set_value(b->pedido, b->pinos[1],
+                                        (enum gpiod_line_value)!(i & 1));
+}
+
+static int gpioBloco(Bancada *b, int i) {
+    enum gpiod_line_value valores[2] = {
+        (enum gpiod_line_value)(i & 1), (enum gpiod_line_value)!(i & 1)
+    };
+    return gpiod_line_request_set_values(b->pedido, valores);
+}
+
+static int gpioSysfs(Bancada *b, int i) {
+    static const char valores[2] = { '0', '1' };
+    return pwrite(b->fd_gpio_sysfs, &valores[i & 1], 1, 0) == 1 ? 0 : -1;
+}
+
+// Mede um método e acrescenta o resultado à lista
+static int medir(Bancada *b, const char *nome, Metodo m, int iteracoes,
+                 Resultado *resultados, int *n) {
+    Resultado *r = &resultados[*n];
+    double soma = 0.0;
+
+    for (int i = 0; i < iteracoes; i++) {
+        long t0 = agoraNs();
+        if (m(b, i) < 0) {
+            fprintf(stderr, "%s: falhou na iteração %d\n", nome, i);
+            return -1;
+        }
+        amostras[i] = agoraNs() - t0;
+        soma += amostras[i];
+    }
+    qsort(amostras, iteracoes, sizeof(long), compararLong);
+
+    r->metodo = nome;
+    r->iteracoes = iteracoes;
+    r->media_ns = soma / iteracoes;
+    r->p50_ns = amostras[iteracoes / 2];
+    r->p99_ns = amostras[(int)(iteracoes * 0.99)];
+    r->max_ns = amostras[iteracoes - 1];
+    (*n)++;
+    return 0;
+}
+
+// Cria pwmchip0/pwm0/{period,duty_cycle,enable} como arquivos comuns
+static int criarSysfsFalso(const char *raiz) {
+    static const char *const atributos[] = { "period", "duty_cycle", "enable" };
+    char caminho[PWM_TAM_CAMINHO + 32];
+
+    snprintf(caminho, sizeof(caminho), "%s/pwmchip0", raiz);
+    mkdir(raiz, 0755);
+    mkdir(caminho, 0755);
+    snprintf(caminho, sizeof(caminho), "%s/pwmchip0/pwm0", raiz);
+    mkdir(caminho, 0755);
+    for (int i = 0; i < 3; i++) {
+        snprintf(caminho, sizeof(caminho), "%s/pwmchip0/pwm0/%s", raiz, atributos[i]);
+        int fd = open(caminho, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            perror(caminho);
+            return -1;
+        }
+        close(fd);
+    }
+    return 0;
+}
+
+static void imprimirCsv(const Resultado *r, int n) {
+    printf("metodo,iteracoes,media_ns,p50_ns,p99_ns,max_ns\n");
+    for (int i = 0; i < n; i++) {
+        printf("%s,%d,%.1f,%ld,%ld,%ld\n", r[i].metodo, r[i].iteracoes,
+               r[i].media_ns, r[i].p50_ns, r[i].p99_ns, r[i].max_ns);
+    }
+}
+
+static void imprimirJson(const Resultado *r, int n) {
+    printf("[\n");
+    for (int i = 0; i < n; i++) {
+        printf("  {\"metodo\": \"%s\", \"iteracoes\": %d, \"media_ns\": %.1f, "
+               "\"p50_ns\": %ld, \"p99_ns\": %ld, \"max_ns\": %ld}%s\n",
+               r[i].metodo, r[i].iteracoes, r[i].media_ns, r[i].p50_ns,
+               r[i].p99_ns, r[i].max_ns, i + 1 < n ? "," : "");
+    }
+    printf("]\n");
+}
+
+static void mostrarUso(const char *programa) {
+    printf("Uso: %s [opções]\n"
+           "  --raiz DIR         diretório com pwmchip0 (padrão /sys/class/pwm)\n"
+           "  --falso            cria uma árvore sysfs falsa em --raiz\n"
+           "  --gpio-chip NOME   chip GPIO dos LEDs (padrão gpiochip2)\n"
+           "  --linhas A,B       linhas GPIO medidas (padrão 0,26)\n"
+           "  --sem-gpio         não mede os caminhos de GPIO\n"
+           "  --gpio-sysfs ARQ   mede também um value de /sys/class/gpio\n"
+           "  --iteracoes N      escritas por método (padrão %d)\n"
+           "  --formato F        csv ou json (padrão csv)\n",
+           programa, ITERACOES_PADRAO);
+}
+
+int main(int argc, char *argv[]) {
+    const char *raiz = "/sys/class/pwm";
+    const char *gpio_chip = "gpiochip2";
+    unsigned int pinos[2] = { 0, 26 };
+    int falso = 0, sem_gpio = 0, json = 0;
+    int iteracoes = ITERACOES_PADRAO;
+    Bancada b;
+
+    memset(&b, 0, sizeof(b));
+    b.fd_gpio_sysfs = -1;
+
+    static const struct option opcoes[] = {
+        { "raiz",       required_argument, NULL, 'r' },
+        { "falso",      no_argument,       NULL, 'f' },
+        { "gpio-chip",  required_argument, NULL, 'g' },
+        { "linhas",     required_argument, NULL, 'l' },
+        { "sem-gpio",   no_argument,       NULL, 'G' },
+        { "gpio-sysfs", required_argument, NULL, 's' },
+        { "iteracoes",  required_argument, NULL, 'n' },
+        { "formato",    required_argument, NULL, 'F' },
+        { "ajuda",      no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "r:fg:l:Gs:n:F:h", opcoes, NULL)) != -1) {
+        switch (opt) {
+        case 'r': raiz = optarg; break;
+        case 'f': falso = 1; break;
+        case 'g': gpio_chip = optarg; break;
+        case 'l':
+            if (sscanf(optarg, "%u,%u", &pinos[0], &pinos[1]) != 2) {
+                fprintf(stderr, "Linhas inválidas: '%s'\n", optarg);
+                return 1;
+            }
+            break;
+        case 'G': sem_gpio = 1; break;
+        case 's': snprintf(b.gpio_sysfs, sizeof(b.gpio_sysfs), "%s", optarg); break;
+        case 'n': iteracoes = atoi(optarg); break;
+        case 'F': json = strcmp(optarg, "json") == 0; break;
+        case 'h': mostrarUso(argv[0]); return 0;
+        default:  mostrarUso(argv[0]); return 1;
+        }
+    }
+    if (iteracoes < 1) {
+        fprintf(stderr, "Número de iterações inválido\n");
+        return 1;
+    }
+
+    if (falso && criarSysfsFalso(raiz) < 0) {
+        return 1;
+    }
+
+    // O canal precisa já estar exportado (ou ser a árvore falsa)
+    snprintf(b.duty, sizeof(b.duty), "%s/pwmchip0/pwm0/duty_cycle", raiz);
+    b.pwm.ops = &OPERACOES_PWM_SYSFS;
+    b.pwm.fd_duty = open(b.duty, O_WRONLY);
+    if (b.pwm.fd_duty < 0) {
+        perror(b.duty);
+        return 1;
+    }
+
+    amostras = malloc(sizeof(long) * iteracoes);
+    if (!amostras) {
+        perror("malloc");
+        return 1;
+    }
+
+    Resultado resultados[8];
+    int n = 0;
+    int erro = 0;
+
+    erro |= medir(&b, "pwm_fopen_fprintf", pwmFopen, iteracoes, resultados, &n);
+    erro |= medir(&b, "pwm_open_write_close", pwmOpenWrite, iteracoes, resultados, &n);
+    erro |= medir(&b, "pwm_fd_lseek_write", pwmFdWrite, iteracoes, resultados, &n);
+    erro |= medir(&b, "pwm_fd_pwrite", pwmPwrite, iteracoes, resultados, &n);
+    erro |= medir(&b, "pwm_fd_pwrite_texto", pwmPwriteTexto, iteracoes, resultados, &n);
+
+    struct gpiod_chip *chip = NULL;
+    if (!sem_gpio) {
+        struct gpiod_line_settings *config = gpiod_line_settings_new();
+        chip = abrirChipGpio(gpio_chip);
+        if (chip && config) {
+            gpiod_line_settings_set_direction(config, GPIOD_LINE_DIRECTION_OUTPUT);
+            gpiod_line_settings_set_output_value(config, GPIOD_LINE_VALUE_INACTIVE);
+            b.pinos[0] = pinos[0];
+            b.pinos[1] = pinos[1];
+            b.pedido = pedirLinhasGpio(chip, pinos, 2, config, "bench_escrita", 0);
+        }
+        if (config) gpiod_line_settings_free(config);
+        if (!b.pedido) {
+            perror("GPIO indisponível, pulando gpiod");
+        } else {
+            erro |= medir(&b, "gpio_gpiod_simples", gpioSimples, iteracoes, resultados, &n);
+            erro |= medir(&b, "gpio_gpiod_bloco", gpioBloco, iteracoes, resultados, &n);
+            gpiod_line_request_release(b.pedido);
+        }
+    }
+
+    if (b.gpio_sysfs[0]) {
+        b.fd_gpio_sysfs = open(b.gpio_sysfs, O_WRONLY);
+        if (b.fd_gpio_sysfs < 0) {
+            perror(b.gpio_sysfs);
+        } else {
+            erro |= medir(&b, "gpio_sysfs_pwrite", gpioSysfs, iteracoes, resultados, &n);
+            close(b.fd_gpio_sysfs);
+        }
+    }
+
+    if (json) {
+        imprimirJson(resultados, n);
+    } else {
+        imprimirCsv(resultados, n);
+    }
+
+    if (chip) gpiod_chip_close(chip);
+    close(b.pwm.fd_duty);
+    free(amostras);
+    return erro ? 1 : 0;
+}
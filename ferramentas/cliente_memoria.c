@@ -0,0 +1,119 @@
+// Cliente da memória compartilhada: escreve um alvo e/ou mostra o estado.
+//
+//   cliente_memoria [--nome N] [--canal C] [--angulo A] [--perfil P]
+//                   [--direto] [--estado] [--acompanhar MS]
+//
+// Depois do mmap nenhuma operação faz chamada de sistema: o alvo é escrito
+// sob o seqlock do bloco de alvos e o estado é lido com lerSeq().
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <sys/mman.h>
+
+#include "segmento.h"
+#include "trajetoria.h"
+
+static void mostrarEstado(const SegmentoControle *seg) {
+    BlocoEstado e;
+    lerSeq(&seg->estado.seq, &e, &seg->estado, sizeof(e));
+    printf("tick %llu | overruns %llu | LEDs 0x%x | leituras adiadas %u\n",
+           (unsigned long long)e.ticks, (unsigned long long)e.overruns, e.leds,
+           e.leituras_adiadas);
+    for (uint32_t i = 0; i < e.num_canais && i < SEGMENTO_CANAIS; i++) {
+        printf("  servo %u: %7.3f° | duty %d ns | alvo #%u%s%s\n", i,
+               e.canais[i].angulo_mgraus / 1000.0, e.canais[i].duty,
+               e.canais[i].sequencia, e.canais[i].em_movimento ? " | em movimento" : "",
+               e.canais[i].em_repouso ? " | em repouso" : "");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const char *nome = SEGMENTO_NOME_PADRAO;
+    int canal = 0;
+    double angulo = -1.0;
+    int perfil = SEGMENTO_PERFIL_PADRAO;
+    int estado = 0;
+    int acompanhar_ms = 0;
+
+    static const struct option opcoes[] = {
+        { "nome",       required_argument, NULL, 'N' },
+        { "canal",      required_argument, NULL, 'c' },
+        { "angulo",     required_argument, NULL, 'a' },
+        { "perfil",     required_argument, NULL, 'P' },
+        { "direto",     no_argument,       NULL, 'D' },
+        { "estado",     no_argument,       NULL, 'e' },
+        { "acompanhar", required_argument, NULL, 'w' },
+        { NULL, 0, NULL, 0 }
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "N:c:a:P:Dew:", opcoes, NULL)) != -1) {
+        switch (opt) {
+        case 'N': nome = optarg; break;
+        case 'c': canal = atoi(optarg); break;
+        case 'a': angulo = atof(optarg); break;
+        case 'P': {
+            TipoPerfil tipo;
+            if (interpretarPerfil(optarg, &tipo) < 0) {
+                return 1;
+            }
+            perfil = tipo;
+            break;
+        }
+        case 'D': perfil = SEGMENTO_DIRETO; break;
+        case 'e': estado = 1; break;
+        case 'w': acompanhar_ms = atoi(optarg); estado = 1; break;
+        default:
+            fprintf(stderr, "Uso: %s [--nome N] [--canal C] [--angulo A] "
+                    "[--perfil P] [--direto] [--estado] [--acompanhar MS]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int fd = shm_open(nome, O_RDWR, 0);
+    if (fd < 0) {
+        perror(nome);
+        return 1;
+    }
+    SegmentoControle *seg = mmap(NULL, sizeof(*seg), PROT_READ | PROT_WRITE,
+                                 MAP_SHARED, fd, 0);
+    close(fd);
+    if (seg == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    if (seg->magico != SEGMENTO_MAGICO || seg->versao != SEGMENTO_VERSAO ||
+        seg->tamanho != sizeof(*seg)) {
+        fprintf(stderr, "%s: segmento com layout diferente\n", nome);
+        return 1;
+    }
+    if (canal < 0 || canal >= SEGMENTO_CANAIS) {
+        fprintf(stderr, "Canal inválido: %d\n", canal);
+        return 1;
+    }
+
+    if (angulo >= 0.0) {
+        AlvoSegmento *a = &seg->alvos.alvos[canal];
+        iniciarEscritaSeq(&seg->alvos.seq);
+        a->angulo_mgraus = (int32_t)(angulo * 1000.0 + 0.5);
+        a->perfil = (uint8_t)perfil;
+        a->ativo = 1;
+        a->sequencia++;
+        terminarEscritaSeq(&seg->alvos.seq);
+        printf("Alvo #%u: servo %d -> %.3f°\n", a->sequencia, canal, angulo);
+    }
+
+    if (estado) {
+        do {
+            mostrarEstado(seg);
+            if (acompanhar_ms > 0) {
+                usleep((useconds_t)acompanhar_ms * 1000);
+            }
+        } while (acompanhar_ms > 0);
+    }
+
+    munmap(seg, sizeof(*seg));
+    return 0;
+}
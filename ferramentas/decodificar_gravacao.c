@@ -0,0 +1,109 @@
+// Decodificador do gravador de telemetria: converte o anel para CSV.
+//
+//   decodificar_gravacao [--ultimos S] [--canal C] ARQUIVO
+//
+// Lê o arquivo mapeado somente para leitura, com o programa rodando ou
+// não: a cabeca do anel diz até onde os registros estão completos. Com
+// --ultimos, só saem os registros dos S segundos anteriores ao mais novo.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "gravacao.h"
+
+#define NS_POR_S 1000000000LL
+
+// Instante em ISO 8601 (UTC, microssegundos)
+static void formatarInstante(int64_t ns, char *texto, size_t tamanho) {
+    time_t s = (time_t)(ns / NS_POR_S);
+    struct tm tm;
+    gmtime_r(&s, &tm);
+    size_t n = strftime(texto, tamanho, "%Y-%m-%dT%H:%M:%S", &tm);
+    snprintf(texto + n, tamanho - n, ".%06lldZ", (long long)(ns % NS_POR_S) / 1000);
+}
+
+int main(int argc, char *argv[]) {
+    double ultimos_s = 0.0;
+    int canal = -1;
+
+    static const struct option opcoes[] = {
+        { "ultimos",    required_argument, NULL, 'u' },
+        { "canal",      required_argument, NULL, 'c' },
+        { NULL, 0, NULL, 0 }
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "u:c:", opcoes, NULL)) != -1) {
+        switch (opt) {
+        case 'u': ultimos_s = atof(optarg); break;
+        case 'c': canal = atoi(optarg); break;
+        default:
+            fprintf(stderr, "Uso: %s [--ultimos S] [--canal C] ARQUIVO\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "Uso: %s [--ultimos S] [--canal C] ARQUIVO\n", argv[0]);
+        return 1;
+    }
+
+    const char *caminho = argv[optind];
+    struct stat st;
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        perror(caminho);
+        return 1;
+    }
+    if ((size_t)st.st_size < sizeof(ArquivoGravacao)) {
+        fprintf(stderr, "%s: arquivo curto demais\n", caminho);
+        return 1;
+    }
+    const ArquivoGravacao *a = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (a == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    if (a->magico != GRAVACAO_MAGICO || a->versao != GRAVACAO_VERSAO ||
+        a->tamanho_registro != sizeof(RegistroGravacao) ||
+        (uint64_t)st.st_size < tamanhoGravacao(a->capacidade)) {
+        fprintf(stderr, "%s: não é uma gravação versão %d\n", caminho, GRAVACAO_VERSAO);
+        return 1;
+    }
+
+    // O registro mais antigo de um anel cheio pode estar sendo
+    // sobrescrito agora: fica de fora
+    uint64_t fim = atomic_load_explicit(&a->cabeca, memory_order_acquire);
+    uint64_t inicio = fim >= a->capacidade ? fim - a->capacidade + 1 : 0;
+
+    int64_t desde = INT64_MIN;
+    if (ultimos_s > 0.0 && fim > inicio) {
+        desde = a->registros[(fim - 1) % a->capacidade].instante_ns -
+                (int64_t)(ultimos_s * NS_POR_S);
+    }
+
+    unsigned long escritos = 0;
+    printf("instante,canal,duty_ns,angulo,leds,latencia_us,movendo,repouso,falha\n");
+    for (uint64_t i = inicio; i < fim; i++) {
+        const RegistroGravacao *r = &a->registros[i % a->capacidade];
+        if (r->instante_ns < desde || (canal >= 0 && r->canal != canal)) {
+            continue;
+        }
+        char instante[48];
+        formatarInstante(r->instante_ns, instante, sizeof(instante));
+        printf("%s,%u,%d,%.3f,0x%x,%.1f,%d,%d,%d\n", instante, r->canal, r->duty,
+               r->angulo_mgraus / 1000.0, r->leds, r->latencia_ns / 1000.0,
+               !!(r->estado & GRAVACAO_MOVENDO), !!(r->estado & GRAVACAO_REPOUSO),
+               !!(r->estado & GRAVACAO_FALHA));
+        escritos++;
+    }
+    fprintf(stderr, "%lu registro(s) de %llu no anel (%llu gravados, período %u us)\n",
+            escritos, (unsigned long long)(fim - inicio), (unsigned long long)fim,
+            a->periodo_tick_ns / 1000);
+    return 0;
+}
@@ -0,0 +1,193 @@
+// Cliente de fluxo do servidor de comandos: transmite uma senoide em lotes
+// de pontos com instante, como faria um roteiro de coreografia no PC.
+//
+//   enviar_fluxo [--host H] [--porta N] [--unix CAMINHO] [--canais N]
+//                [--pontos N] [--intervalo MS] [--duracao S] [--periodo S]
+//
+// Cada lote leva --pontos pontos por canal espaçados de --intervalo ms e é
+// enviado no instante do seu primeiro ponto. Ao final mostra os
+// ACKs recebidos, a menor folga do buffer e os subfluxos do servidor.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <getopt.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "protocolo.h"
+
+#define NS_POR_MS 1000000LL
+
+static uint64_t agoraNs(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+static void dormirAte(uint64_t alvo_ns) {
+    struct timespec t = { (time_t)(alvo_ns / 1000000000ULL),
+                          (long)(alvo_ns % 1000000000ULL) };
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL);
+}
+
+// Lê os ACKs já recebidos sem bloquear
+static void lerAcks(int fd, unsigned *acks, int *folga_min, uint32_t *subfluxos,
+                    unsigned *rejeitados) {
+    MensagemAckLote ack;
+    while (recv(fd, &ack, sizeof(ack), MSG_DONTWAIT) == sizeof(ack)) {
+        if (ack.magico != PROTOCOLO_MAGICO || ack.tipo != MSG_ACK_LOTE) {
+            continue;
+        }
+        (*acks)++;
+        if (ack.folga_ms < *folga_min) *folga_min = ack.folga_ms;
+        *subfluxos = ack.subfluxos;
+        if (ack.status != ACK_OK) {
+            (*rejeitados)++;
+            fprintf(stderr, "Lote #%u: %s\n", ack.sequencia,
+                    descreverStatusAck(ack.status));
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const char *host = "127.0.0.1";
+    int porta = PROTOCOLO_PORTA;
+    const char *caminho = NULL;
+    int canais = 1;
+    int pontos = 10;
+    double intervalo_ms = 20.0;
+    double duracao = 5.0;
+    double periodo = 2.0;           // Período da senoide (s)
+    char local[sizeof(((struct sockaddr_un *)0)->sun_path)] = "";
+
+    static const struct option opcoes[] = {
+        { "host",      required_argument, NULL, 'H' },
+        { "porta",     required_argument, NULL, 'u' },
+        { "unix",      required_argument, NULL, 'U' },
+        { "canais",    required_argument, NULL, 'n' },
+        { "pontos",    required_argument, NULL, 'k' },
+        { "intervalo", required_argument, NULL, 'i' },
+        { "duracao",   required_argument, NULL, 'd' },
+        { "periodo",   required_argument, NULL, 'T' },
+        { NULL, 0, NULL, 0 }
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "H:u:U:n:k:i:d:T:", opcoes, NULL)) != -1) {
+        switch (opt) {
+        case 'H': host = optarg; break;
+        case 'u': porta = atoi(optarg); break;
+        case 'U': caminho = optarg; break;
+        case 'n': canais = atoi(optarg); break;
+        case 'k': pontos = atoi(optarg); break;
+        case 'i': intervalo_ms = atof(optarg); break;
+        case 'd': duracao = atof(optarg); break;
+        case 'T': periodo = atof(optarg); break;
+        default:
+            fprintf(stderr, "Uso: %s [--host H] [--porta N] [--unix CAMINHO] "
+                    "[--canais N] [--pontos N] [--intervalo MS] [--duracao S] "
+                    "[--periodo S]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (canais < 1 || pontos < 1 || canais * pontos > LOTE_PONTOS_MAX ||
+        intervalo_ms <= 0.0) {
+        fprintf(stderr, "canais x pontos deve estar entre 1 e %d\n", LOTE_PONTOS_MAX);
+        return 1;
+    }
+
+    int fd;
+    struct sockaddr_storage destino;
+    socklen_t tam_destino;
+    memset(&destino, 0, sizeof(destino));
+
+    if (caminho) {
+        struct sockaddr_un *un = (struct sockaddr_un *)&destino;
+        struct sockaddr_un eu;
+
+        fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+        memset(&eu, 0, sizeof(eu));
+        eu.sun_family = AF_UNIX;
+        snprintf(local, sizeof(local), "/tmp/enviar_fluxo.%d", (int)getpid());
+        strcpy(eu.sun_path, local);
+        if (fd < 0 || bind(fd, (struct sockaddr *)&eu, sizeof(eu)) < 0) {
+            perror("socket Unix");
+            return 1;
+        }
+        un->sun_family = AF_UNIX;
+        snprintf(un->sun_path, sizeof(un->sun_path), "%s", caminho);
+        tam_destino = sizeof(*un);
+    } else {
+        struct sockaddr_in *in = (struct sockaddr_in *)&destino;
+
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0) {
+            perror("socket UDP");
+            return 1;
+        }
+        in->sin_family = AF_INET;
+        in->sin_port = htons((uint16_t)porta);
+        if (inet_pton(AF_INET, host, &in->sin_addr) != 1) {
+            fprintf(stderr, "Endereço inválido: %s\n", host);
+            return 1;
+        }
+        tam_destino = sizeof(*in);
+    }
+
+    uint64_t passo_ns = (uint64_t)(intervalo_ms * NS_POR_MS);
+    uint64_t inicio = agoraNs();
+    uint64_t fim = inicio + (uint64_t)(duracao * 1e9);
+    uint64_t instante = inicio;
+    unsigned lotes = 0, acks = 0, rejeitados = 0;
+    int folga_min = 1 << 30;
+    uint32_t subfluxos = 0;
+
+    while (instante < fim) {
+        MensagemLote lote;
+
+        memset(&lote, 0, sizeof(lote));
+        lote.magico = PROTOCOLO_MAGICO;
+        lote.tipo = MSG_LOTE;
+        lote.flags = lotes == 0 ? LOTE_INICIO : 0;
+        lote.sequencia = lotes;
+        for (int k = 0; k < pontos; k++, instante += passo_ns) {
+            double t = (instante - inicio) / 1e9;
+            for (int c = 0; c < canais; c++) {
+                PontoLote *p = &lote.pontos[lote.num_pontos++];
+                double fase = 2.0 * M_PI * (t / periodo + (double)c / canais);
+                p->instante_ns = instante;
+                p->canal = (uint8_t)c;
+                p->angulo_mgraus = (int32_t)lround(90000.0 - 90000.0 * cos(fase));
+            }
+        }
+
+        lote.timestamp_ns = agoraNs();
+        if (sendto(fd, &lote, TAMANHO_LOTE(lote.num_pontos), 0,
+                   (struct sockaddr *)&destino, tam_destino) < 0) {
+            perror("sendto");
+            break;
+        }
+        lotes++;
+        lerAcks(fd, &acks, &folga_min, &subfluxos, &rejeitados);
+
+        // Cada lote sai no instante do seu primeiro ponto
+        dormirAte(instante);
+    }
+
+    usleep(100000);
+    lerAcks(fd, &acks, &folga_min, &subfluxos, &rejeitados);
+    printf("%u lote(s) | %u ACK(s) | %u com erro | folga mínima %d ms | "
+           "%u subfluxo(s) no servidor\n", lotes, acks, rejeitados,
+           acks ? folga_min : 0, subfluxos);
+
+    close(fd);
+    if (local[0]) {
+        unlink(local);
+    }
+    return 0;
+}
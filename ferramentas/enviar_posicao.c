@@ -0,0 +1,186 @@
+// Cliente do servidor de comandos: envia uma posição e mostra o ACK.
+//
+//   enviar_posicao [--host H] [--porta N] [--unix CAMINHO] [--perfil P]
+//                  [--duracao MS] CANAL ANGULO [CANAL ANGULO ...]
+//
+// Com mais de um par (ou com --duracao) envia um comando coordenado: os
+// servos partem juntos e chegam juntos. Com --unix usa o socket Unix de
+// datagramas (o cliente se liga a um caminho temporário para receber o
+// ACK); senão usa UDP.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <getopt.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "protocolo.h"
+#include "trajetoria.h"
+
+// Tempo máximo de espera pelo ACK (ms)
+#define TIMEOUT_ACK_MS 1000
+
+static uint64_t agoraNs(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+int main(int argc, char *argv[]) {
+    const char *host = "127.0.0.1";
+    int porta = PROTOCOLO_PORTA;
+    const char *caminho = NULL;
+    int perfil = PERFIL_PADRAO_SERVIDOR;
+    long duracao_ms = -1;
+    char local[sizeof(((struct sockaddr_un *)0)->sun_path)] = "";
+
+    static const struct option opcoes[] = {
+        { "host",   required_argument, NULL, 'H' },
+        { "porta",  required_argument, NULL, 'u' },
+        { "unix",   required_argument, NULL, 'U' },
+        { "perfil", required_argument, NULL, 'P' },
+        { "duracao", required_argument, NULL, 'd' },
+        { NULL, 0, NULL, 0 }
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "H:u:U:P:d:", opcoes, NULL)) != -1) {
+        switch (opt) {
+        case 'H': host = optarg; break;
+        case 'u': porta = atoi(optarg); break;
+        case 'U': caminho = optarg; break;
+        case 'P': {
+            TipoPerfil tipo;
+            if (interpretarPerfil(optarg, &tipo) < 0) {
+                return 1;
+            }
+            perfil = tipo;
+            break;
+        }
+        case 'd': duracao_ms = atol(optarg); break;
+        default:
+            fprintf(stderr, "Uso: %s [--host H] [--porta N] [--unix CAMINHO] "
+                    "[--perfil P] [--duracao MS] CANAL ANGULO [CANAL ANGULO ...]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    int pares = (argc - optind) / 2;
+    if (pares == 0 || (argc - optind) % 2 != 0 || pares > COORDENADO_EIXOS_MAX) {
+        fprintf(stderr, "Uso: %s [opções] CANAL ANGULO [CANAL ANGULO ...] "
+                "(até %d pares)\n", argv[0], COORDENADO_EIXOS_MAX);
+        return 1;
+    }
+
+    // Um par sem --duracao é um comando de posição; senão, coordenado
+    union {
+        MensagemPosicao posicao;
+        MensagemCoordenada coordenada;
+    } msg;
+    size_t tamanho;
+    memset(&msg, 0, sizeof(msg));
+    if (pares == 1 && duracao_ms < 0) {
+        msg.posicao.magico = PROTOCOLO_MAGICO;
+        msg.posicao.tipo = MSG_POSICAO;
+        msg.posicao.canal = (uint8_t)atoi(argv[optind]);
+        msg.posicao.perfil = (uint8_t)perfil;
+        msg.posicao.sequencia = (uint32_t)getpid();
+        msg.posicao.angulo_mgraus = (int32_t)(atof(argv[optind + 1]) * 1000.0);
+        tamanho = sizeof(msg.posicao);
+    } else {
+        msg.coordenada.magico = PROTOCOLO_MAGICO;
+        msg.coordenada.tipo = MSG_COORDENADO;
+        msg.coordenada.num_eixos = (uint8_t)pares;
+        msg.coordenada.perfil = (uint8_t)perfil;
+        msg.coordenada.sequencia = (uint32_t)getpid();
+        msg.coordenada.duracao_ms = duracao_ms > 0 ? (uint32_t)duracao_ms : 0;
+        for (int i = 0; i < pares; i++) {
+            msg.coordenada.eixos[i].canal = (uint8_t)atoi(argv[optind + 2 * i]);
+            msg.coordenada.eixos[i].angulo_mgraus =
+                (int32_t)(atof(argv[optind + 2 * i + 1]) * 1000.0);
+        }
+        tamanho = TAMANHO_COORDENADO(pares);
+    }
+
+    int fd;
+    struct sockaddr_storage destino;
+    socklen_t tam_destino;
+    memset(&destino, 0, sizeof(destino));
+
+    if (caminho) {
+        struct sockaddr_un *un = (struct sockaddr_un *)&destino;
+        struct sockaddr_un eu;
+
+        fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+        memset(&eu, 0, sizeof(eu));
+        eu.sun_family = AF_UNIX;
+        snprintf(local, sizeof(local), "/tmp/enviar_posicao.%d", (int)getpid());
+        strcpy(eu.sun_path, local);
+        if (fd < 0 || bind(fd, (struct sockaddr *)&eu, sizeof(eu)) < 0) {
+            perror("socket Unix");
+            return 1;
+        }
+        un->sun_family = AF_UNIX;
+        snprintf(un->sun_path, sizeof(un->sun_path), "%s", caminho);
+        tam_destino = sizeof(*un);
+    } else {
+        struct sockaddr_in *in = (struct sockaddr_in *)&destino;
+
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0) {
+            perror("socket UDP");
+            return 1;
+        }
+        in->sin_family = AF_INET;
+        in->sin_port = htons((uint16_t)porta);
+        if (inet_pton(AF_INET, host, &in->sin_addr) != 1) {
+            fprintf(stderr, "Endereço inválido: %s\n", host);
+            return 1;
+        }
+        tam_destino = sizeof(*in);
+    }
+
+    int status = 1;
+    if (msg.posicao.tipo == MSG_POSICAO) {
+        msg.posicao.timestamp_ns = agoraNs();
+    } else {
+        msg.coordenada.timestamp_ns = agoraNs();
+    }
+    if (sendto(fd, &msg, tamanho, 0, (struct sockaddr *)&destino, tam_destino) < 0) {
+        perror("sendto");
+    } else {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        MensagemAck ack;
+
+        if (poll(&pfd, 1, TIMEOUT_ACK_MS) <= 0) {
+            fprintf(stderr, "Sem resposta em %d ms\n", TIMEOUT_ACK_MS);
+        } else if (recv(fd, &ack, sizeof(ack), 0) != sizeof(ack) ||
+                   ack.magico != PROTOCOLO_MAGICO || ack.tipo != MSG_ACK) {
+            fprintf(stderr, "Resposta inválida\n");
+        } else {
+            uint64_t ida_volta = agoraNs() - ack.timestamp_ns;
+            char quem[32];
+            if (ack.canal == ACK_CANAL_GRUPO) {
+                snprintf(quem, sizeof(quem), "%d servos", pares);
+            } else {
+                snprintf(quem, sizeof(quem), "servo %u", ack.canal);
+            }
+            printf("#%u %s: %s | aplicado em %u us | ida e volta %.0f us | "
+                   "movimento de %u ms\n",
+                   ack.sequencia, quem, descreverStatusAck(ack.status),
+                   ack.latencia_ns / 1000, ida_volta / 1e3, ack.duracao_ms);
+            status = ack.status == ACK_OK ? 0 : 2;
+        }
+    }
+
+    close(fd);
+    if (local[0]) {
+        unlink(local);
+    }
+    return status;
+}
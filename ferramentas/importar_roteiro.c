@@ -0,0 +1,173 @@
+// Importador de roteiros: converte um CSV em um arquivo de roteiro.
+//
+//   importar_roteiro ENTRADA.csv SAIDA.rot
+//
+// Cada linha do CSV é um quadro: o instante em segundos e o ângulo (graus)
+// de cada canal, como em "1.25,90,45.5". Uma célula vazia repete o ângulo
+// do quadro anterior; linhas vazias, comentários (#) e um cabeçalho não
+// numérico são ignorados. O número de canais vem da primeira linha de
+// dados. Os quadros são escritos à medida que são lidos, então o CSV pode
+// ter qualquer tamanho.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+#include "roteiro.h"
+
+#define NS_POR_S 1000000000LL
+
+// Interpreta as células de uma linha; retorna quantas havia ou -1. Uma
+// célula vazia (vazia[i] = 1) não altera valores[i]
+static int interpretarLinha(char *linha, double *valores, int *vazia, int max) {
+    int n = 0;
+    char *celula = linha;
+
+    for (;;) {
+        char *fim_celula = strchr(celula, ',');
+        if (fim_celula) *fim_celula = '\0';
+        while (isspace((unsigned char)*celula)) celula++;
+        if (n == max) {
+            return -1;
+        }
+        if (*celula == '\0') {
+            vazia[n] = 1;
+        } else {
+            char *fim;
+            valores[n] = strtod(celula, &fim);
+            while (isspace((unsigned char)*fim)) fim++;
+            if (fim == celula || *fim != '\0') {
+                return -1;
+            }
+            vazia[n] = 0;
+        }
+        n++;
+        if (!fim_celula) {
+            return n;
+        }
+        celula = fim_celula + 1;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Uso: %s ENTRADA.csv SAIDA.rot\n", argv[0]);
+        return 1;
+    }
+    FILE *entrada = fopen(argv[1], "r");
+    if (!entrada) {
+        perror(argv[1]);
+        return 1;
+    }
+    FILE *saida = fopen(argv[2], "wb");
+    if (!saida) {
+        perror(argv[2]);
+        fclose(entrada);
+        return 1;
+    }
+
+    // O cabeçalho é reescrito no fim, com o número de quadros e a duração
+    CabecalhoRoteiro cab;
+    memset(&cab, 0, sizeof(cab));
+    fwrite(&cab, sizeof(cab), 1, saida);
+
+    union {
+        QuadroRoteiro q;
+        char bytes[sizeof(int64_t) + ROTEIRO_CANAIS_MAX * sizeof(int32_t)];
+    } quadro;
+    double valores[ROTEIRO_CANAIS_MAX + 1];
+    int vazia[ROTEIRO_CANAIS_MAX + 1];
+    char linha[1024];
+    int numero = 0;
+    int erro = 0;
+    int64_t anterior_ns = -1;
+
+    memset(&quadro, 0, sizeof(quadro));
+    while (!erro && fgets(linha, sizeof(linha), entrada)) {
+        numero++;
+        char *comentario = strchr(linha, '#');
+        if (comentario) *comentario = '\0';
+        linha[strcspn(linha, "\r\n")] = '\0';
+        char *p = linha;
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '\0') {
+            continue;
+        }
+        if (cab.num_quadros == 0 && cab.num_canais == 0 &&
+            !isdigit((unsigned char)*p) && *p != '.' && *p != '-' && *p != '+') {
+            continue;               // Cabeçalho
+        }
+
+        int n = interpretarLinha(p, valores, vazia, ROTEIRO_CANAIS_MAX + 1);
+        if (cab.num_canais == 0 && n >= 2) {
+            cab.num_canais = (uint32_t)(n - 1);
+            cab.tamanho_quadro = roteiroTamanhoQuadro(cab.num_canais);
+        }
+        if (n < 0 || n != (int)cab.num_canais + 1 || vazia[0]) {
+            fprintf(stderr, "%s:%d: esperado TEMPO,ANGULO[,ANGULO...] com até %d canais\n",
+                    argv[1], numero, ROTEIRO_CANAIS_MAX);
+            erro = 1;
+            break;
+        }
+
+        int64_t instante = (int64_t)llround(valores[0] * NS_POR_S);
+        if (instante < 0 || instante <= anterior_ns) {
+            fprintf(stderr, "%s:%d: instantes devem ser positivos e crescentes\n",
+                    argv[1], numero);
+            erro = 1;
+            break;
+        }
+        quadro.q.instante_ns = instante;
+        for (uint32_t c = 0; c < cab.num_canais; c++) {
+            if (vazia[c + 1]) {
+                if (cab.num_quadros == 0) {
+                    fprintf(stderr, "%s:%d: o primeiro quadro precisa de todos os ângulos\n",
+                            argv[1], numero);
+                    erro = 1;
+                }
+                continue;
+            }
+            if (valores[c + 1] < 0.0 || valores[c + 1] > 180.0) {
+                fprintf(stderr, "%s:%d: ângulo fora de 0..180: %g\n",
+                        argv[1], numero, valores[c + 1]);
+                erro = 1;
+            }
+            quadro.q.angulo_mgraus[c] = (int32_t)lround(valores[c + 1] * 1000.0);
+        }
+        if (!erro && fwrite(&quadro, cab.tamanho_quadro, 1, saida) != 1) {
+            perror(argv[2]);
+            erro = 1;
+        }
+        anterior_ns = instante;
+        cab.num_quadros++;
+    }
+    fclose(entrada);
+
+    if (!erro && cab.num_quadros == 0) {
+        fprintf(stderr, "%s: nenhum quadro\n", argv[1]);
+        erro = 1;
+    }
+    if (!erro) {
+        cab.magico = ROTEIRO_MAGICO;
+        cab.versao = ROTEIRO_VERSAO;
+        cab.duracao_ns = anterior_ns;
+        if (fseek(saida, 0, SEEK_SET) != 0 || fwrite(&cab, sizeof(cab), 1, saida) != 1) {
+            perror(argv[2]);
+            erro = 1;
+        }
+    }
+    if (fclose(saida) != 0 && !erro) {
+        perror(argv[2]);
+        erro = 1;
+    }
+    if (erro) {
+        remove(argv[2]);
+        return 1;
+    }
+
+    printf("%s: %llu quadros | %u canal(is) | %.3fs\n", argv[2],
+           (unsigned long long)cab.num_quadros, cab.num_canais, cab.duracao_ns / 1e9);
+    return 0;
+}
@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "fluxo.h"
+#include "protocolo.h"
+
+#define FLUXO_MASCARA (FLUXO_CAPACIDADE - 1)
+
+_Static_assert((FLUXO_CAPACIDADE & FLUXO_MASCARA) == 0,
+               "FLUXO_CAPACIDADE deve ser potência de 2");
+
+// Função para interpretar o modo de subfluxo
+int interpretarModoSubfluxo(const char *nome, ModoSubfluxo *modo) {
+    if (strcmp(nome, "manter") == 0) {
+        *modo = SUBFLUXO_MANTER;
+    } else if (strcmp(nome, "extrapolar") == 0) {
+        *modo = SUBFLUXO_EXTRAPOLAR;
+    } else {
+        fprintf(stderr, "Modo de subfluxo inválido: '%s' (use manter ou extrapolar)\n", nome);
+        return -1;
+    }
+    return 0;
+}
+
+// Função para iniciar o fluxo
+void iniciarFluxo(FluxoSetpoints *f, long atraso_ns, ModoSubfluxo modo) {
+    memset(f, 0, sizeof(*f));
+    f->atraso_ns = atraso_ns;
+    f->modo = modo;
+}
+
+// Função para ressincronizar o relógio remoto
+void reiniciarRelogioFluxo(FluxoSetpoints *f) {
+    f->sincronizado = 0;
+}
+
+// Função para guardar um ponto no buffer do canal
+int inserirPontoFluxo(FluxoSetpoints *f, int canal, uint64_t instante_remoto,
+                      int32_t angulo_mgraus, long long agora_ns) {
+    CanalFluxo *c = &f->canais[canal];
+
+    // O primeiro ponto do fluxo define o mapeamento: ele será reproduzido
+    // atraso_ns depois de chegar, e os seguintes mantêm o espaçamento
+    // original
+    if (!f->sincronizado) {
+        f->deslocamento_ns = agora_ns + f->atraso_ns - (long long)instante_remoto;
+        f->sincronizado = 1;
+    }
+    long long instante = (long long)instante_remoto + f->deslocamento_ns;
+
+    if (!c->ativo) {
+        c->cabeca = c->cauda = 0;
+        c->alcancados = 0;
+        c->em_subfluxo = 0;
+        c->ativo = 1;
+    } else if (instante <= c->ultimo_inserido_ns) {
+        c->fora_de_ordem++;
+        return ACK_FORA_DE_ORDEM;
+    }
+    if (c->cabeca - c->cauda == FLUXO_CAPACIDADE) {
+        c->descartados++;
+        return ACK_BUFFER_CHEIO;
+    }
+
+    PontoFluxo *p = &c->pontos[c->cabeca & FLUXO_MASCARA];
+    p->instante_ns = instante;
+    p->angulo_mgraus = angulo_mgraus;
+    c->cabeca++;
+    c->ultimo_inserido_ns = instante;
+    c->recebidos++;
+    return 0;
+}
+
+// Função para medir a antecedência do buffer
+long long folgaFluxo(const FluxoSetpoints *f, int canal, long long agora_ns) {
+    const CanalFluxo *c = &f->canais[canal];
+    return c->ativo ? c->ultimo_inserido_ns - agora_ns : -1;
+}
+
+// Marca o fim de um subfluxo: o buffer voltou a ter pontos
+static void retomarFluxo(FluxoSetpoints *f, CanalFluxo *c) {
+    if (c->em_subfluxo) {
+        c->em_subfluxo = 0;
+        c->subfluxos++;
+        f->subfluxos++;
+    }
+}
+
+// Função para aplicar a posição do fluxo no tick
+int aplicarFluxo(FluxoSetpoints *f, int canal, Servo *servo, long long agora_ns) {
+    CanalFluxo *c = &f->canais[canal];
+
+    if (!c->ativo) {
+        return 0;
+    }
+
+    // Primeiro tick do fluxo: parte da posição atual do servo, para chegar
+    // ao primeiro ponto sem salto
+    int novo = c->alcancados == 0;      // Ponto novo neste tick: acorda o servo
+    if (c->alcancados == 0) {
+        c->anterior.instante_ns = agora_ns;
+        c->anterior.angulo_mgraus = (int32_t)lround(anguloAtual(servo) * 1000.0);
+        c->penultimo = c->anterior;
+        c->alcancados = 1;
+    }
+
+    // Consome os pontos cujo instante já chegou
+    while (c->cauda != c->cabeca &&
+           c->pontos[c->cauda & FLUXO_MASCARA].instante_ns <= agora_ns) {
+        c->penultimo = c->anterior;
+        c->anterior = c->pontos[c->cauda & FLUXO_MASCARA];
+        c->cauda++;
+        if (c->alcancados < 2) c->alcancados++;
+        retomarFluxo(f, c);
+        novo = 1;
+    }
+
+    double angulo;
+    if (c->cauda != c->cabeca) {
+        // Retomada depois de um subfluxo: interpola a partir do que foi
+        // realmente escrito, não do último ponto recebido
+        if (c->em_subfluxo) {
+            c->anterior.instante_ns = agora_ns;
+            c->anterior.angulo_mgraus = c->escrito_mgraus;
+            retomarFluxo(f, c);
+        }
+        const PontoFluxo *a = &c->anterior;
+        const PontoFluxo *b = &c->pontos[c->cauda & FLUXO_MASCARA];
+        double fracao = (double)(agora_ns - a->instante_ns) /
+                        (double)(b->instante_ns - a->instante_ns);
+        angulo = a->angulo_mgraus + fracao * (b->angulo_mgraus - a->angulo_mgraus);
+    } else {
+        // Subfluxo: nada à frente no buffer. Não bloqueia o tick; mantém o
+        // último ponto ou segue a velocidade dos dois últimos por até
+        // FLUXO_ESPERA_MAX_MS e então encerra o fluxo do canal
+        long long desde = agora_ns - c->anterior.instante_ns;
+        c->em_subfluxo = 1;
+        if (desde > FLUXO_ESPERA_MAX_MS * 1000000LL) {
+            c->ativo = 0;
+            return 0;
+        }
+        angulo = c->anterior.angulo_mgraus;
+        if (f->modo == SUBFLUXO_EXTRAPOLAR && c->alcancados >= 2 &&
+            c->anterior.instante_ns > c->penultimo.instante_ns) {
+            double vel = (double)(c->anterior.angulo_mgraus - c->penultimo.angulo_mgraus) /
+                         (double)(c->anterior.instante_ns - c->penultimo.instante_ns);
+            angulo += vel * desde;
+        }
+    }
+
+    int32_t mgraus = (int32_t)lround(angulo);
+    if (mgraus < 0) mgraus = 0;
+    if (mgraus > ANGULO_MAX * 1000) mgraus = ANGULO_MAX * 1000;
+    c->escrito_mgraus = mgraus;
+    escreverAnguloServo(servo, c->passos, &c->passo_atual, c->escrito_mgraus, novo);
+    return 1;
+}
+
+// Função para desligar o fluxo de um canal
+void pararFluxoCanal(FluxoSetpoints *f, int canal) {
+    CanalFluxo *c = &f->canais[canal];
+    c->ativo = 0;
+    c->cabeca = c->cauda = 0;
+}
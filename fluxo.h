@@ -0,0 +1,86 @@
+#ifndef FLUXO_H
+#define FLUXO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "servos.h"
+
+// Pontos guardados por canal (potência de 2)
+#define FLUXO_CAPACIDADE 1024
+
+// Atraso padrão entre o instante de um ponto e a sua reprodução (ms)
+#define FLUXO_ATRASO_PADRAO_MS 100
+
+// Por quanto tempo além do último ponto o buffer vazio é tolerado antes de
+// o fluxo do canal terminar (ms)
+#define FLUXO_ESPERA_MAX_MS 100
+
+// O que fazer quando o tick chega e não há ponto futuro no buffer
+typedef enum {
+    SUBFLUXO_MANTER,        // Mantém o último ponto
+    SUBFLUXO_EXTRAPOLAR     // Segue a velocidade dos dois últimos pontos
+} ModoSubfluxo;
+
+// Ponto já no relógio monotônico local
+typedef struct {
+    long long instante_ns;
+    int32_t angulo_mgraus;
+} PontoFluxo;
+
+// Buffer de um canal. Só a thread de controle mexe nele (recebe os lotes
+// e consome nos ticks), então os índices não precisam de atômicos.
+typedef struct {
+    PontoFluxo pontos[FLUXO_CAPACIDADE];
+    size_t cabeca;                  // Próxima posição de escrita
+    size_t cauda;                   // Próximo ponto a consumir
+    long long ultimo_inserido_ns;   // Instante do último ponto aceito
+    PontoFluxo anterior;            // Último ponto já alcançado
+    PontoFluxo penultimo;           // O anterior a ele (para extrapolar)
+    int alcancados;                 // Pontos alcançados desde o início (até 2)
+    int ativo;                      // 1 = o canal segue o fluxo
+    int em_subfluxo;                // 1 = buffer vazio no último tick
+    int32_t escrito_mgraus;         // Último ângulo escrito pelo fluxo
+    PassoTabela passos[2];          // Passo escrito (alternado: ultimo aponta
+    int passo_atual;                // para um deles enquanto o outro é montado)
+    unsigned long recebidos;
+    unsigned long descartados;      // Buffer cheio
+    unsigned long fora_de_ordem;
+    unsigned long subfluxos;        // Buffer esvaziou e depois foi retomado
+} CanalFluxo;
+
+// Fluxo de pontos de todos os canais, com o relógio remoto mapeado no local
+typedef struct {
+    CanalFluxo canais[SERVOS_MAX];
+    long long atraso_ns;            // Profundidade do buffer de jitter
+    ModoSubfluxo modo;
+    int sincronizado;               // 1 = deslocamento válido
+    long long deslocamento_ns;      // local = remoto + deslocamento
+    unsigned long subfluxos;        // Total de todos os canais
+} FluxoSetpoints;
+
+// Converte o nome do modo de subfluxo (manter, extrapolar)
+int interpretarModoSubfluxo(const char *nome, ModoSubfluxo *modo);
+
+// Inicia o fluxo vazio
+void iniciarFluxo(FluxoSetpoints *f, long atraso_ns, ModoSubfluxo modo);
+
+// Ressincroniza o relógio remoto no próximo ponto
+void reiniciarRelogioFluxo(FluxoSetpoints *f);
+
+// Guarda um ponto do canal (instante no relógio do cliente); retorna 0 ou
+// ACK_BUFFER_CHEIO / ACK_FORA_DE_ORDEM
+int inserirPontoFluxo(FluxoSetpoints *f, int canal, uint64_t instante_remoto,
+                      int32_t angulo_mgraus, long long agora_ns);
+
+// Quanto o buffer do canal tem à frente de agora (ns; negativo = vazio)
+long long folgaFluxo(const FluxoSetpoints *f, int canal, long long agora_ns);
+
+// Escreve no servo a posição do fluxo em agora_ns, se o canal segue o
+// fluxo. Retorna 1 enquanto o fluxo do canal continua ativo
+int aplicarFluxo(FluxoSetpoints *f, int canal, Servo *servo, long long agora_ns);
+
+// Desliga o fluxo do canal (por exemplo, ao receber um comando de posição)
+void pararFluxoCanal(FluxoSetpoints *f, int canal);
+
+#endif
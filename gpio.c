@@ -0,0 +1,44 @@
+#include <stdio.h>
+
+#include "gpio.h"
+
+// Função para abrir um chip GPIO pelo nome ou caminho
+struct gpiod_chip *abrirChipGpio(const char *nome) {
+    char caminho[64];
+
+    if (nome[0] == '/') {
+        snprintf(caminho, sizeof(caminho), "%s", nome);
+    } else {
+        snprintf(caminho, sizeof(caminho), "/dev/%.58s", nome);
+    }
+    struct gpiod_chip *chip = gpiod_chip_open(caminho);
+    if (!chip) {
+        perror(caminho);
+    }
+    return chip;
+}
+
+// Função para pedir um grupo de linhas com a mesma configuração
+struct gpiod_line_request *pedirLinhasGpio(struct gpiod_chip *chip,
+                                           const unsigned int *pinos,
+                                           unsigned int num,
+                                           struct gpiod_line_settings *config,
+                                           const char *consumidor,
+                                           unsigned int eventos) {
+    struct gpiod_line_request *pedido = NULL;
+    struct gpiod_line_config *linhas = gpiod_line_config_new();
+    struct gpiod_request_config *req = gpiod_request_config_new();
+
+    if (linhas && req &&
+        gpiod_line_config_add_line_settings(linhas, pinos, num, config) == 0) {
+        gpiod_request_config_set_consumer(req, consumidor);
+        if (eventos > 0) {
+            gpiod_request_config_set_event_buffer_size(req, eventos);
+        }
+        pedido = gpiod_chip_request_lines(chip, req, linhas);
+    }
+
+    if (req) gpiod_request_config_free(req);
+    if (linhas) gpiod_line_config_free(linhas);
+    return pedido;
+}
@@ -0,0 +1,19 @@
+#ifndef GPIO_H
+#define GPIO_H
+
+#include <gpiod.h>
+
+// Abre um chip GPIO pelo nome (gpiochipN, procurado em /dev) ou pelo
+// caminho absoluto do dispositivo
+struct gpiod_chip *abrirChipGpio(const char *nome);
+
+// Pede num linhas do chip com as mesmas configurações em um único
+// gpiod_line_request; retorna o pedido ou NULL
+struct gpiod_line_request *pedirLinhasGpio(struct gpiod_chip *chip,
+                                           const unsigned int *pinos,
+                                           unsigned int num,
+                                           struct gpiod_line_settings *config,
+                                           const char *consumidor,
+                                           unsigned int eventos);
+
+#endif
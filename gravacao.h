@@ -0,0 +1,53 @@
+#ifndef GRAVACAO_H
+#define GRAVACAO_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+// Layout do arquivo do gravador de telemetria (usado também pelo
+// decodificador). O arquivo é um cabeçalho seguido de um anel de
+// capacidade registros de tamanho fixo. O escritor grava o registro em
+// cabeca % capacidade e só depois avança cabeca (release); quem lê o
+// arquivo confia nos registros de cabeca - capacidade + 1 até cabeca - 1,
+// já que o mais antigo pode estar sendo sobrescrito.
+
+#define GRAVACAO_MAGICO 0x31564752u     // "RGV1"
+#define GRAVACAO_VERSAO 1
+#define GRAVACAO_REGISTROS_PADRAO 262144 // ~87 min de um servo a 50 Hz (6 MiB)
+
+// Bits de RegistroGravacao.estado
+#define GRAVACAO_MOVENDO  0x01          // Trajetória ou fluxo em curso
+#define GRAVACAO_REPOUSO  0x02          // Saída em repouso
+#define GRAVACAO_FALHA    0x04          // Alguma FALHA_* ativa
+
+// Um passo escrito em um canal (24 bytes)
+typedef struct {
+    int64_t instante_ns;        // Relógio de parede (ns desde a época)
+    int32_t duty;               // ns
+    int32_t angulo_mgraus;
+    uint32_t latencia_ns;       // Do deadline do tick ao fim das escritas
+    uint8_t canal;
+    uint8_t leds;               // Máscara das linhas não apagadas
+    uint8_t estado;             // GRAVACAO_*
+    uint8_t reservado;
+} RegistroGravacao;
+
+_Static_assert(sizeof(RegistroGravacao) == 24, "RegistroGravacao deve ter 24 bytes");
+
+typedef struct {
+    uint32_t magico;
+    uint32_t versao;
+    uint32_t tamanho_registro;  // sizeof(RegistroGravacao)
+    uint32_t capacidade;        // Registros no anel
+    uint32_t periodo_tick_ns;
+    uint32_t reservado;
+    _Alignas(64) _Atomic uint64_t cabeca;   // Registros já gravados (total)
+    RegistroGravacao registros[];
+} ArquivoGravacao;
+
+// Tamanho do arquivo para a capacidade
+static inline uint64_t tamanhoGravacao(uint32_t capacidade) {
+    return sizeof(ArquivoGravacao) + (uint64_t)capacidade * sizeof(RegistroGravacao);
+}
+
+#endif
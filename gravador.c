@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "gravador.h"
+
+#define NS_POR_S 1000000000LL
+
+// Função para interpretar "ARQUIVO[:REGISTROS]"
+int interpretarGravacao(const char *texto, char *caminho, size_t tamanho,
+                        uint32_t *capacidade) {
+    const char *sep = strrchr(texto, ':');
+    size_t n = sep ? (size_t)(sep - texto) : strlen(texto);
+
+    *capacidade = GRAVACAO_REGISTROS_PADRAO;
+    if (sep) {
+        char *fim;
+        unsigned long c = strtoul(sep + 1, &fim, 10);
+        if (*fim != '\0' || c < 2 || c > UINT32_MAX) {
+            fprintf(stderr, "Capacidade de gravação inválida: '%s'\n", sep + 1);
+            return -1;
+        }
+        *capacidade = (uint32_t)c;
+    }
+    if (n == 0 || n >= tamanho) {
+        fprintf(stderr, "Arquivo de gravação inválido: '%s'\n", texto);
+        return -1;
+    }
+    memcpy(caminho, texto, n);
+    caminho[n] = '\0';
+    return 0;
+}
+
+// Confere se o arquivo mapeado tem o layout e a capacidade esperados
+static int layoutValido(const ArquivoGravacao *a, uint32_t capacidade) {
+    return a->magico == GRAVACAO_MAGICO && a->versao == GRAVACAO_VERSAO &&
+           a->tamanho_registro == sizeof(RegistroGravacao) &&
+           a->capacidade == capacidade;
+}
+
+// Função para abrir o arquivo do gravador
+int abrirGravador(Gravador *g, const char *caminho, uint32_t capacidade,
+                  const GrupoServos *servos, const LedsIndicadores *leds,
+                  const Relogio *relogio, long periodo_ns) {
+    struct stat st;
+
+    memset(g, 0, sizeof(*g));
+    g->servos = servos;
+    g->leds = leds;
+    g->relogio = relogio;
+    g->capacidade = capacidade;
+    g->tamanho = tamanhoGravacao(capacidade);
+
+    int fd = open(caminho, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        perror(caminho);
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+
+    // Só reaproveita um arquivo com exatamente este layout; qualquer outro
+    // é recriado (ftruncate para 0 e de volta zera o conteúdo)
+    int novo = (uint64_t)st.st_size != g->tamanho;
+    if (!novo) {
+        ArquivoGravacao cab;
+        novo = pread(fd, &cab, sizeof(cab), 0) != (ssize_t)sizeof(cab) ||
+               !layoutValido(&cab, capacidade);
+    }
+    if (novo && (ftruncate(fd, 0) < 0 || ftruncate(fd, (off_t)g->tamanho) < 0)) {
+        perror("ftruncate");
+        close(fd);
+        return -1;
+    }
+
+    // MAP_POPULATE traz todas as páginas agora: nenhuma falta de página no
+    // laço (com --rt, o mlockall ainda as trava na memória)
+    g->arquivo = mmap(NULL, g->tamanho, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (g->arquivo == MAP_FAILED) {
+        perror("mmap");
+        g->arquivo = NULL;
+        return -1;
+    }
+
+    ArquivoGravacao *a = g->arquivo;
+    if (novo) {
+        a->magico = GRAVACAO_MAGICO;
+        a->versao = GRAVACAO_VERSAO;
+        a->tamanho_registro = sizeof(RegistroGravacao);
+        a->capacidade = capacidade;
+        atomic_init(&a->cabeca, 0);
+    }
+    a->periodo_tick_ns = (uint32_t)periodo_ns;
+    g->cabeca = atomic_load(&a->cabeca);
+
+    // Os instantes vão para o arquivo já no relógio de parede, para o
+    // histórico de execuções diferentes ficar em uma única linha do tempo
+    struct timespec parede, agora;
+    clock_gettime(CLOCK_REALTIME, &parede);
+    relogio->agora(relogio, &agora);
+    g->deslocamento_ns = (parede.tv_sec - agora.tv_sec) * NS_POR_S +
+                         (parede.tv_nsec - agora.tv_nsec);
+
+    printf("Gravador: %s (%u registros, %llu já gravados)\n", caminho, capacidade,
+           (unsigned long long)g->cabeca);
+    return 0;
+}
+
+// Função para gravar os passos escritos no tick
+void gravarPassosTick(Gravador *g, const Agendador *ag, int amostra) {
+    RegistroGravacao reg;
+    int lido = 0;
+
+    for (int i = 0; i < g->servos->num; i++) {
+        const Servo *s = &g->servos->servos[i];
+        if (s->ultimo == g->ultimos[i] || !s->ultimo) {
+            continue;
+        }
+        g->ultimos[i] = s->ultimo;
+
+        // Relógio e latência só são lidos se algum canal escreveu
+        if (!lido) {
+            struct timespec agora;
+            long long latencia = amostra ? atrasoTick(ag) : 0;
+            g->relogio->agora(g->relogio, &agora);
+            memset(&reg, 0, sizeof(reg));
+            reg.instante_ns = agora.tv_sec * NS_POR_S + agora.tv_nsec + g->deslocamento_ns;
+            reg.latencia_ns = latencia < 0 ? 0 : latencia > UINT32_MAX
+                ? UINT32_MAX : (uint32_t)latencia;
+            reg.leds = (uint8_t)g->leds->estado;
+            lido = 1;
+        }
+        reg.canal = (uint8_t)i;
+        reg.duty = s->ultimo->duty;
+        reg.angulo_mgraus = (int32_t)(anguloAtual(s) * 1000.0 + 0.5);
+        reg.estado = (s->atual ? GRAVACAO_MOVENDO : 0) |
+                     (s->em_repouso ? GRAVACAO_REPOUSO : 0) |
+                     (s->falhas ? GRAVACAO_FALHA : 0);
+
+        // O registro fica completo antes de cabeca o tornar visível
+        g->arquivo->registros[g->cabeca % g->capacidade] = reg;
+        atomic_store_explicit(&g->arquivo->cabeca, ++g->cabeca, memory_order_release);
+        g->gravados++;
+    }
+}
+
+// Função para fechar o gravador
+void fecharGravador(Gravador *g) {
+    if (g->arquivo) {
+        munmap(g->arquivo, g->tamanho);
+        g->arquivo = NULL;
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef GRAVADOR_H
+#define GRAVADOR_H
+
+#include <stdint.h>
+
+#include "gravacao.h"
+#include "servos.h"
+#include "leds.h"
+#include "agendador.h"
+
+// Gravador de telemetria ("caixa-preta").
+// Cada passo escrito em um canal vira um registro binário de 24 bytes em
+// um anel dentro de um arquivo mapeado com MAP_SHARED (layout em
+// gravacao.h). Gravar é só copiar o registro para a página mapeada e
+// avançar o índice, sem chamada de sistema; as páginas ficam no page cache
+// e o kernel as leva ao disco, então um travamento do processo não perde
+// nada. O arquivo é reaproveitado entre execuções, e o histórico continua
+// de onde parou. O decodificador (ferramentas/decodificar_gravacao.c)
+// converte o anel para CSV, inclusive com o programa rodando.
+typedef struct Gravador {
+    ArquivoGravacao *arquivo;
+    uint64_t tamanho;
+    uint32_t capacidade;
+    uint64_t cabeca;                // Cópia local de arquivo->cabeca
+    const GrupoServos *servos;
+    const LedsIndicadores *leds;
+    const Relogio *relogio;         // Relógio dos instantes
+    long long deslocamento_ns;      // Relógio de parede - relogio
+    const PassoTabela *ultimos[SERVOS_MAX];     // Último passo já gravado
+    unsigned long gravados;         // Registros nesta execução
+} Gravador;
+
+// Interpreta "ARQUIVO[:REGISTROS]"; retorna 0 ou -1
+int interpretarGravacao(const char *texto, char *caminho, size_t tamanho,
+                        uint32_t *capacidade);
+
+// Abre (ou cria) o arquivo com capacidade registros e o mapeia. Um
+// arquivo com outro layout ou outra capacidade é recriado vazio
+int abrirGravador(Gravador *g, const char *caminho, uint32_t capacidade,
+                  const GrupoServos *servos, const LedsIndicadores *leds,
+                  const Relogio *relogio, long periodo_ns);
+
+// Grava um registro por canal cujo passo mudou desde a última chamada.
+// amostra = 1 quando é o tick da grade: a latência é o atrasoTick(ag);
+// fora dos ticks (o primeiro passo de um comando, por exemplo) fica 0
+void gravarPassosTick(Gravador *g, const Agendador *ag, int amostra);
+
+// Atalho para os laços, em que o gravador é opcional
+static inline void gravarPassos(Gravador *g, const Agendador *ag, int amostra) {
+    if (g) {
+        gravarPassosTick(g, ag, amostra);
+    }
+}
+
+// Desfaz o mapeamento (as páginas já estão no page cache)
+void fecharGravador(Gravador *g);
+
+#endif
@@ -0,0 +1,294 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <libgen.h>
+#include <sched.h>
+#include <sys/inotify.h>
+#include <sys/resource.h>
+
+#include "indicador.h"
+
+// Bits de estado de uma regra
+#define ESTADOS_TODOS ((1u << INDICADOR_ESTADOS) - 1)
+
+static const char *const NOMES_ESTADOS[INDICADOR_ESTADOS] = {
+    "parado", "movendo", "falha"
+};
+
+// Aplica uma regra a todos os ângulos e estados que ela cobre
+static void aplicarRegra(TabelaIndicador *t, unsigned int estados,
+                         int de, int ate, uint32_t codigo) {
+    for (int e = 0; e < INDICADOR_ESTADOS; e++) {
+        if (!(estados & (1u << e))) {
+            continue;
+        }
+        for (int a = de; a <= ate; a++) {
+            t->codigo[e][a] = codigo;
+        }
+    }
+    t->regras++;
+}
+
+// Função para montar a tabela padrão
+void tabelaIndicadorPadrao(TabelaIndicador *t, unsigned int num_saidas) {
+    memset(t, 0, sizeof(*t));
+    aplicarRegra(t, ESTADOS_TODOS, 0, 90, codigoMascara(LED1_BIT, 1));
+    aplicarRegra(t, ESTADOS_TODOS, 91, ANGULO_MAX,
+                 num_saidas > 1 ? codigoMascara(LED2_BIT, 1) : 0);
+}
+
+// Interpreta a lista de estados ("*" ou "parado,falha"); retorna os bits
+// ou 0 se algum nome for desconhecido
+static unsigned int interpretarEstados(char *texto) {
+    unsigned int estados = 0;
+
+    if (strcmp(texto, "*") == 0) {
+        return ESTADOS_TODOS;
+    }
+    for (char *nome = strtok(texto, ","); nome; nome = strtok(NULL, ",")) {
+        int e;
+        for (e = 0; e < INDICADOR_ESTADOS; e++) {
+            if (strcmp(nome, NOMES_ESTADOS[e]) == 0) {
+                break;
+            }
+        }
+        if (e == INDICADOR_ESTADOS) {
+            return 0;
+        }
+        estados |= 1u << e;
+    }
+    return estados;
+}
+
+// Estado de linha de um padrão (1 = aceso); padrões novos entram na
+// tabela. Retorna -1 se a tabela já tiver LED_PADROES_MAX padrões
+static int estadoPadrao(TabelaIndicador *t, const PadraoLed *p) {
+    if (p->tipo == PADRAO_APAGADO) {
+        return 0;
+    }
+    if (p->tipo == PADRAO_ACESO) {
+        return 1;
+    }
+    for (int i = 0; i < t->num_padroes; i++) {
+        if (mesmoPadraoLed(p, &t->padroes[i])) {
+            return i + 2;
+        }
+    }
+    if (t->num_padroes == LED_PADROES_MAX) {
+        return -1;
+    }
+    t->padroes[t->num_padroes] = *p;
+    return 2 + t->num_padroes++;
+}
+
+// Interpreta as saídas de uma regra ("MASCARA[@PADRAO]+..."); grupos
+// posteriores sobrepõem as linhas dos anteriores. Retorna 0 ou -1
+static int interpretarSaidas(TabelaIndicador *t, char *texto, uint32_t validas,
+                             uint32_t *codigo) {
+    *codigo = 0;
+    for (char *grupo = strtok(texto, "+"); grupo; grupo = strtok(NULL, "+")) {
+        char *padrao = strchr(grupo, '@');
+        int n = 1;
+        if (padrao) {
+            PadraoLed p;
+            *padrao++ = '\0';
+            if (interpretarPadraoLed(&p, padrao) < 0) {
+                return -1;
+            }
+            n = estadoPadrao(t, &p);
+            if (n < 0) {
+                fprintf(stderr, "No máximo %d padrões diferentes\n", LED_PADROES_MAX);
+                return -1;
+            }
+        }
+
+        char *fim;
+        unsigned long mascara = strtoul(grupo, &fim, 0);
+        if (*grupo == '\0' || *fim != '\0' || (mascara & ~(unsigned long)validas)) {
+            return -1;
+        }
+        *codigo = (*codigo & ~codigoMascara((unsigned int)mascara, 0xF)) |
+                  codigoMascara((unsigned int)mascara, (unsigned int)n);
+    }
+    return 0;
+}
+
+// Função para compilar um arquivo de regras
+int carregarTabelaIndicador(TabelaIndicador *t, const char *caminho,
+                            unsigned int num_saidas) {
+    char linha[256];
+    int numero = 0;
+
+    FILE *f = fopen(caminho, "r");
+    if (!f) {
+        perror(caminho);
+        return -1;
+    }
+
+    // Sem regra, um ângulo fica com todos os LEDs apagados
+    memset(t, 0, sizeof(*t));
+    uint32_t validas = (1u << num_saidas) - 1;
+    while (fgets(linha, sizeof(linha), f)) {
+        char estados[64], saidas[128];
+        int de, ate;
+        numero++;
+
+        char *comentario = strchr(linha, '#');
+        if (comentario) *comentario = '\0';
+        int campos = sscanf(linha, "%63s %d %d %127s", estados, &de, &ate, saidas);
+        if (campos <= 0) {
+            continue;               // Linha vazia
+        }
+
+        uint32_t codigo = 0;
+        unsigned int bits = campos == 4 ? interpretarEstados(estados) : 0;
+        if (bits == 0 || de < 0 || ate > ANGULO_MAX || de > ate ||
+            interpretarSaidas(t, saidas, validas, &codigo) < 0) {
+            fprintf(stderr, "%s:%d: regra inválida (use ESTADOS DE ATE "
+                    "MASCARA[@PADRAO][+...], com até %u saída(s))\n",
+                    caminho, numero, num_saidas);
+            fclose(f);
+            return -1;
+        }
+        if (t->regras == INDICADOR_REGRAS_MAX) {
+            fprintf(stderr, "%s: no máximo %d regras\n", caminho, INDICADOR_REGRAS_MAX);
+            fclose(f);
+            return -1;
+        }
+        aplicarRegra(t, bits, de, ate, codigo);
+    }
+    fclose(f);
+    return 0;
+}
+
+// Função para iniciar o indicador
+int iniciarIndicador(Indicador *ind, const char *caminho, unsigned int num_saidas) {
+    TabelaIndicador *t = malloc(sizeof(*t));
+
+    memset(ind, 0, sizeof(*ind));
+    pthread_mutex_init(&ind->recarga, NULL);
+    ind->caminho = caminho;
+    ind->num_saidas = num_saidas;
+    ind->fd_inotify = -1;
+    if (!t) {
+        perror("malloc");
+        return -1;
+    }
+    if (caminho) {
+        if (carregarTabelaIndicador(t, caminho, num_saidas) < 0) {
+            free(t);
+            return -1;
+        }
+        printf("Indicador: %s (%d regra(s))\n", caminho, t->regras);
+    } else {
+        tabelaIndicadorPadrao(t, num_saidas);
+    }
+    t->geracao = ind->geracao = 1;
+    atomic_init(&ind->tabela, t);
+    atomic_init(&ind->lendo, 0);
+    atomic_init(&ind->ativo, 0);
+    return 0;
+}
+
+// Função para recarregar o arquivo de regras
+int recarregarIndicador(Indicador *ind) {
+    pthread_mutex_lock(&ind->recarga);
+    TabelaIndicador *nova = malloc(sizeof(*nova));
+    if (!nova || carregarTabelaIndicador(nova, ind->caminho, ind->num_saidas) < 0) {
+        fprintf(stderr, "Indicador: mantendo a tabela atual\n");
+        free(nova);
+        pthread_mutex_unlock(&ind->recarga);
+        return -1;
+    }
+
+    // O código aplicado nos LEDs passa a valer como de outra tabela, e
+    // a próxima consulta reaplica os padrões que tiverem mudado
+    nova->geracao = ++ind->geracao;
+
+    // Uma consulta que começar depois da troca já vê a tabela nova; basta
+    // esperar a que estiver em curso terminar
+    TabelaIndicador *antiga = atomic_exchange(&ind->tabela, nova);
+    while (atomic_load(&ind->lendo)) {
+        sched_yield();
+    }
+    free(antiga);
+
+    ind->recargas++;
+    printf("Indicador recarregado: %s (%d regra(s))\n", ind->caminho, nova->regras);
+    fflush(stdout);
+    pthread_mutex_unlock(&ind->recarga);
+    return 0;
+}
+
+// Thread de recarga: espera o arquivo ser salvo (escrita direta ou troca
+// pelo editor) e recompila
+static void *vigiarIndicador(void *arg) {
+    Indicador *ind = arg;
+    char copia[256];
+    char eventos[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    setpriority(PRIO_PROCESS, 0, 19);
+    snprintf(copia, sizeof(copia), "%s", ind->caminho);
+    const char *nome = basename(copia);
+
+    while (atomic_load_explicit(&ind->ativo, memory_order_relaxed)) {
+        struct pollfd pfd = { ind->fd_inotify, POLLIN, 0 };
+        if (poll(&pfd, 1, INDICADOR_INTERVALO_MS) <= 0) {
+            continue;
+        }
+        ssize_t n = read(ind->fd_inotify, eventos, sizeof(eventos));
+        int mudou = 0;
+        for (ssize_t i = 0; i < n; ) {
+            const struct inotify_event *ev = (const struct inotify_event *)&eventos[i];
+            if (ev->len > 0 && strcmp(ev->name, nome) == 0) {
+                mudou = 1;
+            }
+            i += (ssize_t)(sizeof(*ev) + ev->len);
+        }
+        if (mudou) {
+            recarregarIndicador(ind);
+        }
+    }
+    return NULL;
+}
+
+// Função para criar a thread de recarga
+int iniciarRecargaIndicador(Indicador *ind) {
+    char copia[256];
+
+    if (!ind->caminho) {
+        return 0;                   // Tabela padrão: nada a vigiar
+    }
+    snprintf(copia, sizeof(copia), "%s", ind->caminho);
+    ind->fd_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (ind->fd_inotify < 0 ||
+        inotify_add_watch(ind->fd_inotify, dirname(copia),
+                          IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        perror("inotify do indicador");
+        return -1;
+    }
+
+    atomic_store(&ind->ativo, 1);
+    if (pthread_create(&ind->thread, NULL, vigiarIndicador, ind) != 0) {
+        atomic_store(&ind->ativo, 0);
+        fprintf(stderr, "Erro ao criar a thread de recarga do indicador\n");
+        return -1;
+    }
+    return 0;
+}
+
+// Função para encerrar o indicador
+void fecharIndicador(Indicador *ind) {
+    if (atomic_exchange(&ind->ativo, 0)) {
+        pthread_join(ind->thread, NULL);
+    }
+    if (ind->fd_inotify >= 0) {
+        close(ind->fd_inotify);
+        ind->fd_inotify = -1;
+    }
+    free(atomic_exchange(&ind->tabela, NULL));
+    pthread_mutex_destroy(&ind->recarga);
+}
@@ -0,0 +1,106 @@
+#ifndef INDICADOR_H
+#define INDICADOR_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "leds.h"
+#include "servos.h"
+
+// Regras aceitas em um arquivo de indicador
+#define INDICADOR_REGRAS_MAX 64
+
+// Intervalo com que a thread de recarga confere se deve encerrar (ms)
+#define INDICADOR_INTERVALO_MS 200
+
+// Estado do servo mostrado pelos LEDs
+typedef enum {
+    INDICADOR_PARADO,       // Segurando a posição
+    INDICADOR_MOVENDO,      // Seguindo uma trajetória ou um fluxo
+    INDICADOR_FALHA,        // Emergência, fim de curso ou desvio de seguimento
+    INDICADOR_ESTADOS
+} EstadoIndicador;
+
+// Tabela compilada: o código dos LEDs (4 bits por linha, ver leds.h) de
+// cada estado em cada ângulo inteiro, já com todas as regras aplicadas, e
+// os padrões temporizados a que os códigos se referem. Consultá-la no
+// laço é um único acesso indexado, sem percorrer as faixas
+typedef struct {
+    uint32_t codigo[INDICADOR_ESTADOS][ANGULO_MAX + 1];
+    PadraoLed padroes[LED_PADROES_MAX];
+    int num_padroes;
+    int regras;
+    unsigned long geracao;          // Muda a cada recarga
+} TabelaIndicador;
+
+// Indicador com tabela recarregável.
+// A thread de controle é a única leitora: marca lendo, carrega o ponteiro
+// e consulta. A recarga monta a tabela nova fora do laço, troca o
+// ponteiro e só libera a antiga depois de ver lendo = 0, quando nenhuma
+// consulta pode mais estar usando a tabela antiga. O servo não para
+// durante a troca. A recarga pode vir do inotify e do SIGHUP (ver
+// configuracao.h); a trava serializa as duas de ponta a ponta.
+typedef struct Indicador {
+    _Atomic(TabelaIndicador *) tabela;
+    atomic_int lendo;
+    const char *caminho;            // Arquivo de regras (NULL = tabela padrão)
+    unsigned int num_saidas;        // Linhas do grupo de LEDs
+    int fd_inotify;
+    atomic_int ativo;               // 1 = thread de recarga rodando
+    pthread_t thread;
+    pthread_mutex_t recarga;        // Uma recarga por vez
+    unsigned long geracao;          // Última tabela montada (sob recarga)
+    unsigned long recargas;         // Sob recarga
+} Indicador;
+
+// Monta a tabela padrão: LED1 de 0° a 90° e LED2 acima, em todos os estados
+void tabelaIndicadorPadrao(TabelaIndicador *t, unsigned int num_saidas);
+
+// Compila um arquivo de regras "ESTADOS DE ATE SAIDAS" (ESTADOS é * ou
+// uma lista como parado,movendo; SAIDAS é uma ou mais máscaras das linhas
+// unidas por +, cada uma com um padrão opcional, como 0x1+0x2@piscar:250:250).
+// Regras posteriores sobrepõem as anteriores. Retorna 0 ou -1
+int carregarTabelaIndicador(TabelaIndicador *t, const char *caminho,
+                            unsigned int num_saidas);
+
+// Inicia o indicador com o arquivo (ou a tabela padrão, se NULL)
+int iniciarIndicador(Indicador *ind, const char *caminho, unsigned int num_saidas);
+
+// Recompila o arquivo e troca a tabela; em erro mantém a atual
+int recarregarIndicador(Indicador *ind);
+
+// Cria a thread de baixa prioridade que recarrega o arquivo quando ele é
+// salvo (inotify no diretório)
+int iniciarRecargaIndicador(Indicador *ind);
+
+// Encerra a thread de recarga e libera a tabela
+void fecharIndicador(Indicador *ind);
+
+// Estado de um servo: falha tem prioridade sobre movimento
+static inline EstadoIndicador estadoServo(const Servo *s) {
+    return s->falhas ? INDICADOR_FALHA
+                     : s->atual ? INDICADOR_MOVENDO : INDICADOR_PARADO;
+}
+
+// Avalia o indicador para o estado e o ângulo (0-180°) e aplica o código
+// nos LEDs; retorna a máscara das linhas não apagadas. Enquanto o código
+// não muda isto é só uma comparação: piscas e rampas correm no kernel, e
+// o laço só fala com as saídas quando o estado muda (a troca acontece sob
+// lendo, para os padrões da tabela seguirem válidos durante a escrita)
+static inline unsigned int indicarLeds(LedsIndicadores *leds,
+                                       EstadoIndicador estado, int angulo) {
+    Indicador *ind = leds->indicador;
+
+    atomic_store(&ind->lendo, 1);
+    const TabelaIndicador *t = atomic_load(&ind->tabela);
+    uint32_t codigo = t->codigo[estado][angulo];
+    if (codigo != leds->codigo || t->geracao != leds->geracao) {
+        aplicarCodigoLeds(leds, codigo, t->padroes);
+        leds->geracao = t->geracao;
+    }
+    atomic_store_explicit(&ind->lendo, 0, memory_order_release);
+    return leds->estado;
+}
+
+#endif
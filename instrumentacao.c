@@ -0,0 +1,131 @@
+#ifdef INSTRUMENTACAO
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <signal.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "instrumentacao.h"
+
+// Histograma log-linear de uma fase. Um único escritor (a thread de
+// controle) e leitores ocasionais; load/store relaxados bastam.
+typedef struct {
+    atomic_uint contagem[HIST_BUCKETS];
+    atomic_ullong amostras;
+    atomic_ullong maximo;
+} Histograma;
+
+static Histograma histogramas[NUM_FASES];
+
+static const char *const NOMES_FASE[NUM_FASES] = {
+    "pwm", "gpio", "registro", "despertar"
+};
+
+// Índice do bucket de um valor
+static unsigned int bucketDe(uint64_t v) {
+    if (v < HIST_SUB) {
+        return (unsigned int)v;
+    }
+    int msb = 63 - __builtin_clzll(v);
+    int deslocamento = msb - HIST_SUB_BITS;
+    return (unsigned int)((deslocamento + 1) * HIST_SUB +
+                          ((v >> deslocamento) & (HIST_SUB - 1)));
+}
+
+// Maior valor que cai no bucket
+static uint64_t limiteBucket(unsigned int i) {
+    if (i < HIST_SUB) {
+        return i;
+    }
+    int deslocamento = (int)(i / HIST_SUB) - 1;
+    uint64_t sub = i % HIST_SUB;
+    return ((HIST_SUB + sub + 1) << deslocamento) - 1;
+}
+
+// Função para registrar uma amostra
+void instrRegistrar(FaseLaco fase, uint64_t ns) {
+    Histograma *h = &histogramas[fase];
+    unsigned int b = bucketDe(ns);
+
+    atomic_store_explicit(&h->contagem[b],
+        atomic_load_explicit(&h->contagem[b], memory_order_relaxed) + 1,
+        memory_order_relaxed);
+    atomic_store_explicit(&h->amostras,
+        atomic_load_explicit(&h->amostras, memory_order_relaxed) + 1,
+        memory_order_relaxed);
+    if (ns > atomic_load_explicit(&h->maximo, memory_order_relaxed)) {
+        atomic_store_explicit(&h->maximo, ns, memory_order_relaxed);
+    }
+}
+
+// Valor do percentil p (0-1) a partir dos buckets
+static uint64_t percentil(const Histograma *h, uint64_t total, double p) {
+    uint64_t alvo = (uint64_t)(p * (double)total + 0.5);
+    uint64_t acumulado = 0;
+    uint64_t maximo = atomic_load_explicit(&h->maximo, memory_order_relaxed);
+
+    if (alvo == 0) {
+        alvo = 1;
+    }
+    for (unsigned int i = 0; i < HIST_BUCKETS; i++) {
+        acumulado += atomic_load_explicit(&h->contagem[i], memory_order_relaxed);
+        if (acumulado >= alvo) {
+            uint64_t limite = limiteBucket(i);
+            return limite < maximo ? limite : maximo;
+        }
+    }
+    return maximo;
+}
+
+// Função para imprimir o relatório de latências
+void imprimirInstrumentacao(void) {
+    fprintf(stderr, "\n===== Latências do laço (us) =====\n");
+    fprintf(stderr, "%-10s %10s %9s %9s %9s %9s\n",
+            "fase", "amostras", "p50", "p99", "p99.9", "max");
+    for (int f = 0; f < NUM_FASES; f++) {
+        const Histograma *h = &histogramas[f];
+        uint64_t total = atomic_load_explicit(&h->amostras, memory_order_relaxed);
+        if (total == 0) {
+            fprintf(stderr, "%-10s %10d\n", NOMES_FASE[f], 0);
+            continue;
+        }
+        fprintf(stderr, "%-10s %10llu %9.1f %9.1f %9.1f %9.1f\n",
+                NOMES_FASE[f], (unsigned long long)total,
+                percentil(h, total, 0.50) / 1e3,
+                percentil(h, total, 0.99) / 1e3,
+                percentil(h, total, 0.999) / 1e3,
+                atomic_load_explicit(&h->maximo, memory_order_relaxed) / 1e3);
+    }
+    fprintf(stderr, "\n");
+}
+
+// Thread que espera o SIGUSR1 e imprime o relatório
+static void *threadRelatorio(void *arg) {
+    sigset_t *sinais = arg;
+    int sinal;
+
+    while (sigwait(sinais, &sinal) == 0) {
+        imprimirInstrumentacao();
+    }
+    return NULL;
+}
+
+// Função para iniciar a instrumentação
+void iniciarInstrumentacao(void) {
+    static sigset_t sinais;
+    pthread_t thread;
+
+    // Bloqueado antes de criar as demais threads, que herdam a máscara:
+    // o sinal só é entregue à thread de relatório
+    sigemptyset(&sinais);
+    sigaddset(&sinais, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &sinais, NULL);
+
+    if (pthread_create(&thread, NULL, threadRelatorio, &sinais) == 0) {
+        pthread_setname_np(thread, "servo_instr");
+        pthread_detach(thread);
+    }
+}
+
+#endif
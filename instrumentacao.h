@@ -0,0 +1,61 @@
+#ifndef INSTRUMENTACAO_H
+#define INSTRUMENTACAO_H
+
+// Instrumentação de latência do laço de controle.
+// Só existe quando compilado com -DINSTRUMENTACAO; sem a flag todas as
+// macros abaixo viram nada e o laço fica idêntico ao não instrumentado.
+// As amostras vão para histogramas log-lineares (estilo HDR) de memória
+// fixa; o relatório p50/p99/p99.9/max sai no SIGUSR1 e ao encerrar.
+
+// Fases medidas no corpo do laço
+typedef enum {
+    FASE_PWM,               // Escrita do duty em todos os canais
+    FASE_GPIO,              // Atualização dos LEDs
+    FASE_REGISTRO,          // Enfileiramento do registro de console
+    FASE_DESPERTAR,         // Atraso do despertar em relação ao deadline
+    NUM_FASES
+} FaseLaco;
+
+#ifdef INSTRUMENTACAO
+
+#include <stdint.h>
+#include <time.h>
+
+// Sub-buckets por potência de 2 (16 = precisão de ~6%)
+#define HIST_SUB_BITS 4
+#define HIST_SUB (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS ((64 - HIST_SUB_BITS + 1) * HIST_SUB)
+
+// Instante atual em CLOCK_MONOTONIC_RAW (ns)
+static inline uint64_t instrAgora(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + (uint64_t)t.tv_nsec;
+}
+
+// Soma uma amostra ao histograma da fase (só a thread de controle chama)
+void instrRegistrar(FaseLaco fase, uint64_t ns);
+
+// Bloqueia SIGUSR1 e cria a thread que imprime o relatório quando ele chega
+void iniciarInstrumentacao(void);
+
+// Imprime o relatório de todas as fases no stderr
+void imprimirInstrumentacao(void);
+
+#define INSTR_INICIAR()         iniciarInstrumentacao()
+#define INSTR_ENCERRAR()        imprimirInstrumentacao()
+#define INSTR_INICIO(v)         uint64_t v = instrAgora()
+#define INSTR_FIM(fase, v)      instrRegistrar((fase), instrAgora() - (v))
+#define INSTR_AMOSTRA(fase, ns) instrRegistrar((fase), (uint64_t)(ns))
+
+#else
+
+#define INSTR_INICIAR()         ((void)0)
+#define INSTR_ENCERRAR()        ((void)0)
+#define INSTR_INICIO(v)
+#define INSTR_FIM(fase, v)      ((void)0)
+#define INSTR_AMOSTRA(fase, ns) ((void)0)
+
+#endif
+
+#endif
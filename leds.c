@@ -0,0 +1,385 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#include "leds.h"
+#include "gpio.h"
+
+static const PadraoLed PADRAO_LED_APAGADO = { PADRAO_APAGADO, 0, 0, 0 };
+static const PadraoLed PADRAO_LED_ACESO = { PADRAO_ACESO, 0, 0, 100 };
+
+// ===== Interpretação =====
+
+// Função para interpretar uma linha de --leds
+int interpretarSaidaLed(ConfigSaidaLed *cfg, const char *texto) {
+    char *fim;
+
+    memset(cfg, 0, sizeof(*cfg));
+    if (*texto == '\0') {
+        return -1;
+    }
+
+    // Só dígitos: linha do gpiochip
+    unsigned long pino = strtoul(texto, &fim, 10);
+    if (isdigit((unsigned char)*texto) && *fim == '\0') {
+        cfg->tipo = SAIDA_GPIO;
+        cfg->pino = (unsigned int)pino;
+        return 0;
+    }
+
+    // CHIP/CANAL: canal de PWM (nomes da classe leds não têm barra)
+    const char *barra = strrchr(texto, '/');
+    if (barra) {
+        long canal = strtol(barra + 1, &fim, 10);
+        if (barra == texto || barra[1] == '\0' || *fim != '\0' || canal < 0) {
+            return -1;
+        }
+        int n = (int)(barra - texto);
+        if (texto[0] == '/') {
+            snprintf(cfg->nome, sizeof(cfg->nome), "%.*s", n, texto);
+        } else {
+            snprintf(cfg->nome, sizeof(cfg->nome), "%s/%.*s", LEDS_CLASSE_PWM, n, texto);
+        }
+        cfg->tipo = SAIDA_PWM;
+        cfg->canal = (int)canal;
+        return 0;
+    }
+
+    cfg->tipo = SAIDA_CLASSE;
+    snprintf(cfg->nome, sizeof(cfg->nome), "%s", texto);
+    return 0;
+}
+
+// Função para interpretar um padrão
+int interpretarPadraoLed(PadraoLed *p, const char *texto) {
+    int a, b;
+    char resto;
+
+    if (strcmp(texto, "aceso") == 0) {
+        *p = PADRAO_LED_ACESO;
+        return 0;
+    }
+    if (sscanf(texto, "piscar:%d:%d%c", &a, &b, &resto) == 2 && a > 0 && b > 0) {
+        *p = (PadraoLed){ PADRAO_PISCAR, a, b, 100 };
+        return 0;
+    }
+    if (sscanf(texto, "respirar:%d%c", &a, &resto) == 1 && a >= 2) {
+        *p = (PadraoLed){ PADRAO_RESPIRAR, a / 2, a - a / 2, 100 };
+        return 0;
+    }
+    if (sscanf(texto, "brilho:%d%c", &a, &resto) == 1 && a >= 0 && a <= 100) {
+        *p = a > 0 ? (PadraoLed){ PADRAO_BRILHO, 0, 0, a } : PADRAO_LED_APAGADO;
+        return 0;
+    }
+    fprintf(stderr, "Padrão inválido: '%s' (aceso, piscar:LIGADO:DESLIGADO, "
+            "respirar:CICLO ou brilho:PCT)\n", texto);
+    return -1;
+}
+
+// ===== Classe leds do kernel =====
+
+// Escreve um atributo de /sys/class/leds/NOME (abre, escreve e fecha; só
+// acontece quando o padrão muda)
+static int escreverAtributoLed(const char *led, const char *atributo, const char *valor) {
+    char caminho[PWM_TAM_CAMINHO + 64];
+    snprintf(caminho, sizeof(caminho), "%s/%s/%s", LEDS_CLASSE, led, atributo);
+
+    int fd = open(caminho, O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t len = (ssize_t)strlen(valor);
+    ssize_t n = write(fd, valor, (size_t)len);
+    int erro = errno;
+    close(fd);
+    errno = erro;
+    return n == len ? 0 : -1;
+}
+
+static int escreverNumeroLed(const char *led, const char *atributo, int valor) {
+    char buf[PWM_TAM_VALOR];
+    formatarInteiro(buf, valor);
+    return escreverAtributoLed(led, atributo, buf);
+}
+
+// Programa um padrão pelos triggers do kernel: timer para o pisca e
+// pattern para a respiração (rampa interpolada pelo kernel). Sem o trigger
+// pattern, a respiração vira um pisca do mesmo ciclo
+static int padraoClasse(SaidaLed *s, const PadraoLed *p) {
+    const char *led = s->cfg.nome;
+    int brilho = s->brilho_max;
+
+    if (p->tipo == PADRAO_BRILHO) {
+        brilho = (s->brilho_max * p->brilho + 50) / 100;
+        if (brilho == 0) brilho = 1;
+    }
+
+    // Sem trigger o brilho é estático
+    if (escreverAtributoLed(led, "trigger", "none") < 0) {
+        return -1;
+    }
+    switch (p->tipo) {
+    case PADRAO_APAGADO:
+        return escreverNumeroLed(led, "brightness", 0);
+    case PADRAO_ACESO:
+    case PADRAO_BRILHO:
+        return escreverNumeroLed(led, "brightness", brilho);
+    case PADRAO_RESPIRAR: {
+        char padrao[64];
+        snprintf(padrao, sizeof(padrao), "0 %d %d %d",
+                 p->ligado_ms, s->brilho_max, p->desligado_ms);
+        if (escreverAtributoLed(led, "trigger", "pattern") == 0 &&
+            escreverAtributoLed(led, "pattern", padrao) == 0) {
+            return 0;
+        }
+    }
+        /* fallthrough */
+    case PADRAO_PISCAR:
+        if (escreverNumeroLed(led, "brightness", brilho) < 0 ||
+            escreverAtributoLed(led, "trigger", "timer") < 0 ||
+            escreverNumeroLed(led, "delay_on", p->ligado_ms) < 0 ||
+            escreverNumeroLed(led, "delay_off", p->desligado_ms) < 0) {
+            return -1;
+        }
+        return 0;
+    }
+    return -1;
+}
+
+// Confere o LED e lê o brilho máximo
+static int abrirClasse(SaidaLed *s) {
+    char caminho[PWM_TAM_CAMINHO + 64];
+    snprintf(caminho, sizeof(caminho), "%s/%s/max_brightness", LEDS_CLASSE, s->cfg.nome);
+
+    FILE *f = fopen(caminho, "r");
+    if (!f) {
+        perror(caminho);
+        return -1;
+    }
+    int lido = fscanf(f, "%d", &s->brilho_max);
+    fclose(f);
+    if (lido != 1 || s->brilho_max <= 0) {
+        fprintf(stderr, "%s: brilho máximo inválido\n", caminho);
+        return -1;
+    }
+    return padraoClasse(s, &PADRAO_LED_APAGADO);
+}
+
+// ===== Canal de PWM =====
+
+// Programa um padrão no canal: brilho pelo duty a 1 kHz e pisca pelo
+// próprio período (o PWM não faz rampa: a respiração vira um pisca de
+// mesmo ciclo)
+static int padraoPWM(SaidaLed *s, const PadraoLed *p) {
+    int periodo = LED_PERIODO_PWM;
+    int duty;
+
+    switch (p->tipo) {
+    case PADRAO_APAGADO:
+        duty = 0;
+        break;
+    case PADRAO_ACESO:
+        duty = periodo;
+        break;
+    case PADRAO_BRILHO:
+        duty = (int)((long long)periodo * p->brilho / 100);
+        break;
+    default: {
+        long long ciclo = p->ligado_ms + p->desligado_ms;
+        long long ligado = p->ligado_ms;
+        if (ciclo > LED_CICLO_PWM_MAX_MS) {
+            ligado = ligado * LED_CICLO_PWM_MAX_MS / ciclo;
+            ciclo = LED_CICLO_PWM_MAX_MS;
+        }
+        periodo = (int)(ciclo * 1000000);
+        duty = (int)(ligado * 1000000);
+        break;
+    }
+    }
+
+    if (periodo == s->periodo) {
+        return setPWMDutyCycle(&s->pwm, duty);
+    }
+    if (definirPeriodoPWM(&s->pwm, periodo, duty) < 0) {
+        return -1;
+    }
+    s->periodo = periodo;
+    return 0;
+}
+
+// ===== Backend sysfs/gpiod =====
+
+// Escreve todas as linhas GPIO do pedido em um único ioctl
+static int escreverGpiod(LedsIndicadores *leds, unsigned int mascara) {
+    enum gpiod_line_value valores[LEDS_MAX];
+    unsigned int n = 0;
+
+    for (unsigned int i = 0; i < leds->num; i++) {
+        if (leds->saidas[i].cfg.tipo != SAIDA_GPIO) {
+            continue;
+        }
+        valores[n++] = ((mascara >> i) & 1) ? GPIOD_LINE_VALUE_ACTIVE
+                                            : GPIOD_LINE_VALUE_INACTIVE;
+    }
+    return gpiod_line_request_set_values(leds->pedido, valores);
+}
+
+static int padraoSysfs(LedsIndicadores *leds, unsigned int linha, const PadraoLed *p) {
+    SaidaLed *s = &leds->saidas[linha];
+    return s->cfg.tipo == SAIDA_PWM ? padraoPWM(s, p) : padraoClasse(s, p);
+}
+
+// Libera os canais de PWM, o pedido e o chip
+static void fecharSysfs(LedsIndicadores *leds) {
+    for (unsigned int i = 0; i < leds->num; i++) {
+        if (leds->saidas[i].cfg.tipo == SAIDA_PWM) {
+            desativarPWM(&leds->saidas[i].pwm);
+        }
+    }
+    if (leds->pedido) {
+        gpiod_line_request_release(leds->pedido);
+    }
+    if (leds->chip) {
+        gpiod_chip_close(leds->chip);
+    }
+    leds->pedido = NULL;
+    leds->chip = NULL;
+}
+
+static const OperacoesLeds OPERACOES_LEDS_SYSFS = {
+    escreverGpiod,
+    padraoSysfs,
+    fecharSysfs,
+};
+
+// Pede as linhas GPIO como saída, todas apagadas, em um único pedido
+static int pedirLinhasLeds(LedsIndicadores *leds, const char *chip,
+                           const unsigned int *pinos) {
+    leds->chip = abrirChipGpio(chip);
+    if (!leds->chip) {
+        return -1;
+    }
+
+    struct gpiod_line_settings *config = gpiod_line_settings_new();
+    if (config) {
+        gpiod_line_settings_set_direction(config, GPIOD_LINE_DIRECTION_OUTPUT);
+        gpiod_line_settings_set_output_value(config, GPIOD_LINE_VALUE_INACTIVE);
+        leds->pedido = pedirLinhasGpio(leds->chip, pinos, leds->num_gpio, config,
+                                       "servo_leds", 0);
+        gpiod_line_settings_free(config);
+    }
+    if (!leds->pedido) {
+        perror("Erro ao configurar LEDs como saída");
+        gpiod_chip_close(leds->chip);
+        leds->chip = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+// Função para abrir o grupo de LEDs
+int abrirLeds(LedsIndicadores *leds, const char *chip,
+              const ConfigSaidaLed *saidas, unsigned int num) {
+    unsigned int pinos[LEDS_MAX];
+
+    memset(leds, 0, sizeof(*leds));
+    if (num == 0 || num > LEDS_MAX) {
+        fprintf(stderr, "Número de LEDs inválido: %u\n", num);
+        return -1;
+    }
+    for (unsigned int i = 0; i < num; i++) {
+        leds->saidas[i].cfg = saidas[i];
+        leds->saidas[i].atual = PADRAO_LED_APAGADO;
+        if (saidas[i].tipo == SAIDA_GPIO) {
+            pinos[leds->num_gpio++] = saidas[i].pino;
+        }
+    }
+
+    // Linhas GPIO, se houver alguma
+    if (leds->num_gpio > 0 && pedirLinhasLeds(leds, chip, pinos) < 0) {
+        return -1;
+    }
+
+    // Saídas temporizadas pelo kernel, todas apagadas
+    for (unsigned int i = 0; i < num; i++) {
+        SaidaLed *s = &leds->saidas[i];
+        int erro = 0;
+        if (s->cfg.tipo == SAIDA_CLASSE) {
+            erro = abrirClasse(s);
+        } else if (s->cfg.tipo == SAIDA_PWM) {
+            erro = inicializarPWM(&s->pwm, s->cfg.nome, s->cfg.canal, LED_PERIODO_PWM, 0);
+            s->periodo = LED_PERIODO_PWM;
+        }
+        if (erro < 0) {
+            fprintf(stderr, "Erro ao preparar a saída %u dos LEDs (%s)\n", i, s->cfg.nome);
+            leds->num = i;
+            fecharSysfs(leds);
+            return -1;
+        }
+    }
+
+    leds->ops = &OPERACOES_LEDS_SYSFS;
+    leds->num = num;
+    return 0;
+}
+
+// Função para aplicar um código: cada saída só é escrita quando o que ela
+// mostra muda, e as linhas GPIO vão todas juntas
+int aplicarCodigoLeds(LedsIndicadores *leds, uint32_t codigo, const PadraoLed *padroes) {
+    unsigned int estado = 0;
+    unsigned int gpio = 0;
+    int escreveu = 0;
+
+    for (unsigned int i = 0; i < leds->num; i++) {
+        SaidaLed *s = &leds->saidas[i];
+        unsigned int n = codigoLinha(codigo, i);
+        const PadraoLed *p = n == 0 ? &PADRAO_LED_APAGADO
+                           : n == 1 ? &PADRAO_LED_ACESO : &padroes[n - 2];
+
+        if (p->tipo != PADRAO_APAGADO) {
+            estado |= 1u << i;
+        }
+        // Uma linha GPIO só acende ou apaga: qualquer padrão vira aceso
+        if (s->cfg.tipo == SAIDA_GPIO) {
+            gpio |= estado & (1u << i);
+            continue;
+        }
+        if (mesmoPadraoLed(p, &s->atual)) {
+            continue;
+        }
+        if (leds->ops->padrao(leds, i, p) < 0) {
+            return -1;
+        }
+        s->atual = *p;
+        leds->padroes++;
+        escreveu = 1;
+    }
+    if (gpio != leds->estado_gpio) {
+        if (leds->ops->escrever(leds, gpio) < 0) {
+            return -1;
+        }
+        leds->estado_gpio = gpio;
+        escreveu = 1;
+    }
+
+    leds->codigo = codigo;
+    leds->estado = estado;
+    if (escreveu) {
+        leds->transicoes++;
+    }
+    return escreveu;
+}
+
+// Função para liberar os LEDs
+void fecharLeds(LedsIndicadores *leds) {
+    if (!leds->ops) {
+        return;
+    }
+    aplicarLeds(leds, 0);
+    leds->ops->fechar(leds);
+    leds->ops = NULL;
+}
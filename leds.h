@@ -0,0 +1,156 @@
+#ifndef LEDS_H
+#define LEDS_H
+
+#include <stdint.h>
+#include <gpiod.h>
+
+#include "pwm.h"
+
+// Número máximo de linhas em um grupo de LEDs
+#define LEDS_MAX 8
+
+// Linhas da tabela padrão do indicador (bit i = i-ésima linha do grupo)
+#define LED1_BIT 0x01           // Aceso de 0° a 90°
+#define LED2_BIT 0x02           // Aceso acima de 90°
+
+// Diretórios das saídas temporizadas pelo kernel
+#define LEDS_CLASSE "/sys/class/leds"
+#define LEDS_CLASSE_PWM "/sys/class/pwm"
+
+// Período de uma saída PWM acesa ou em brilho fixo (ns): 1 kHz
+#define LED_PERIODO_PWM 1000000
+
+// Maior ciclo de um pisca em saída PWM (ms): o período precisa caber em ns
+#define LED_CICLO_PWM_MAX_MS 2000
+
+// Padrões por linha no código de um grupo (ver codigoLinha)
+#define LED_PADROES_MAX 14
+
+struct Indicador;
+
+typedef struct LedsIndicadores LedsIndicadores;
+
+// O que uma linha mostra. Pisca, respiração e brilho são temporizados
+// pelo kernel (triggers timer/pattern da classe leds) ou pelo próprio PWM;
+// o laço de controle só os troca quando o estado muda.
+typedef enum {
+    PADRAO_APAGADO,
+    PADRAO_ACESO,
+    PADRAO_PISCAR,                  // ligado_ms aceso, desligado_ms apagado
+    PADRAO_RESPIRAR,                // Sobe e desce em ligado_ms + desligado_ms
+    PADRAO_BRILHO,                  // Aceso com brilho % fixo
+} TipoPadrao;
+
+typedef struct {
+    TipoPadrao tipo;
+    int ligado_ms;
+    int desligado_ms;
+    int brilho;                     // 0-100%
+} PadraoLed;
+
+static inline int mesmoPadraoLed(const PadraoLed *a, const PadraoLed *b) {
+    return a->tipo == b->tipo && a->ligado_ms == b->ligado_ms &&
+           a->desligado_ms == b->desligado_ms && a->brilho == b->brilho;
+}
+
+// Onde sai uma linha do grupo
+typedef enum {
+    SAIDA_GPIO,                     // Linha do gpiochip: só acesa ou apagada
+    SAIDA_CLASSE,                   // LED da classe leds do kernel
+    SAIDA_PWM,                      // Canal sobrando de um pwmchip
+} TipoSaidaLed;
+
+typedef struct {
+    TipoSaidaLed tipo;
+    unsigned int pino;              // SAIDA_GPIO: linha do gpiochip
+    char nome[PWM_TAM_CAMINHO];     // SAIDA_CLASSE: LED; SAIDA_PWM: chip
+    int canal;                      // SAIDA_PWM: canal do chip
+} ConfigSaidaLed;
+
+// Estado de uma linha
+typedef struct {
+    ConfigSaidaLed cfg;
+    PadraoLed atual;                // Padrão em vigor na saída
+    int brilho_max;                 // SAIDA_CLASSE: max_brightness
+    int periodo;                    // SAIDA_PWM: período em vigor (ns)
+    CanalPWM pwm;                   // SAIDA_PWM
+} SaidaLed;
+
+// Operações de um backend de LEDs (gpiod, simulado, ...)
+typedef struct {
+    // Escreve juntas todas as linhas SAIDA_GPIO (bit i = linha i do grupo)
+    int (*escrever)(LedsIndicadores *leds, unsigned int mascara);
+    // Programa o padrão de uma linha SAIDA_CLASSE ou SAIDA_PWM
+    int (*padrao)(LedsIndicadores *leds, unsigned int linha, const PadraoLed *p);
+    void (*fechar)(LedsIndicadores *leds);
+} OperacoesLeds;
+
+// Grupo de LEDs indicadores.
+// O que o grupo mostra é um código com 4 bits por linha (codigoLinha):
+// 0 = apagada, 1 = acesa e n >= 2 = padrão n - 2 de uma lista. As linhas
+// GPIO ficam em um único gpiod_line_request (API v2) e são escritas
+// juntas com gpiod_line_request_set_values(), em um único ioctl; nelas um
+// padrão temporizado vira aceso. As linhas da classe leds e de PWM recebem
+// o padrão inteiro e o kernel (ou o hardware) cuida da temporização.
+// Tudo fica em cache: cada saída só é escrita quando o que ela mostra muda.
+struct LedsIndicadores {
+    const OperacoesLeds *ops;
+    void *privado;                  // Estado do backend (se houver)
+    struct gpiod_chip *chip;
+    struct gpiod_line_request *pedido;
+    SaidaLed saidas[LEDS_MAX];
+    unsigned int num;
+    unsigned int num_gpio;          // Linhas no pedido
+    uint32_t codigo;                // Código atualmente na saída
+    unsigned int estado;            // Máscara das linhas não apagadas
+    unsigned int estado_gpio;       // Máscara escrita nas linhas GPIO
+    unsigned long transicoes;       // Mudanças efetivas nas saídas
+    unsigned long padroes;          // Padrões programados no kernel/PWM
+    struct Indicador *indicador;    // Tabela estado/ângulo -> código (indicador.h)
+    unsigned long geracao;          // Tabela do indicador do código aplicado
+};
+
+// Estado da linha i em um código de grupo (0 = apagada, 1 = acesa,
+// n >= 2 = padrão n - 2)
+static inline unsigned int codigoLinha(uint32_t codigo, unsigned int linha) {
+    return (codigo >> (4 * linha)) & 0xF;
+}
+
+// Código que põe o estado n em todas as linhas da máscara
+static inline uint32_t codigoMascara(unsigned int mascara, unsigned int n) {
+    uint32_t codigo = 0;
+    for (unsigned int i = 0; i < LEDS_MAX; i++) {
+        if (mascara & (1u << i)) {
+            codigo |= (uint32_t)n << (4 * i);
+        }
+    }
+    return codigo;
+}
+
+// Interpreta uma linha de --leds: número = linha do gpiochip,
+// pwmchipN/C (ou caminho/C) = canal de PWM, outro nome = LED da classe
+// leds. Retorna 0 ou -1
+int interpretarSaidaLed(ConfigSaidaLed *cfg, const char *texto);
+
+// Interpreta um padrão: aceso, piscar:LIGADO:DESLIGADO, respirar:CICLO
+// (ms) ou brilho:PCT. Retorna 0 ou -1
+int interpretarPadraoLed(PadraoLed *p, const char *texto);
+
+// Abre o chip (gpiochipN ou caminho em /dev) e pede as linhas GPIO como
+// saída; prepara as saídas da classe leds e de PWM. Tudo começa apagado
+int abrirLeds(LedsIndicadores *leds, const char *chip,
+              const ConfigSaidaLed *saidas, unsigned int num);
+
+// Aplica um código (padroes resolve os estados n >= 2; pode ser NULL se
+// não houver nenhum). Retorna 1 se escreveu, 0 se nada mudou, -1 em erro
+int aplicarCodigoLeds(LedsIndicadores *leds, uint32_t codigo, const PadraoLed *padroes);
+
+// Acende as linhas da máscara e apaga as demais
+static inline int aplicarLeds(LedsIndicadores *leds, unsigned int mascara) {
+    return aplicarCodigoLeds(leds, codigoMascara(mascara, 1), NULL);
+}
+
+// Apaga os LEDs e libera as linhas, os canais e o chip
+void fecharLeds(LedsIndicadores *leds);
+
+#endif
@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "memoria.h"
+#include "protocolo.h"
+#include "instrumentacao.h"
+
+_Static_assert(SEGMENTO_CANAIS == SERVOS_MAX,
+               "SEGMENTO_CANAIS deve acompanhar SERVOS_MAX");
+
+// Função para criar o segmento de memória compartilhada
+int abrirMemoria(MemoriaControle *mc, const char *nome, GrupoServos *servos,
+                 LedsIndicadores *leds, FilaRegistro *log,
+                 const PerfilMovimento *perfil, long periodo_ns,
+                 const Relogio *relogio) {
+    memset(mc, 0, sizeof(*mc));
+    snprintf(mc->nome, sizeof(mc->nome), "%s", nome);
+    mc->servos = servos;
+    mc->leds = leds;
+    mc->log = log;
+    mc->perfil = *perfil;
+    mc->periodo_ns = periodo_ns;
+    mc->relogio = relogio;
+
+    // Um segmento antigo pode ter outro layout: sempre recomeça do zero
+    shm_unlink(nome);
+    int fd = shm_open(nome, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0660);
+    if (fd < 0) {
+        perror(nome);
+        return -1;
+    }
+    if (ftruncate(fd, sizeof(SegmentoControle)) < 0) {
+        perror("ftruncate");
+        close(fd);
+        shm_unlink(nome);
+        return -1;
+    }
+    void *p = mmap(NULL, sizeof(SegmentoControle), PROT_READ | PROT_WRITE,
+                   MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        perror("mmap");
+        shm_unlink(nome);
+        return -1;
+    }
+    mc->seg = p;
+
+    // ftruncate já zerou o segmento (nenhum canal ativo, seqlocks pares)
+    mc->seg->tamanho = sizeof(SegmentoControle);
+    mc->seg->versao = SEGMENTO_VERSAO;
+    mc->seg->periodo_tick_ns = (uint32_t)periodo_ns;
+    mc->seg->estado.num_canais = (uint32_t)servos->num;
+    atomic_thread_fence(memory_order_release);
+    mc->seg->magico = SEGMENTO_MAGICO;
+
+    printf("Memória compartilhada: %s (%zu bytes)\n", nome, sizeof(SegmentoControle));
+    return 0;
+}
+
+// Registra um alvo recusado
+static void registrarRecusa(MemoriaControle *mc, int canal,
+                            const AlvoSegmento *a, int status) {
+    RegistroLog reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.tipo = REG_COMANDO;
+    reg.comando.sequencia = a->sequencia;
+    reg.comando.angulo_mgraus = a->angulo_mgraus;
+    reg.comando.canal = (uint8_t)canal;
+    reg.comando.status = (uint8_t)status;
+    registrar(mc->log, &reg);
+}
+
+// Aceita os alvos novos do bloco copiado
+static void aplicarAlvos(MemoriaControle *mc) {
+    for (int i = 0; i < mc->servos->num; i++) {
+        const AlvoSegmento *a = &mc->alvos[i];
+        Servo *s = &mc->servos->servos[i];
+
+        if (!a->ativo || a->sequencia == mc->aplicada[i]) {
+            continue;
+        }
+        mc->aplicada[i] = a->sequencia;
+
+        if (a->angulo_mgraus < 0 || a->angulo_mgraus > ANGULO_MAX * 1000) {
+            registrarRecusa(mc, i, a, ACK_ANGULO_INVALIDO);
+            continue;
+        }
+        if (a->perfil == SEGMENTO_DIRETO) {
+            s->atual = NULL;
+            escreverAnguloServo(s, mc->diretos[i], &mc->indice_direto[i],
+                                a->angulo_mgraus, 1);
+            continue;
+        }
+
+        PerfilMovimento perfil = mc->perfil;
+        if (a->perfil != SEGMENTO_PERFIL_PADRAO) {
+            if (a->perfil > PERFIL_SCURVE) {
+                registrarRecusa(mc, i, a, ACK_PERFIL_INVALIDO);
+                continue;
+            }
+            perfil.tipo = (TipoPerfil)a->perfil;
+        }
+        Trajetoria *t = planejarMovimento(s, mc->trajetorias[i], &perfil,
+                                          a->angulo_mgraus / 1000.0, mc->periodo_ns);
+        if (!t) {
+            registrarRecusa(mc, i, a, ACK_ERRO_PLANEJAMENTO);
+            continue;
+        }
+        // O passo 0 é a posição atual; o passo 1 sai ainda neste tick
+        s->atual = NULL;
+        if (t->num_ticks > 1) {
+            iniciarMovimento(s, t);
+            s->passo = 1;
+        }
+    }
+}
+
+// Publica o estado dos canais no segmento
+static void publicarEstado(MemoriaControle *mc, const Agendador *ag) {
+    BlocoEstado *e = &mc->seg->estado;
+    struct timespec agora;
+
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    iniciarEscritaSeq(&e->seq);
+    e->atualizado_ns = (uint64_t)agora.tv_sec * 1000000000ULL + (uint64_t)agora.tv_nsec;
+    e->ticks = ag->ticks;
+    e->overruns = ag->overruns_total;
+    e->leds = mc->leds->estado;
+    e->leituras_adiadas = mc->leituras_adiadas;
+    for (int i = 0; i < mc->servos->num; i++) {
+        const Servo *s = &mc->servos->servos[i];
+        EstadoCanalSegmento *c = &e->canais[i];
+        c->duty = s->ultimo ? s->ultimo->duty : s->cfg.duty_min;
+        c->angulo_mgraus = (int32_t)(anguloAtual(s) * 1000.0 + 0.5);
+        c->sequencia = mc->aplicada[i];
+        c->em_movimento = s->atual != NULL;
+        c->em_repouso = (uint8_t)s->em_repouso;
+    }
+    terminarEscritaSeq(&e->seq);
+}
+
+// Função para executar o laço de ticks da memória compartilhada
+void executarMemoria(MemoriaControle *mc) {
+    GrupoServos *servos = mc->servos;
+    Agendador agendador;
+
+    iniciarAgendador(&agendador, mc->relogio, mc->periodo_ns);
+    while (!mc->encerramento || !encerramentoPedido(mc->encerramento)) {
+        // Com o cliente no meio de uma escrita (ou morto nela), os alvos
+        // anteriores continuam valendo até o próximo tick
+        if (tentarLerSeq(&mc->seg->alvos.seq, mc->leitura, mc->seg->alvos.alvos,
+                         sizeof(mc->leitura))) {
+            memcpy(mc->alvos, mc->leitura, sizeof(mc->alvos));
+        } else {
+            mc->leituras_adiadas++;
+        }
+        const PassoTabela *anterior = servos->servos[0].ultimo;
+
+        INSTR_INICIO(t_pwm);
+        aplicarAlvos(mc);
+        avancarServos(servos);
+        INSTR_FIM(FASE_PWM, t_pwm);
+
+        const PassoTabela *p = servos->servos[0].ultimo;
+        unsigned int leds = 0;
+        if (p) {
+            INSTR_INICIO(t_gpio);
+            leds = indicarLeds(mc->leds, estadoServo(&servos->servos[0]), p->angulo);
+            INSTR_FIM(FASE_GPIO, t_gpio);
+        }
+        if (p != anterior && !mc->silencioso) {
+            INSTR_INICIO(t_reg);
+            registrarPasso(mc->log, p->duty, p->angulo, leds);
+            INSTR_FIM(FASE_REGISTRO, t_reg);
+        }
+
+        publicarEstado(mc, &agendador);
+        publicarMetricas(mc->metricas, &agendador, 1);
+        gravarPassos(mc->gravador, &agendador, 1);
+        baterSupervisor(mc->supervisor, &agendador);
+        esperarProximoTick(&agendador);
+    }
+}
+
+// Função para remover o segmento
+void fecharMemoria(MemoriaControle *mc) {
+    if (mc->seg) {
+        munmap(mc->seg, sizeof(SegmentoControle));
+        mc->seg = NULL;
+        shm_unlink(mc->nome);
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef MEMORIA_H
+#define MEMORIA_H
+
+#include "segmento.h"
+#include "servos.h"
+#include "leds.h"
+#include "indicador.h"
+#include "registro.h"
+#include "agendador.h"
+#include "trajetoria.h"
+#include "encerramento.h"
+#include "metricas.h"
+#include "gravador.h"
+#include "supervisor.h"
+
+// Controle por memória compartilhada.
+// Substitui a varredura: a cada tick a thread de controle copia o bloco de
+// alvos do segmento (seqlock, sem chamada de sistema), inicia um movimento
+// em cada canal cujo alvo mudou (ou escreve o alvo direto com
+// SEGMENTO_DIRETO), avança os servos e publica o bloco de estado. O laço
+// termina quando o sinal de encerramento chega.
+typedef struct {
+    SegmentoControle *seg;
+    char nome[64];
+    GrupoServos *servos;
+    LedsIndicadores *leds;
+    FilaRegistro *log;
+    PerfilMovimento perfil;         // Limites dos movimentos planejados
+    long periodo_ns;
+    const Relogio *relogio;
+    int silencioso;                 // 1 = não registrar cada passo
+    Encerramento *encerramento;     // NULL = só termina com o processo
+    Metricas *metricas;             // NULL = sem exportador
+    Gravador *gravador;             // NULL = sem gravação
+    Supervisor *supervisor;         // NULL = sem supervisor
+
+    AlvoSegmento alvos[SEGMENTO_CANAIS];    // Última cópia consistente
+    AlvoSegmento leitura[SEGMENTO_CANAIS];  // Cópia do tick, antes de conferida
+    uint32_t leituras_adiadas;              // Ticks sem cópia consistente
+    uint32_t aplicada[SERVOS_MAX];          // Sequência do último alvo aceito
+    Trajetoria trajetorias[SERVOS_MAX][2];
+    PassoTabela diretos[SERVOS_MAX][2];
+    int indice_direto[SERVOS_MAX];
+} MemoriaControle;
+
+// Cria (ou recria) o segmento nome e o prepara; retorna 0 ou -1
+int abrirMemoria(MemoriaControle *mc, const char *nome, GrupoServos *servos,
+                 LedsIndicadores *leds, FilaRegistro *log,
+                 const PerfilMovimento *perfil, long periodo_ns,
+                 const Relogio *relogio);
+
+// Executa o laço de ticks até o encerramento ser pedido
+void executarMemoria(MemoriaControle *mc);
+
+// Desfaz o mapeamento e remove o segmento
+void fecharMemoria(MemoriaControle *mc);
+
+#endif
@@ -0,0 +1,354 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+
+#include "metricas.h"
+#include "segmento.h"
+
+// Texto em montagem (nunca passa do tamanho; o excedente é descartado)
+typedef struct {
+    char *dados;
+    size_t tamanho;
+    size_t usado;
+} Texto;
+
+static void acrescentar(Texto *t, const char *formato, ...) {
+    va_list args;
+
+    if (t->usado + 1 >= t->tamanho) {
+        return;
+    }
+    va_start(args, formato);
+    int n = vsnprintf(t->dados + t->usado, t->tamanho - t->usado, formato, args);
+    va_end(args);
+    if (n > 0) {
+        t->usado += (size_t)n;
+        if (t->usado >= t->tamanho) {
+            t->usado = t->tamanho - 1;
+        }
+    }
+}
+
+// Cabeçalho de uma métrica
+static void cabecalho(Texto *t, const char *nome, const char *tipo, const char *ajuda) {
+    acrescentar(t, "# HELP %s %s\n# TYPE %s %s\n", nome, ajuda, nome, tipo);
+}
+
+// Função para preparar a publicação
+void iniciarMetricas(Metricas *m, const GrupoServos *servos,
+                     const LedsIndicadores *leds, FilaRegistro *log) {
+    memset(m, 0, sizeof(*m));
+    m->servos = servos;
+    m->leds = leds;
+    m->log = log;
+    m->fd = -1;
+    atomic_init(&m->instantaneo.seq, 0);
+    atomic_init(&m->ativo, 0);
+}
+
+// Função para publicar o instantâneo
+void publicarMetricasTick(Metricas *m, const Agendador *ag, int amostra) {
+    static const long long LIMITES[METRICAS_FAIXAS] = METRICAS_LIMITES_NS;
+    DadosMetricas *l = &m->local;
+
+    if (amostra) {
+        long long latencia = atrasoTick(ag);
+        if (latencia < 0) {
+            latencia = 0;
+        }
+        int f = 0;
+        while (f < METRICAS_FAIXAS && latencia > LIMITES[f]) {
+            f++;
+        }
+        l->latencia[f]++;
+        l->latencia_soma_ns += (uint64_t)latencia;
+    }
+
+    // Uma grade reiniciada não zera os contadores exportados
+    if (ag->ticks < m->ticks_vistos) {
+        m->ticks_base += m->ticks_vistos;
+        m->overruns_base += m->overruns_vistos;
+    }
+    m->ticks_vistos = ag->ticks;
+    m->overruns_vistos = ag->overruns_total;
+    l->ticks = m->ticks_base + ag->ticks;
+    l->overruns = m->overruns_base + ag->overruns_total;
+    l->atraso_max_ns = ag->atraso_max_ns;
+    l->transicoes_leds = m->leds->transicoes;
+    l->padroes_leds = m->leds->padroes;
+    l->leds = m->leds->estado;
+    l->fila_registro = (uint32_t)(
+        atomic_load_explicit(&m->log->cabeca, memory_order_relaxed) -
+        atomic_load_explicit(&m->log->cauda, memory_order_relaxed));
+    l->registros_descartados = atomic_load_explicit(&m->log->descartados,
+                                                    memory_order_relaxed);
+    l->comandos = m->comandos ? *m->comandos : 0;
+    l->rejeitados = m->rejeitados ? *m->rejeitados : 0;
+    l->substituidos = m->substituidos ? *m->substituidos : 0;
+    l->num_canais = (uint32_t)m->servos->num;
+    for (int i = 0; i < m->servos->num; i++) {
+        const Servo *s = &m->servos->servos[i];
+        MetricasCanal *c = &l->canais[i];
+        c->duty = s->ultimo ? s->ultimo->duty : s->cfg.duty_min;
+        c->angulo_mgraus = (int32_t)(anguloAtual(s) * 1000.0 + 0.5);
+        c->em_movimento = s->atual != NULL;
+        c->em_repouso = (uint8_t)s->em_repouso;
+        c->habilitado = (uint8_t)s->pwm.habilitado;
+        c->falhas = s->falhas;
+        c->repousos = s->repousos;
+        c->alternancias = s->pwm.alternancias;
+        if (m->fluxo) {
+            const CanalFluxo *cf = &m->fluxo->canais[i];
+            c->pontos_fluxo = (uint32_t)(cf->cabeca - cf->cauda);
+            c->subfluxos = (uint32_t)cf->subfluxos;
+        }
+    }
+
+    InstantaneoMetricas *e = &m->instantaneo;
+    iniciarEscritaSeq(&e->seq);
+    e->dados = *l;
+    terminarEscritaSeq(&e->seq);
+}
+
+// Função para montar o texto das métricas
+size_t formatarMetricas(const DadosMetricas *inst, char *texto, size_t tamanho) {
+    static const long long LIMITES[METRICAS_FAIXAS] = METRICAS_LIMITES_NS;
+    Texto t = { texto, tamanho, 0 };
+    unsigned int n = inst->num_canais;
+
+    texto[0] = '\0';
+    cabecalho(&t, "servo_ticks_total", "counter", "Ticks executados pelo agendador");
+    acrescentar(&t, "servo_ticks_total %llu\n", (unsigned long long)inst->ticks);
+    cabecalho(&t, "servo_overruns_total", "counter", "Deadlines perdidos");
+    acrescentar(&t, "servo_overruns_total %llu\n", (unsigned long long)inst->overruns);
+    cabecalho(&t, "servo_atraso_max_segundos", "gauge",
+              "Maior atraso de despertar no ciclo atual");
+    acrescentar(&t, "servo_atraso_max_segundos %.9f\n", inst->atraso_max_ns / 1e9);
+
+    cabecalho(&t, "servo_latencia_escrita_segundos", "histogram",
+              "Do deadline do tick ao fim das escritas nos canais");
+    uint64_t acumulado = 0;
+    for (int f = 0; f < METRICAS_FAIXAS; f++) {
+        acumulado += inst->latencia[f];
+        acrescentar(&t, "servo_latencia_escrita_segundos_bucket{le=\"%g\"} %llu\n",
+                    LIMITES[f] / 1e9, (unsigned long long)acumulado);
+    }
+    acumulado += inst->latencia[METRICAS_FAIXAS];
+    acrescentar(&t, "servo_latencia_escrita_segundos_bucket{le=\"+Inf\"} %llu\n"
+                "servo_latencia_escrita_segundos_sum %.9f\n"
+                "servo_latencia_escrita_segundos_count %llu\n",
+                (unsigned long long)acumulado, inst->latencia_soma_ns / 1e9,
+                (unsigned long long)acumulado);
+
+    cabecalho(&t, "servo_duty_segundos", "gauge", "Último duty escrito");
+    for (unsigned int i = 0; i < n; i++) {
+        acrescentar(&t, "servo_duty_segundos{canal=\"%u\"} %.9f\n",
+                    i, inst->canais[i].duty / 1e9);
+    }
+    cabecalho(&t, "servo_angulo_graus", "gauge", "Ângulo correspondente ao último passo");
+    for (unsigned int i = 0; i < n; i++) {
+        acrescentar(&t, "servo_angulo_graus{canal=\"%u\"} %.3f\n",
+                    i, inst->canais[i].angulo_mgraus / 1000.0);
+    }
+    cabecalho(&t, "servo_em_movimento", "gauge", "1 = trajetória em curso");
+    for (unsigned int i = 0; i < n; i++) {
+        acrescentar(&t, "servo_em_movimento{canal=\"%u\"} %u\n",
+                    i, inst->canais[i].em_movimento);
+    }
+    cabecalho(&t, "servo_habilitado", "gauge", "Enable da saída PWM");
+    for (unsigned int i = 0; i < n; i++) {
+        acrescentar(&t, "servo_habilitado{canal=\"%u\"} %u\n",
+                    i, inst->canais[i].habilitado);
+    }
+    cabecalho(&t, "servo_em_repouso", "gauge", "1 = saída em repouso, sem retenção");
+    for (unsigned int i = 0; i < n; i++) {
+        acrescentar(&t, "servo_em_repouso{canal=\"%u\"} %u\n",
+                    i, inst->canais[i].em_repouso);
+    }
+    cabecalho(&t, "servo_falhas", "gauge", "Bits FALHA_* ativos no servo");
+    for (unsigned int i = 0; i < n; i++) {
+        acrescentar(&t, "servo_falhas{canal=\"%u\"} %u\n", i, inst->canais[i].falhas);
+    }
+    cabecalho(&t, "servo_repousos_total", "counter", "Vezes que o prazo de repouso venceu");
+    for (unsigned int i = 0; i < n; i++) {
+        acrescentar(&t, "servo_repousos_total{canal=\"%u\"} %llu\n",
+                    i, (unsigned long long)inst->canais[i].repousos);
+    }
+    cabecalho(&t, "servo_alternancias_enable_total", "counter",
+              "Escritas efetivas no enable do PWM");
+    for (unsigned int i = 0; i < n; i++) {
+        acrescentar(&t, "servo_alternancias_enable_total{canal=\"%u\"} %llu\n",
+                    i, (unsigned long long)inst->canais[i].alternancias);
+    }
+    cabecalho(&t, "servo_fluxo_pontos", "gauge", "Pontos no buffer de jitter do canal");
+    for (unsigned int i = 0; i < n; i++) {
+        acrescentar(&t, "servo_fluxo_pontos{canal=\"%u\"} %u\n",
+                    i, inst->canais[i].pontos_fluxo);
+    }
+    cabecalho(&t, "servo_fluxo_subfluxos_total", "counter",
+              "Vezes que o buffer de jitter esvaziou");
+    for (unsigned int i = 0; i < n; i++) {
+        acrescentar(&t, "servo_fluxo_subfluxos_total{canal=\"%u\"} %u\n",
+                    i, inst->canais[i].subfluxos);
+    }
+
+    cabecalho(&t, "servo_leds_estado", "gauge", "Máscara das linhas de LED não apagadas");
+    acrescentar(&t, "servo_leds_estado %u\n", inst->leds);
+    cabecalho(&t, "servo_leds_transicoes_total", "counter", "Mudanças efetivas nas saídas de LED");
+    acrescentar(&t, "servo_leds_transicoes_total %llu\n",
+                (unsigned long long)inst->transicoes_leds);
+    cabecalho(&t, "servo_leds_padroes_total", "counter",
+              "Padrões programados no kernel ou no PWM");
+    acrescentar(&t, "servo_leds_padroes_total %llu\n",
+                (unsigned long long)inst->padroes_leds);
+    cabecalho(&t, "servo_fila_registro", "gauge", "Registros aguardando o console");
+    acrescentar(&t, "servo_fila_registro %u\n", inst->fila_registro);
+    cabecalho(&t, "servo_registros_descartados_total", "counter",
+              "Registros perdidos com a fila cheia");
+    acrescentar(&t, "servo_registros_descartados_total %llu\n",
+                (unsigned long long)inst->registros_descartados);
+    cabecalho(&t, "servo_comandos_total", "counter", "Comandos aplicados");
+    acrescentar(&t, "servo_comandos_total %llu\n", (unsigned long long)inst->comandos);
+    cabecalho(&t, "servo_comandos_rejeitados_total", "counter", "Comandos inválidos");
+    acrescentar(&t, "servo_comandos_rejeitados_total %llu\n",
+                (unsigned long long)inst->rejeitados);
+    cabecalho(&t, "servo_comandos_substituidos_total", "counter",
+              "Comandos substituídos por um mais novo antes do tick");
+    acrescentar(&t, "servo_comandos_substituidos_total %llu\n",
+                (unsigned long long)inst->substituidos);
+    return t.usado;
+}
+
+// Envia tudo, mesmo com escritas parciais
+static void enviarTudo(int fd, const char *dados, size_t tamanho) {
+    while (tamanho > 0) {
+        ssize_t n = send(fd, dados, tamanho, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return;
+        }
+        dados += n;
+        tamanho -= (size_t)n;
+    }
+}
+
+// Atende uma conexão: lê o pedido e responde com as métricas ou 404
+static void atenderColeta(Metricas *m, int fd) {
+    static char corpo[32768];
+    char pedido[1024];
+    char cabecalhos[256];
+    size_t lido = 0;
+
+    // Até o fim dos cabeçalhos, sem esperar mais que o prazo
+    while (lido < sizeof(pedido) - 1) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        if (poll(&pfd, 1, METRICAS_PRAZO_PEDIDO_MS) <= 0) {
+            return;
+        }
+        ssize_t n = recv(fd, pedido + lido, sizeof(pedido) - 1 - lido, 0);
+        if (n <= 0) {
+            return;
+        }
+        lido += (size_t)n;
+        pedido[lido] = '\0';
+        if (strstr(pedido, "\r\n\r\n") || strstr(pedido, "\n\n")) {
+            break;
+        }
+    }
+    pedido[lido] = '\0';
+
+    if (strncmp(pedido, "GET /metrics ", 13) != 0 &&
+        strncmp(pedido, "GET /metrics?", 13) != 0 &&
+        strncmp(pedido, "GET / ", 6) != 0) {
+        static const char NAO_ENCONTRADO[] =
+            "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        enviarTudo(fd, NAO_ENCONTRADO, sizeof(NAO_ENCONTRADO) - 1);
+        return;
+    }
+
+    DadosMetricas inst;
+    lerSeq(&m->instantaneo.seq, &inst, &m->instantaneo.dados, sizeof(inst));
+    size_t tamanho = formatarMetricas(&inst, corpo, sizeof(corpo));
+    int n = snprintf(cabecalhos, sizeof(cabecalhos),
+                     "HTTP/1.0 200 OK\r\n"
+                     "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                     "Content-Length: %zu\r\n"
+                     "Connection: close\r\n\r\n", tamanho);
+    enviarTudo(fd, cabecalhos, (size_t)n);
+    enviarTudo(fd, corpo, tamanho);
+    m->coletas++;
+}
+
+// Thread do exportador: uma conexão de cada vez, fora do caminho de controle
+static void *servirMetricas(void *arg) {
+    Metricas *m = arg;
+
+    setpriority(PRIO_PROCESS, 0, 19);
+    while (atomic_load_explicit(&m->ativo, memory_order_relaxed)) {
+        struct pollfd pfd = { m->fd, POLLIN, 0 };
+        if (poll(&pfd, 1, METRICAS_INTERVALO_MS) <= 0) {
+            continue;
+        }
+        int fd = accept4(m->fd, NULL, NULL, SOCK_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        atenderColeta(m, fd);
+        close(fd);
+    }
+    return NULL;
+}
+
+// Função para abrir a porta e criar a thread do exportador
+int iniciarExportadorMetricas(Metricas *m, int porta) {
+    struct sockaddr_in endereco;
+    int um = 1;
+
+    m->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m->fd < 0) {
+        perror("socket das métricas");
+        return -1;
+    }
+    setsockopt(m->fd, SOL_SOCKET, SO_REUSEADDR, &um, sizeof(um));
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sin_family = AF_INET;
+    endereco.sin_addr.s_addr = htonl(INADDR_ANY);
+    endereco.sin_port = htons((uint16_t)porta);
+    if (bind(m->fd, (struct sockaddr *)&endereco, sizeof(endereco)) < 0 ||
+        listen(m->fd, 4) < 0) {
+        perror("porta das métricas");
+        close(m->fd);
+        m->fd = -1;
+        return -1;
+    }
+    socklen_t tamanho = sizeof(endereco);
+    getsockname(m->fd, (struct sockaddr *)&endereco, &tamanho);
+    m->porta = ntohs(endereco.sin_port);
+
+    atomic_store(&m->ativo, 1);
+    if (pthread_create(&m->thread, NULL, servirMetricas, m) != 0) {
+        atomic_store(&m->ativo, 0);
+        fprintf(stderr, "Erro ao criar a thread do exportador de métricas\n");
+        close(m->fd);
+        m->fd = -1;
+        return -1;
+    }
+    printf("Métricas: http://0.0.0.0:%d/metrics\n", m->porta);
+    return 0;
+}
+
+// Função para encerrar o exportador
+void fecharMetricas(Metricas *m) {
+    if (atomic_exchange(&m->ativo, 0)) {
+        pthread_join(m->thread, NULL);
+    }
+    if (m->fd >= 0) {
+        close(m->fd);
+        m->fd = -1;
+    }
+}
@@ -0,0 +1,130 @@
+#ifndef METRICAS_H
+#define METRICAS_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "servos.h"
+#include "leds.h"
+#include "registro.h"
+#include "agendador.h"
+#include "fluxo.h"
+
+// Porta TCP padrão do exportador (faixa usada por exportadores Prometheus)
+#define METRICAS_PORTA_PADRAO 9464
+
+// Intervalo com que a thread do exportador confere se deve encerrar (ms)
+#define METRICAS_INTERVALO_MS 200
+
+// Prazo para o cliente mandar o pedido HTTP (ms)
+#define METRICAS_PRAZO_PEDIDO_MS 1000
+
+// Limites superiores (ns) das faixas do histograma de latência de escrita;
+// a última faixa (+Inf) é implícita
+#define METRICAS_FAIXAS 10
+#define METRICAS_LIMITES_NS { 10000, 25000, 50000, 100000, 250000, 500000, \
+                              1000000, 2500000, 5000000, 10000000 }
+
+// Estado publicado de um canal
+typedef struct {
+    int32_t duty;                   // Último duty escrito (ns)
+    int32_t angulo_mgraus;
+    uint8_t em_movimento;
+    uint8_t em_repouso;
+    uint8_t habilitado;             // Enable do PWM
+    uint8_t reservado;
+    uint32_t falhas;                // FALHA_*
+    uint64_t repousos;
+    uint64_t alternancias;          // Escritas efetivas em enable
+    uint32_t pontos_fluxo;          // Pontos no buffer de jitter
+    uint32_t subfluxos;
+} MetricasCanal;
+
+// Cópia dos contadores do laço
+typedef struct {
+    uint64_t ticks;
+    uint64_t overruns;
+    int64_t atraso_max_ns;          // Maior atraso de despertar do ciclo
+    uint64_t latencia[METRICAS_FAIXAS + 1];     // Amostras por faixa (não acumuladas)
+    uint64_t latencia_soma_ns;
+    uint64_t transicoes_leds;
+    uint64_t padroes_leds;
+    uint32_t leds;                  // Máscara das linhas não apagadas
+    uint32_t fila_registro;         // Registros aguardando o console
+    uint64_t registros_descartados;
+    uint64_t comandos;
+    uint64_t rejeitados;
+    uint64_t substituidos;
+    uint32_t num_canais;
+    MetricasCanal canais[SERVOS_MAX];
+} DadosMetricas;
+
+// Instantâneo protegido por seqlock (segmento.h): a thread de controle é
+// a única escritora e o exportador repete a cópia se ela coincidir com
+// uma publicação
+typedef struct {
+    _Alignas(64) atomic_uint seq;
+    DadosMetricas dados;
+} InstantaneoMetricas;
+
+// Exportador de métricas no formato de texto do Prometheus (aceito também
+// por coletores OpenMetrics).
+// A thread de controle chama publicarMetricas() uma vez por tick: copia
+// os contadores que já mantém para o instantâneo, sem trava nem chamada
+// de sistema além da leitura do relógio do backend. Uma thread de baixa
+// prioridade atende os pedidos HTTP lendo só o instantâneo, então uma
+// coleta nunca toca o estado do laço nem o atrasa.
+typedef struct Metricas {
+    InstantaneoMetricas instantaneo;
+
+    // Fontes lidas na publicação (só pela thread de controle)
+    const GrupoServos *servos;
+    const LedsIndicadores *leds;
+    FilaRegistro *log;
+    const FluxoSetpoints *fluxo;    // NULL = fora do modo servidor
+    const unsigned long *comandos;  // NULL = o modo não recebe comandos
+    const unsigned long *rejeitados;
+    const unsigned long *substituidos;
+    DadosMetricas local;            // Montado aqui e copiado sob o seqlock
+    uint64_t ticks_base;            // Somado ao agendador, que o servidor
+    uint64_t overruns_base;         // reinicia a cada movimento
+    uint64_t ticks_vistos;
+    uint64_t overruns_vistos;
+    unsigned int divisor;           // Publica 1 a cada divisor ticks (0 ou 1 = todos)
+    unsigned int contagem;
+
+    int fd;                         // Socket TCP de escuta
+    int porta;
+    atomic_int ativo;               // 1 = thread do exportador rodando
+    pthread_t thread;
+    unsigned long coletas;
+} Metricas;
+
+// Prepara a publicação a partir do grupo, dos LEDs e da fila de registro
+void iniciarMetricas(Metricas *m, const GrupoServos *servos,
+                     const LedsIndicadores *leds, FilaRegistro *log);
+
+// Abre a porta TCP e cria a thread do exportador; retorna 0 ou -1
+int iniciarExportadorMetricas(Metricas *m, int porta);
+
+// Publica o instantâneo. amostra = 1 quando o tick escreveu nos canais: o
+// atrasoTick() de agora entra no histograma de latência de escrita
+void publicarMetricasTick(Metricas *m, const Agendador *ag, int amostra);
+
+// Atalho para os laços, em que as métricas são opcionais; com divisor,
+// os ticks entre duas publicações ficam fora do histograma
+static inline void publicarMetricas(Metricas *m, const Agendador *ag, int amostra) {
+    if (m && (m->divisor <= 1 || ++m->contagem % m->divisor == 0)) {
+        publicarMetricasTick(m, ag, amostra);
+    }
+}
+
+// Monta o texto das métricas a partir de um instantâneo; retorna o tamanho
+// (truncado em tamanho - 1)
+size_t formatarMetricas(const DadosMetricas *inst, char *texto, size_t tamanho);
+
+// Encerra a thread do exportador e fecha a porta
+void fecharMetricas(Metricas *m);
+
+#endif
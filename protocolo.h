@@ -0,0 +1,173 @@
+#ifndef PROTOCOLO_H
+#define PROTOCOLO_H
+
+#include <stdint.h>
+
+// Protocolo binário do servidor de comandos (UDP e socket Unix de
+// datagramas). Cada datagrama é uma mensagem de tamanho fixo, com campos
+// em little-endian (ordem nativa da Labrador e de um PC x86).
+
+#define PROTOCOLO_MAGICO 0x31565253u    // "SRV1"
+
+// Porta UDP e caminho do socket Unix padrão
+#define PROTOCOLO_PORTA 5005
+#define PROTOCOLO_SOCKET "/run/controle_servo.sock"
+
+// Tipos de mensagem
+enum {
+    MSG_POSICAO = 1,        // Cliente -> servidor: mover um servo
+    MSG_ACK = 2,            // Servidor -> cliente: resultado do comando
+    MSG_LOTE = 3,           // Cliente -> servidor: lote de pontos do fluxo
+    MSG_ACK_LOTE = 4,       // Servidor -> cliente: resultado do lote
+    MSG_COORDENADO = 5      // Cliente -> servidor: mover vários servos juntos
+};
+
+// Perfil da mensagem de posição: TipoPerfil ou o perfil padrão do servidor
+#define PERFIL_PADRAO_SERVIDOR 0xFF
+
+// Status do ACK
+enum {
+    ACK_OK = 0,
+    ACK_CANAL_INVALIDO,
+    ACK_ANGULO_INVALIDO,
+    ACK_PERFIL_INVALIDO,
+    ACK_ERRO_PLANEJAMENTO,
+    ACK_BUFFER_CHEIO,       // Parte do lote não coube no buffer
+    ACK_FORA_DE_ORDEM,      // Parte do lote era anterior ao último ponto
+    ACK_LOTE_INVALIDO,      // Tamanho do lote não confere com num_pontos
+    ACK_EMERGENCIA,         // Emergência acionada: PWM desligado
+    ACK_FIM_DE_CURSO,       // Movimento em direção a um fim de curso acionado
+    ACK_SUBSTITUIDO,        // Substituído por um comando mais novo antes do tick
+    ACK_COORDENADO_INVALIDO // Tamanho não confere com num_eixos ou canal repetido
+};
+
+// Flags do lote
+#define LOTE_INICIO 0x01    // Novo fluxo: ressincroniza o relógio remoto
+
+// Pontos por lote (um lote cheio ainda cabe em um datagrama de 1500 bytes)
+#define LOTE_PONTOS_MAX 64
+
+// Eixos por comando coordenado (um por servo do grupo)
+#define COORDENADO_EIXOS_MAX 8
+
+// Canal do ACK de um comando coordenado aceito
+#define ACK_CANAL_GRUPO 0xFF
+
+// Comando de posição: move o servo canal até o alvo, partindo da posição
+// atual, com o perfil pedido
+typedef struct __attribute__((packed)) {
+    uint32_t magico;
+    uint8_t tipo;               // MSG_POSICAO
+    uint8_t canal;              // Índice do servo (ordem das opções --servo)
+    uint8_t perfil;             // TipoPerfil ou PERFIL_PADRAO_SERVIDOR
+    uint8_t reservado;
+    uint32_t sequencia;         // Escolhida pelo cliente, ecoada no ACK
+    int32_t angulo_mgraus;      // Alvo em milésimos de grau (0..180000)
+    uint64_t timestamp_ns;      // Relógio do cliente, ecoado no ACK
+} MensagemPosicao;
+
+// Resposta a cada comando de posição
+typedef struct __attribute__((packed)) {
+    uint32_t magico;
+    uint8_t tipo;               // MSG_ACK
+    uint8_t canal;
+    uint8_t status;             // ACK_*
+    uint8_t reservado;
+    uint32_t sequencia;
+    uint32_t latencia_ns;       // Chegada do pacote -> escrita do 1º duty
+    uint32_t duracao_ms;        // Duração planejada do movimento
+    uint64_t timestamp_ns;      // Copiado do comando
+} MensagemAck;
+
+// Um ponto do fluxo: o canal deve estar em instante no ângulo dado.
+// instante_ns é do relógio do cliente; o servidor o converte para o seu
+// relógio monotônico no primeiro lote do fluxo
+typedef struct __attribute__((packed)) {
+    uint64_t instante_ns;
+    int32_t angulo_mgraus;
+    uint8_t canal;
+    uint8_t reservado[3];
+} PontoLote;
+
+// Lote de pontos, em ordem de instante dentro de cada canal
+typedef struct __attribute__((packed)) {
+    uint32_t magico;
+    uint8_t tipo;               // MSG_LOTE
+    uint8_t num_pontos;         // 1..LOTE_PONTOS_MAX
+    uint8_t flags;              // LOTE_*
+    uint8_t reservado;
+    uint32_t sequencia;
+    uint64_t timestamp_ns;      // Relógio do cliente, ecoado no ACK
+    PontoLote pontos[LOTE_PONTOS_MAX];
+} MensagemLote;
+
+// Tamanho no fio de um lote com n pontos
+#define TAMANHO_LOTE(n) (sizeof(MensagemLote) - \
+                         (LOTE_PONTOS_MAX - (n)) * sizeof(PontoLote))
+
+// Um eixo do comando coordenado
+typedef struct __attribute__((packed)) {
+    int32_t angulo_mgraus;      // Alvo em milésimos de grau (0..180000)
+    uint8_t canal;
+    uint8_t reservado[3];
+} EixoCoordenado;
+
+// Comando coordenado: os eixos partem da posição atual no mesmo tick e
+// chegam juntos aos alvos; o ACK (MSG_ACK, canal ACK_CANAL_GRUPO ou o do
+// eixo recusado) traz a duração planejada
+typedef struct __attribute__((packed)) {
+    uint32_t magico;
+    uint8_t tipo;               // MSG_COORDENADO
+    uint8_t num_eixos;          // 1..COORDENADO_EIXOS_MAX, canais distintos
+    uint8_t perfil;             // TipoPerfil ou PERFIL_PADRAO_SERVIDOR
+    uint8_t reservado;
+    uint32_t sequencia;
+    uint32_t duracao_ms;        // Duração mínima (0 = a do eixo de maior curso)
+    uint64_t timestamp_ns;      // Relógio do cliente, ecoado no ACK
+    EixoCoordenado eixos[COORDENADO_EIXOS_MAX];
+} MensagemCoordenada;
+
+// Tamanho no fio de um comando coordenado com n eixos
+#define TAMANHO_COORDENADO(n) (sizeof(MensagemCoordenada) - \
+                               (COORDENADO_EIXOS_MAX - (n)) * sizeof(EixoCoordenado))
+
+// Resposta a cada lote
+typedef struct __attribute__((packed)) {
+    uint32_t magico;
+    uint8_t tipo;               // MSG_ACK_LOTE
+    uint8_t aceitos;            // Pontos guardados no buffer
+    uint8_t status;             // ACK_*
+    uint8_t reservado;
+    uint32_t sequencia;
+    int32_t folga_ms;           // Menor antecedência do buffer entre os canais do lote
+    uint32_t subfluxos;         // Buffer vazio no tick (total desde o início)
+    uint64_t timestamp_ns;      // Copiado do lote
+} MensagemAckLote;
+
+_Static_assert(sizeof(MensagemPosicao) == 24, "MensagemPosicao deve ter 24 bytes");
+_Static_assert(sizeof(MensagemAck) == 28, "MensagemAck deve ter 28 bytes");
+_Static_assert(sizeof(PontoLote) == 16, "PontoLote deve ter 16 bytes");
+_Static_assert(sizeof(MensagemAckLote) == 28, "MensagemAckLote deve ter 28 bytes");
+_Static_assert(sizeof(EixoCoordenado) == 8, "EixoCoordenado deve ter 8 bytes");
+_Static_assert(TAMANHO_COORDENADO(0) == 24, "Cabeçalho do comando coordenado deve ter 24 bytes");
+
+// Texto de um status de ACK para mensagens
+static inline const char *descreverStatusAck(int status) {
+    switch (status) {
+    case ACK_OK:                return "ok";
+    case ACK_CANAL_INVALIDO:    return "canal inválido";
+    case ACK_ANGULO_INVALIDO:   return "ângulo fora de 0..180°";
+    case ACK_PERFIL_INVALIDO:   return "perfil inválido";
+    case ACK_ERRO_PLANEJAMENTO: return "erro ao planejar a trajetória";
+    case ACK_BUFFER_CHEIO:      return "buffer do fluxo cheio";
+    case ACK_FORA_DE_ORDEM:     return "ponto fora de ordem";
+    case ACK_LOTE_INVALIDO:     return "lote malformado";
+    case ACK_EMERGENCIA:        return "emergência acionada";
+    case ACK_FIM_DE_CURSO:      return "fim de curso acionado";
+    case ACK_SUBSTITUIDO:       return "substituído por um comando mais novo";
+    case ACK_COORDENADO_INVALIDO: return "comando coordenado malformado";
+    }
+    return "desconhecido";
+}
+
+#endif
@@ -0,0 +1,284 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+
+#include "pwm.h"
+
+// Função que escreve em arquivos do sysfs
+int writeToFile(const char *path, const char *value) {
+    size_t len = strlen(value);
+    int fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    if (write(fd, value, len) != (ssize_t)len) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+    close(fd);
+    return 0;
+}
+
+// Função para converter um inteiro em texto decimal sem usar stdio
+int formatarInteiro(char *buf, int valor) {
+    char tmp[PWM_TAM_VALOR];
+    int n = 0;
+    int len = 0;
+
+    if (valor < 0) {
+        valor = 0;
+    }
+    do {
+        tmp[n++] = (char)('0' + valor % 10);
+        valor /= 10;
+    } while (valor > 0);
+
+    while (n > 0) {
+        buf[len++] = tmp[--n];
+    }
+    buf[len] = '\0';
+    return len;
+}
+
+// Escreve um valor inteiro em um descritor já aberto do sysfs
+static int escreverValor(int fd, int valor) {
+    char buf[PWM_TAM_VALOR];
+    int len = formatarInteiro(buf, valor);
+
+    if (pwrite(fd, buf, len, 0) != len) {
+        return -1;
+    }
+    return 0;
+}
+
+// Abre um atributo do canal (period, duty_cycle, enable) para escrita
+static int abrirAtributo(const CanalPWM *pwm, const char *atributo) {
+    char caminho[PWM_TAM_CAMINHO + 32];
+    snprintf(caminho, sizeof(caminho), "%s/pwm%d/%s",
+             pwm->chip, pwm->canal, atributo);
+    return open(caminho, O_WRONLY | O_CLOEXEC);
+}
+
+// Fecha os descritores abertos do canal
+static void fecharDescritores(CanalPWM *pwm) {
+    if (pwm->fd_periodo >= 0) close(pwm->fd_periodo);
+    if (pwm->fd_duty >= 0) close(pwm->fd_duty);
+    if (pwm->fd_enable >= 0) close(pwm->fd_enable);
+    pwm->fd_periodo = pwm->fd_duty = pwm->fd_enable = -1;
+}
+
+// Tenta abrir os três atributos; em caso de falha fecha o que abriu e
+// preserva o errno da tentativa que falhou
+static int abrirAtributos(CanalPWM *pwm) {
+    static const char *const nomes[3] = { "period", "duty_cycle", "enable" };
+    int *fds[3] = { &pwm->fd_periodo, &pwm->fd_duty, &pwm->fd_enable };
+
+    for (int i = 0; i < 3; i++) {
+        *fds[i] = abrirAtributo(pwm, nomes[i]);
+        if (*fds[i] < 0) {
+            int erro = errno;
+            fecharDescritores(pwm);
+            errno = erro;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static long long msDesde(const struct timespec *inicio) {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return (agora.tv_sec - inicio->tv_sec) * 1000LL +
+           (agora.tv_nsec - inicio->tv_nsec) / 1000000;
+}
+
+// Espera os atributos do canal aparecerem e ficarem graváveis.
+// O kernel cria o diretório pwmN durante o write do export, mas os
+// arquivos podem surgir um pouco depois e o udev ainda pode estar
+// ajustando as permissões (ENOENT/EACCES). O inotify no diretório do chip
+// acorda a espera assim que algo é criado; como o sysfs nem sempre gera
+// esses eventos, a espera também nunca passa de PWM_INTERVALO_PRONTO_US
+// entre tentativas.
+static int aguardarAtributos(CanalPWM *pwm, int fd_inotify,
+                             const struct timespec *inicio) {
+    struct pollfd pfd = { fd_inotify, POLLIN, 0 };
+    int timeout_ms = (PWM_INTERVALO_PRONTO_US + 999) / 1000;
+
+    while (abrirAtributos(pwm) < 0) {
+        if ((errno != ENOENT && errno != EACCES) ||
+            msDesde(inicio) >= PWM_TIMEOUT_EXPORT_MS) {
+            fprintf(stderr, "%s/pwm%d: atributos indisponíveis: %s\n",
+                    pwm->chip, pwm->canal, strerror(errno));
+            return -1;
+        }
+        if (fd_inotify >= 0) {
+            if (poll(&pfd, 1, timeout_ms) > 0) {
+                char eventos[1024];
+                while (read(fd_inotify, eventos, sizeof(eventos)) > 0) {
+                }
+            }
+        } else {
+            usleep(PWM_INTERVALO_PRONTO_US);
+        }
+    }
+    return 0;
+}
+
+// Remove a exportação feita por nós; retorna 0 ou -1
+static int desexportar(CanalPWM *pwm) {
+    char caminho[PWM_TAM_CAMINHO + 16];
+    char valor[PWM_TAM_VALOR];
+
+    // Um canal reaproveitado continua exportado para a próxima execução
+    if (!pwm->exportado) {
+        return 0;
+    }
+    pwm->exportado = 0;
+    snprintf(caminho, sizeof(caminho), "%s/unexport", pwm->chip);
+    formatarInteiro(valor, pwm->canal);
+    return writeToFile(caminho, valor);
+}
+
+// Função para inicializar o PWM
+int inicializarPWM(CanalPWM *pwm, const char *chip, int canal,
+                   int periodo, int duty_inicial) {
+    char caminho[PWM_TAM_CAMINHO + 16];
+    char valor[PWM_TAM_VALOR];
+    struct stat st;
+    struct timespec inicio;
+    int fd_inotify = -1;
+
+    printf("Inicializando PWM...\n");
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+
+    snprintf(pwm->chip, sizeof(pwm->chip), "%s", chip);
+    pwm->canal = canal;
+    pwm->fd_periodo = pwm->fd_duty = pwm->fd_enable = -1;
+    pwm->exportado = 0;
+    pwm->habilitado = 0;
+    pwm->alternancias = 0;
+
+    // Canal já exportado (por exemplo, por uma execução anterior que não
+    // terminou limpa): reaproveita sem o ciclo unexport/export
+    snprintf(caminho, sizeof(caminho), "%s/pwm%d", chip, canal);
+    if (stat(caminho, &st) == 0 && S_ISDIR(st.st_mode)) {
+        printf("Canal %s já exportado, reaproveitando\n", caminho);
+    } else {
+        // O watch é registrado antes do export para não perder a criação
+        fd_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd_inotify >= 0 &&
+            inotify_add_watch(fd_inotify, chip, IN_CREATE | IN_ATTRIB) < 0) {
+            close(fd_inotify);
+            fd_inotify = -1;
+        }
+
+        // Exportar o canal
+        snprintf(caminho, sizeof(caminho), "%s/export", chip);
+        formatarInteiro(valor, canal);
+        if (writeToFile(caminho, valor) < 0) {
+            if (fd_inotify >= 0) {
+                close(fd_inotify);
+            }
+            return -1;
+        }
+        pwm->exportado = 1;
+    }
+
+    // Abrir os atributos uma única vez, assim que estiverem prontos
+    int pronto = aguardarAtributos(pwm, fd_inotify, &inicio);
+    if (fd_inotify >= 0) {
+        close(fd_inotify);
+    }
+    if (pronto < 0) {
+        fecharDescritores(pwm);
+        desexportar(pwm);
+        return -1;
+    }
+    printf("Canal pronto em %lld ms\n", msDesde(&inicio));
+
+    // Configurar o período e o duty cycle inicial
+    pwm->ops = &OPERACOES_PWM_SYSFS;
+    pwm->privado = NULL;
+    if (escreverValor(pwm->fd_periodo, periodo) < 0 ||
+        setPWMDutyCycle(pwm, duty_inicial) < 0 ||
+        habilitarPWM(pwm, 1) < 0) {
+        perror("Erro ao configurar PWM");
+        fecharDescritores(pwm);
+        desexportar(pwm);
+        return -1;
+    }
+
+    printf("PWM inicializado com sucesso!\n");
+    return 0;
+}
+
+// Função para definir o duty cycle do PWM
+int setPWMDutyCycle(CanalPWM *pwm, int duty_cycle) {
+    char buf[PWM_TAM_VALOR];
+    int len = formatarInteiro(buf, duty_cycle);
+    return setPWMDutyCycleTexto(pwm, duty_cycle, buf, len);
+}
+
+// Função para trocar o período do PWM
+int definirPeriodoPWM(CanalPWM *pwm, int periodo, int duty) {
+    if (setPWMDutyCycle(pwm, 0) < 0 || escreverValor(pwm->fd_periodo, periodo) < 0) {
+        return -1;
+    }
+    return setPWMDutyCycle(pwm, duty);
+}
+
+// Escreve o texto do duty no descritor do sysfs
+static int escreverDutySysfs(CanalPWM *pwm, int duty, const char *texto, int len) {
+    (void)duty;
+    if (pwrite(pwm->fd_duty, texto, len, 0) != len) {
+        return -1;
+    }
+    return 0;
+}
+
+// Liga ou desliga a saída pelo descritor do sysfs
+static int habilitarSysfs(CanalPWM *pwm, int habilitado) {
+    static const char valores[2] = { '0', '1' };
+    if (pwrite(pwm->fd_enable, &valores[habilitado != 0], 1, 0) != 1) {
+        return -1;
+    }
+    // Ao habilitar, o contador do PWM recomeça: guarda o instante como
+    // referência de fase dos quadros
+    if (habilitado) {
+        clock_gettime(CLOCK_MONOTONIC, &pwm->habilitado_em);
+    }
+    return 0;
+}
+
+// Desliga a saída, fecha os descritores e remove a exportação do canal
+static void fecharSysfs(CanalPWM *pwm) {
+    if (pwm->fd_enable >= 0) {
+        habilitarSysfs(pwm, 0);
+    }
+    fecharDescritores(pwm);
+
+    // Uma falha aqui só é avisada: os demais canais ainda precisam fechar
+    if (desexportar(pwm) < 0) {
+        fprintf(stderr, "Canal %s/pwm%d continua exportado\n", pwm->chip, pwm->canal);
+    }
+}
+
+const OperacoesPWM OPERACOES_PWM_SYSFS = {
+    escreverDutySysfs,
+    habilitarSysfs,
+    fecharSysfs,
+};
+
+// Função para desativar PWM
+void desativarPWM(CanalPWM *pwm) {
+    printf("Desativando PWM...\n");
+    pwm->ops->fechar(pwm);
+}
@@ -0,0 +1,94 @@
+#ifndef PWM_H
+#define PWM_H
+
+#include <time.h>
+
+// Tamanho máximo dos caminhos do sysfs usados pelo canal
+#define PWM_TAM_CAMINHO 96
+
+// Tamanho do buffer de texto de um valor inteiro escrito no sysfs
+#define PWM_TAM_VALOR 16
+
+// Tempo máximo de espera pelos atributos do canal após o export (ms)
+#define PWM_TIMEOUT_EXPORT_MS 2000
+
+// Intervalo máximo entre tentativas enquanto os atributos não aparecem (us)
+#define PWM_INTERVALO_PRONTO_US 1000
+
+typedef struct CanalPWM CanalPWM;
+
+// Operações de um backend de PWM (sysfs, simulado, ...)
+typedef struct {
+    int (*escreverDuty)(CanalPWM *pwm, int duty, const char *texto, int len);
+    int (*habilitar)(CanalPWM *pwm, int habilitado);
+    void (*fechar)(CanalPWM *pwm);
+} OperacoesPWM;
+
+// Handle de um canal PWM.
+// No backend sysfs os arquivos period, duty_cycle e enable são abertos uma
+// única vez em inicializarPWM() e mantidos como descritores crus; cada
+// atualização é um único pwrite() a partir de um buffer na pilha, sem
+// stdio e sem heap. Outros backends usam ops e privado.
+struct CanalPWM {
+    const OperacoesPWM *ops;
+    void *privado;                  // Estado do backend (se houver)
+    char chip[PWM_TAM_CAMINHO];     // Ex.: /sys/class/pwm/pwmchip0
+    int canal;                      // Índice do canal dentro do chip
+    int fd_periodo;
+    int fd_duty;
+    int fd_enable;
+    int exportado;                  // 1 = exportado por nós (unexport ao fechar)
+    int habilitado;                 // Estado de enable em cache
+    unsigned long alternancias;     // Escritas efetivas em enable
+    struct timespec habilitado_em;  // Relógio do backend na última habilitação
+};
+
+// Operações do backend sysfs
+extern const OperacoesPWM OPERACOES_PWM_SYSFS;
+
+// Escreve um valor em um arquivo do sysfs (abre, escreve e fecha);
+// retorna 0 ou -1, com o erro já impresso
+int writeToFile(const char *path, const char *value);
+
+// Converte um inteiro não negativo em texto decimal; retorna o tamanho
+int formatarInteiro(char *buf, int valor);
+
+// Exporta o canal no sysfs (ou reaproveita um já exportado), espera os
+// atributos ficarem acessíveis, abre os descritores e configura período e
+// duty inicial
+int inicializarPWM(CanalPWM *pwm, const char *chip, int canal,
+                   int periodo, int duty_inicial);
+
+// Atualiza o duty cycle do canal (em nanosegundos)
+int setPWMDutyCycle(CanalPWM *pwm, int duty_cycle);
+
+// Atualiza o duty cycle a partir de um texto já formatado (sem conversão)
+static inline int setPWMDutyCycleTexto(CanalPWM *pwm, int duty,
+                                       const char *texto, int len) {
+    return pwm->ops->escreverDuty(pwm, duty, texto, len);
+}
+
+// Troca o período e o duty do canal (backend sysfs). O duty passa por
+// zero antes, para nunca ficar maior que o período em nenhum momento
+int definirPeriodoPWM(CanalPWM *pwm, int periodo, int duty);
+
+// Liga (1) ou desliga (0) a saída do canal. O estado fica em cache no
+// handle: só escreve se mudar. Retorna 1 se escreveu, 0 se nada mudou, -1
+// em erro
+static inline int habilitarPWM(CanalPWM *pwm, int habilitado) {
+    habilitado = habilitado != 0;
+    if (habilitado == pwm->habilitado) {
+        return 0;
+    }
+    if (pwm->ops->habilitar(pwm, habilitado) < 0) {
+        return -1;
+    }
+    pwm->habilitado = habilitado;
+    pwm->alternancias++;
+    return 1;
+}
+
+// Desliga a saída e libera o canal
+void desativarPWM(CanalPWM *pwm);
+
+#endif
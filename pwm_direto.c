@@ -0,0 +1,232 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+#include "pwm_direto.h"
+
+// Layout do registro de controle de um modelo de controlador
+typedef struct {
+    const char *compativel;         // compatible do nó no device tree
+    uint32_t passo;                 // Distância entre os registros de dois canais
+    unsigned int bit_periodo;       // Campo do período (ticks - 1)
+    unsigned int bit_duty;          // Campo do duty (ticks em nível ativo)
+    unsigned int largura;           // Bits de cada campo
+} LayoutPWMDireto;
+
+// Controladores owl do Labrador (S500 e S700): um PWM_CTL por canal, com
+// período e duty em campos de 10 bits. A calibração confere o layout
+// contra o que o kernel programou antes de qualquer escrita
+static const LayoutPWMDireto LAYOUTS[] = {
+    { "actions,s700-pwm", 4, 0, 10, 10 },
+    { "actions,s500-pwm", 4, 0, 10, 10 },
+};
+
+// Estado de um canal com acesso direto
+typedef struct {
+    int em_uso;
+    void *mapa;                     // Página mapeada de /dev/mem
+    size_t tamanho_mapa;
+    volatile uint32_t *registro;    // Registro de controle do canal
+    uint32_t fixo;                  // Bits do registro fora do campo de duty
+    uint32_t mascara_duty;
+    unsigned int bit_duty;
+    uint32_t ticks_periodo;
+    uint64_t escala;                // Ticks por ns em ponto fixo 32.32
+    int duty;                       // Último duty (ns), devolvido ao kernel
+} CanalDireto;
+
+static CanalDireto canais[PWM_DIRETO_CANAIS_MAX];
+
+// Lê um arquivo inteiro (atributos do device tree); retorna os bytes lidos
+static ssize_t lerArquivo(const char *caminho, void *buf, size_t tamanho) {
+    int fd = open(caminho, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t n = read(fd, buf, tamanho);
+    close(fd);
+    return n;
+}
+
+static uint32_t celula(const unsigned char *p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+// Procura o layout pelo compatible do nó (lista de textos separados por NUL)
+static const LayoutPWMDireto *procurarLayout(const char *chip) {
+    char caminho[PWM_TAM_CAMINHO + 32];
+    char compativel[256];
+
+    snprintf(caminho, sizeof(caminho), "%s/device/of_node/compatible", chip);
+    ssize_t n = lerArquivo(caminho, compativel, sizeof(compativel) - 1);
+    if (n <= 0) {
+        return NULL;
+    }
+    compativel[n] = '\0';
+    for (ssize_t i = 0; i < n; i += (ssize_t)strlen(compativel + i) + 1) {
+        for (size_t k = 0; k < sizeof(LAYOUTS) / sizeof(LAYOUTS[0]); k++) {
+            if (strcmp(compativel + i, LAYOUTS[k].compativel) == 0) {
+                return &LAYOUTS[k];
+            }
+        }
+    }
+    return NULL;
+}
+
+// Endereço físico do controlador: primeira entrada de reg, com o número de
+// células de endereço do nó pai (2 se não declarado)
+static int lerEnderecoFisico(const char *chip, uint64_t *fisico) {
+    char caminho[PWM_TAM_CAMINHO + 48];
+    unsigned char buf[16];
+    unsigned int celulas = 2;
+
+    snprintf(caminho, sizeof(caminho), "%s/device/of_node/../#address-cells", chip);
+    if (lerArquivo(caminho, buf, 4) == 4) {
+        celulas = celula(buf);
+    }
+    snprintf(caminho, sizeof(caminho), "%s/device/of_node/reg", chip);
+    if (celulas < 1 || celulas > 2 || lerArquivo(caminho, buf, sizeof(buf)) < (ssize_t)(celulas * 4)) {
+        return -1;
+    }
+    *fisico = celulas == 2 ? (uint64_t)celula(buf) << 32 | celula(buf + 4) : celula(buf);
+    return 0;
+}
+
+// Mapeia o registro do canal e calibra ns -> ticks a partir do que o
+// kernel programou; retorna 0 ou -1 com o motivo em *motivo
+static int mapearCanal(CanalDireto *c, const char *chip, int canal,
+                       int periodo, int duty_inicial, const char **motivo) {
+    const LayoutPWMDireto *layout = procurarLayout(chip);
+    uint64_t fisico;
+
+    if (!layout) {
+        *motivo = "controlador sem layout conhecido";
+        return -1;
+    }
+    if (lerEnderecoFisico(chip, &fisico) < 0) {
+        *motivo = "endereço do controlador ausente do device tree";
+        return -1;
+    }
+    fisico += (uint64_t)canal * layout->passo;
+
+    int fd = open("/dev/mem", O_RDWR | O_SYNC | O_CLOEXEC);
+    if (fd < 0) {
+        *motivo = strerror(errno);
+        return -1;
+    }
+    long pagina = sysconf(_SC_PAGESIZE);
+    uint64_t inicio = fisico & ~(uint64_t)(pagina - 1);
+    c->tamanho_mapa = (size_t)pagina;
+    c->mapa = mmap(NULL, c->tamanho_mapa, PROT_READ | PROT_WRITE, MAP_SHARED, fd, (off_t)inicio);
+    close(fd);
+    if (c->mapa == MAP_FAILED) {
+        // Com CONFIG_IO_STRICT_DEVMEM o kernel recusa regiões de um driver
+        *motivo = strerror(errno);
+        c->mapa = NULL;
+        return -1;
+    }
+    c->registro = (volatile uint32_t *)((char *)c->mapa + (fisico - inicio));
+
+    uint32_t mascara = (1u << layout->largura) - 1;
+    uint32_t valor = *c->registro;
+    c->ticks_periodo = ((valor >> layout->bit_periodo) & mascara) + 1;
+    c->bit_duty = layout->bit_duty;
+    c->mascara_duty = mascara << layout->bit_duty;
+    c->fixo = valor & ~c->mascara_duty;
+    c->escala = ((uint64_t)c->ticks_periodo << 32) / (uint64_t)periodo;
+
+    long long esperado = ((long long)duty_inicial * c->ticks_periodo + periodo / 2) / periodo;
+    long long lido = (valor & c->mascara_duty) >> layout->bit_duty;
+    if (c->ticks_periodo < 2 || lido - esperado > PWM_DIRETO_TOLERANCIA_TICKS ||
+        esperado - lido > PWM_DIRETO_TOLERANCIA_TICKS) {
+        *motivo = "registro não confere com o período e o duty programados";
+        munmap(c->mapa, c->tamanho_mapa);
+        c->mapa = NULL;
+        return -1;
+    }
+
+    printf("PWM direto: %s/pwm%d @ 0x%llx | %u ticks por período (%.0f ns/tick)\n",
+           chip, canal, (unsigned long long)fisico, c->ticks_periodo,
+           (double)periodo / c->ticks_periodo);
+    return 0;
+}
+
+// Escreve o duty no campo do registro (ou pelo sysfs com a saída desligada)
+static int escreverDutyDireto(CanalPWM *pwm, int duty, const char *texto, int len) {
+    CanalDireto *c = pwm->privado;
+
+    c->duty = duty;
+    if (!pwm->habilitado) {
+        return OPERACOES_PWM_SYSFS.escreverDuty(pwm, duty, texto, len);
+    }
+    uint32_t ticks = (uint32_t)(((uint64_t)duty * c->escala + (1u << 31)) >> 32);
+    if (ticks > c->ticks_periodo) {
+        ticks = c->ticks_periodo;
+    }
+    *c->registro = c->fixo | ((ticks << c->bit_duty) & c->mascara_duty);
+    return 0;
+}
+
+// Atualiza o duty guardado pelo kernel, que ele reaplica ao ligar a saída
+static int devolverDuty(CanalPWM *pwm, const CanalDireto *c) {
+    char buf[PWM_TAM_VALOR];
+    int len = formatarInteiro(buf, c->duty);
+    return OPERACOES_PWM_SYSFS.escreverDuty(pwm, c->duty, buf, len);
+}
+
+// Liga ou desliga a saída pelo sysfs, com o kernel em dia com o duty
+static int habilitarDireto(CanalPWM *pwm, int habilitado) {
+    if (devolverDuty(pwm, pwm->privado) < 0) {
+        return -1;
+    }
+    return OPERACOES_PWM_SYSFS.habilitar(pwm, habilitado);
+}
+
+// Devolve o duty ao kernel, desfaz o mapeamento e fecha pelo sysfs
+static void fecharDireto(CanalPWM *pwm) {
+    CanalDireto *c = pwm->privado;
+
+    devolverDuty(pwm, c);
+    munmap(c->mapa, c->tamanho_mapa);
+    c->mapa = NULL;
+    c->em_uso = 0;
+    pwm->privado = NULL;
+    OPERACOES_PWM_SYSFS.fechar(pwm);
+}
+
+static const OperacoesPWM OPERACOES_PWM_DIRETO = {
+    escreverDutyDireto,
+    habilitarDireto,
+    fecharDireto,
+};
+
+// Função para inicializar o PWM com acesso direto aos registros
+int inicializarPWMDireto(CanalPWM *pwm, const char *chip, int canal,
+                         int periodo, int duty_inicial) {
+    if (inicializarPWM(pwm, chip, canal, periodo, duty_inicial) < 0) {
+        return -1;
+    }
+
+    CanalDireto *c = NULL;
+    for (int i = 0; i < PWM_DIRETO_CANAIS_MAX; i++) {
+        if (!canais[i].em_uso) {
+            c = &canais[i];
+            break;
+        }
+    }
+    const char *motivo = "canais diretos esgotados";
+    if (!c || mapearCanal(c, chip, canal, periodo, duty_inicial, &motivo) < 0) {
+        fprintf(stderr, "PWM direto indisponível em %s/pwm%d (%s); seguindo pelo sysfs\n",
+                chip, canal, motivo);
+        return 0;
+    }
+    c->em_uso = 1;
+    c->duty = duty_inicial;
+    pwm->privado = c;
+    pwm->ops = &OPERACOES_PWM_DIRETO;
+    return 0;
+}
@@ -0,0 +1,28 @@
+#ifndef PWM_DIRETO_H
+#define PWM_DIRETO_H
+
+#include "pwm.h"
+
+// Número máximo de canais com acesso direto aos registros
+#define PWM_DIRETO_CANAIS_MAX 16
+
+// Diferença máxima (ticks) entre o duty que o kernel programou e o
+// previsto pela calibração para o layout ser aceito
+#define PWM_DIRETO_TOLERANCIA_TICKS 1
+
+// PWM por escrita direta nos registros do controlador do SoC.
+// O canal é aberto primeiro pelo sysfs (inicializarPWM): o kernel liga o
+// clock, escolhe o divisor e programa período e duty inicial. Em seguida
+// o nó do controlador no device tree diz o endereço físico e o modelo
+// (compatible), o registro de controle do canal é mapeado de /dev/mem e a
+// calibração lê o período em ticks que o kernel programou; o duty que ele
+// escreveu precisa bater com o previsto, senão o layout não é o esperado.
+// Só então as escritas de duty viram um único store de 32 bits no
+// registro, sem chamada de sistema. Se qualquer passo falhar, o canal
+// segue pelo sysfs. Ligar e desligar a saída continua pelo sysfs, com o
+// kernel atualizado antes do último duty, e com a saída desligada (clock
+// possivelmente cortado) os registros não são tocados.
+int inicializarPWMDireto(CanalPWM *pwm, const char *chip, int canal,
+                         int periodo, int duty_inicial);
+
+#endif
@@ -0,0 +1,458 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <dirent.h>
+#include <math.h>
+
+#include "realimentacao.h"
+
+// Escreve um atributo do dispositivo IIO; retorna 0 ou -1
+static int escreverAtributoIIO(const char *dir, const char *nome, const char *valor) {
+    char caminho[PWM_TAM_CAMINHO + 64];
+    snprintf(caminho, sizeof(caminho), "%s/%s", dir, nome);
+
+    int fd = open(caminho, O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t n = write(fd, valor, strlen(valor));
+    int erro = errno;
+    close(fd);
+    errno = erro;
+    return n == (ssize_t)strlen(valor) ? 0 : -1;
+}
+
+// Lê um atributo do dispositivo IIO (sem o '\n'); retorna 0 ou -1
+static int lerAtributoIIO(const char *dir, const char *nome, char *valor, size_t tam) {
+    char caminho[PWM_TAM_CAMINHO + 64];
+    snprintf(caminho, sizeof(caminho), "%s/%s", dir, nome);
+
+    int fd = open(caminho, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t n = read(fd, valor, tam - 1);
+    close(fd);
+    if (n <= 0) {
+        return -1;
+    }
+    valor[n] = '\0';
+    valor[strcspn(valor, "\n")] = '\0';
+    return 0;
+}
+
+// Interpreta o formato de um canal, como "le:u12/16>>0"
+static int interpretarTipoIIO(CanalIIO *c, const char *tipo) {
+    char endian, sinal;
+    int bits, armazenamento;
+
+    if (sscanf(tipo, "%ce:%c%d/%d", &endian, &sinal, &bits, &armazenamento) != 4 ||
+        bits <= 0 || bits > 32 || armazenamento % 8 != 0 ||
+        armazenamento > 64 || bits > armazenamento) {
+        return -1;
+    }
+    const char *shift = strstr(tipo, ">>");
+    c->shift = shift ? atoi(shift + 2) : 0;
+    c->bits = bits;
+    c->bytes = armazenamento / 8;
+    c->com_sinal = sinal == 's';
+    c->big_endian = endian == 'b';
+    return 0;
+}
+
+// Desliga todos os canais do scan, para que só os pedidos entrem nele
+static void desligarCanaisIIO(const char *dir) {
+    char caminho[PWM_TAM_CAMINHO + 32];
+    snprintf(caminho, sizeof(caminho), "%s/scan_elements", dir);
+
+    DIR *d = opendir(caminho);
+    if (!d) {
+        return;
+    }
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL) {
+        size_t len = strlen(e->d_name);
+        if (len > 3 && strcmp(e->d_name + len - 3, "_en") == 0) {
+            char nome[300];
+            snprintf(nome, sizeof(nome), "scan_elements/%s", e->d_name);
+            escreverAtributoIIO(dir, nome, "0");
+        }
+    }
+    closedir(d);
+}
+
+// Ativa o canal do ADC de cada servo e lê posição e formato no scan
+static int configurarCanaisIIO(SensorIIO *s, const ConfigSensor *sensores, int num) {
+    char nome[64], valor[64];
+
+    desligarCanaisIIO(s->dir);
+    for (int i = 0; i < num; i++) {
+        CanalIIO *c = &s->canais[i];
+        int canal = sensores[i].canal_adc;
+
+        for (int j = 0; j < i; j++) {
+            if (sensores[j].canal_adc == canal) {
+                fprintf(stderr, "Canal do ADC %d usado por dois servos\n", canal);
+                return -1;
+            }
+        }
+        snprintf(nome, sizeof(nome), "scan_elements/in_voltage%d_en", canal);
+        if (escreverAtributoIIO(s->dir, nome, "1") < 0) {
+            fprintf(stderr, "%s/%s: %s\n", s->dir, nome, strerror(errno));
+            return -1;
+        }
+        snprintf(nome, sizeof(nome), "scan_elements/in_voltage%d_index", canal);
+        if (lerAtributoIIO(s->dir, nome, valor, sizeof(valor)) < 0) {
+            fprintf(stderr, "%s/%s ilegível\n", s->dir, nome);
+            return -1;
+        }
+        c->indice = atoi(valor);
+        snprintf(nome, sizeof(nome), "scan_elements/in_voltage%d_type", canal);
+        if (lerAtributoIIO(s->dir, nome, valor, sizeof(valor)) < 0 ||
+            interpretarTipoIIO(c, valor) < 0) {
+            fprintf(stderr, "%s/%s: formato não suportado\n", s->dir, nome);
+            return -1;
+        }
+    }
+
+    // No scan os canais ativos vêm em ordem de índice, cada um alinhado ao
+    // próprio tamanho; o scan inteiro é alinhado ao maior deles
+    size_t deslocamento = 0;
+    int maior = 1;
+    for (int k = 0; k < num; k++) {
+        CanalIIO *proximo = NULL;
+        for (int i = 0; i < num; i++) {
+            CanalIIO *c = &s->canais[i];
+            if (c->deslocamento == (size_t)-1 &&
+                (!proximo || c->indice < proximo->indice)) {
+                proximo = c;
+            }
+        }
+        deslocamento = (deslocamento + proximo->bytes - 1) / proximo->bytes * proximo->bytes;
+        proximo->deslocamento = deslocamento;
+        deslocamento += proximo->bytes;
+        if (proximo->bytes > maior) maior = proximo->bytes;
+    }
+    s->tamanho_scan = (deslocamento + maior - 1) / maior * maior;
+    s->num = num;
+    return 0;
+}
+
+// Valor bruto de um canal no scan
+static int32_t decodificarCanal(const CanalIIO *c, const uint8_t *scan) {
+    const uint8_t *p = scan + c->deslocamento;
+    uint64_t v = 0;
+
+    for (int b = 0; b < c->bytes; b++) {
+        v |= (uint64_t)p[c->big_endian ? c->bytes - 1 - b : b] << (8 * b);
+    }
+    v >>= c->shift;
+    v &= (c->bits == 64) ? ~0ULL : ((1ULL << c->bits) - 1);
+    if (c->com_sinal && (v >> (c->bits - 1)) & 1) {
+        return (int32_t)((int64_t)v - (int64_t)(1ULL << c->bits));
+    }
+    return (int32_t)v;
+}
+
+// Lê todos os scans acumulados desde o último tick e devolve a média de
+// cada canal; retorna quantos scans foram lidos (0 = nenhum novo)
+static int lerSensorIIO(SensorIIO *s, double medias[SERVOS_MAX]) {
+    int64_t somas[SERVOS_MAX] = { 0 };
+    int scans = 0;
+
+    while (1) {
+        ssize_t n = read(s->fd, s->buffer, IIO_LEITURA_SCANS * s->tamanho_scan);
+        if (n <= 0) {
+            break;                  // EAGAIN: buffer vazio
+        }
+        int lidos = (int)((size_t)n / s->tamanho_scan);
+        for (int k = 0; k < lidos; k++) {
+            const uint8_t *scan = s->buffer + (size_t)k * s->tamanho_scan;
+            for (int i = 0; i < s->num; i++) {
+                somas[i] += decodificarCanal(&s->canais[i], scan);
+            }
+        }
+        scans += lidos;
+        if (lidos < IIO_LEITURA_SCANS) {
+            break;
+        }
+    }
+    for (int i = 0; i < s->num && scans > 0; i++) {
+        medias[i] = (double)somas[i] / scans;
+    }
+    s->scans += (unsigned long)scans;
+    return scans;
+}
+
+// Função para interpretar o sensor de um servo na linha de comando
+int interpretarSensor(ConfigSensor *cfg, const char *texto) {
+    cfg->bruto_min = 0;
+    cfg->bruto_max = -1;
+    int campos = sscanf(texto, "%d:%d:%d", &cfg->canal_adc,
+                        &cfg->bruto_min, &cfg->bruto_max);
+    if ((campos != 1 && campos != 3) || cfg->canal_adc < 0 ||
+        (campos == 3 && cfg->bruto_min == cfg->bruto_max)) {
+        fprintf(stderr, "Sensor inválido: '%s' (use canal[:bruto_0:bruto_180])\n", texto);
+        return -1;
+    }
+    return 0;
+}
+
+// Função para interpretar os ganhos do PID na linha de comando
+int interpretarGanhos(GanhosControle *ganhos, const char *texto) {
+    if (sscanf(texto, "%lf:%lf:%lf", &ganhos->kp, &ganhos->ki, &ganhos->kd) != 3 ||
+        ganhos->kp < 0.0 || ganhos->ki < 0.0 || ganhos->kd < 0.0) {
+        fprintf(stderr, "Ganhos inválidos: '%s' (use kp:ki:kd)\n", texto);
+        return -1;
+    }
+    return 0;
+}
+
+// Função para abrir a realimentação
+int abrirRealimentacao(Realimentacao *r, const char *dispositivo,
+                       const char *gatilho, const ConfigSensor *sensores,
+                       int num, const GanhosControle *ganhos, long periodo_ns) {
+    SensorIIO *s = &r->sensor;
+    char valor[16];
+
+    memset(r, 0, sizeof(*r));
+    s->fd = -1;
+    r->ganhos = *ganhos;
+    r->periodo_s = periodo_ns / 1e9;
+    r->ticks_limite_desvio = (int)(TEMPO_DESVIO_MS * 1000000L / periodo_ns);
+    if (num < 1 || num > SERVOS_MAX) {
+        fprintf(stderr, "Número de sensores inválido: %d\n", num);
+        return -1;
+    }
+    for (int i = 0; i < SERVOS_MAX; i++) {
+        s->canais[i].deslocamento = (size_t)-1;
+    }
+
+    if (dispositivo[0] == '/') {
+        snprintf(s->dir, sizeof(s->dir), "%s", dispositivo);
+    } else {
+        snprintf(s->dir, sizeof(s->dir), IIO_DISPOSITIVOS "/%.70s", dispositivo);
+    }
+
+    // O buffer precisa estar desligado para mudar canais e trigger
+    escreverAtributoIIO(s->dir, "buffer/enable", "0");
+    if (configurarCanaisIIO(s, sensores, num) < 0) {
+        return -1;
+    }
+    if (gatilho && escreverAtributoIIO(s->dir, "trigger/current_trigger", gatilho) < 0) {
+        fprintf(stderr, "%s: trigger %s: %s\n", s->dir, gatilho, strerror(errno));
+        return -1;
+    }
+    snprintf(valor, sizeof(valor), "%d", IIO_BUFFER_SCANS);
+    if (escreverAtributoIIO(s->dir, "buffer/length", valor) < 0 ||
+        escreverAtributoIIO(s->dir, "buffer/enable", "1") < 0) {
+        fprintf(stderr, "%s: erro ao habilitar o buffer: %s\n", s->dir, strerror(errno));
+        return -1;
+    }
+
+    // O dispositivo de caractere tem o mesmo nome do diretório no sysfs
+    char caminho[PWM_TAM_CAMINHO + 8];
+    const char *base = strrchr(s->dir, '/');
+    snprintf(caminho, sizeof(caminho), "/dev/%s", base ? base + 1 : s->dir);
+    s->fd = open(caminho, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (s->fd < 0) {
+        perror(caminho);
+        escreverAtributoIIO(s->dir, "buffer/enable", "0");
+        return -1;
+    }
+
+    for (int i = 0; i < num; i++) {
+        ControlePosicao *c = &r->canais[i];
+        c->sensor = sensores[i];
+        if (c->sensor.bruto_max < 0) {
+            const CanalIIO *ci = &s->canais[i];
+            c->sensor.bruto_max = ci->com_sinal ? (1 << (ci->bits - 1)) - 1
+                                                : (int)((1LL << ci->bits) - 1);
+        }
+    }
+    printf("Realimentação: %s | %d canal(is) | scan de %zu bytes | "
+           "kp %.2f ki %.2f kd %.3f | antecipação %.3fs\n",
+           s->dir, num, s->tamanho_scan, ganhos->kp, ganhos->ki, ganhos->kd,
+           ganhos->antecipacao);
+    return 0;
+}
+
+// Função para ligar a malha fechada no grupo
+void conectarRealimentacao(Realimentacao *r, GrupoServos *grupo, FilaRegistro *log) {
+    r->log = log;
+    for (int i = 0; i < grupo->num; i++) {
+        ControlePosicao *c = &r->canais[i];
+        c->referencia = c->referencia_anterior = anguloAtual(&grupo->servos[i]);
+        c->escrito = grupo->servos[i].ultimo;
+    }
+    grupo->realimentacao = r;
+}
+
+// Ângulo (graus, com fração) de um duty na calibração do servo
+static double anguloDoDuty(const Servo *s, int duty) {
+    return (double)(duty - s->cfg.duty_min) * ANGULO_MAX /
+           (s->cfg.duty_max - s->cfg.duty_min);
+}
+
+// Registra o início ou o fim de um desvio de seguimento
+static void registrarDesvio(Realimentacao *r, int canal, double erro, int ativo) {
+    if (!r->log) {
+        return;
+    }
+    RegistroLog reg;
+    reg.tipo = REG_DESVIO;
+    reg.desvio.erro_mgraus = (int32_t)lround(erro * 1000.0);
+    reg.desvio.medido_mgraus = (int32_t)lround(r->canais[canal].medido * 1000.0);
+    reg.desvio.canal = (uint8_t)canal;
+    reg.desvio.ativo = (uint8_t)ativo;
+    registrar(r->log, &reg);
+}
+
+// PID sobre o erro de posição, com derivada na medida (sem salto quando a
+// referência muda) e integral congelada enquanto o comando satura
+static double calcularComando(Realimentacao *r, int canal, int amostra_nova) {
+    ControlePosicao *c = &r->canais[canal];
+    const GanhosControle *g = &r->ganhos;
+    double dt = r->periodo_s;
+    double velocidade = (c->referencia - c->referencia_anterior) / dt;
+    double comando = c->referencia + g->antecipacao * velocidade;
+
+    if (!c->valido) {
+        return comando;             // Sem medida ainda: malha aberta
+    }
+
+    double erro = c->referencia - c->medido;
+    double derivada = amostra_nova ? -(c->medido - c->medido_anterior) / dt : 0.0;
+    comando += g->kp * erro + g->ki * c->integral + g->kd * derivada;
+
+    int saturado = (comando >= ANGULO_MAX && erro > 0) || (comando <= 0 && erro < 0);
+    if (!saturado && g->ki > 0.0) {
+        double limite = g->integral_max / g->ki;
+        c->integral += erro * dt;
+        if (c->integral > limite) c->integral = limite;
+        if (c->integral < -limite) c->integral = -limite;
+    }
+
+    // Estatísticas de seguimento e detecção de travamento
+    double absoluto = fabs(erro);
+    if (absoluto > c->erro_max) c->erro_max = absoluto;
+    c->soma_erro2 += erro * erro;
+    c->amostras++;
+    if (absoluto > g->limite_erro) {
+        if (++c->ticks_desvio >= r->ticks_limite_desvio && !c->em_desvio) {
+            c->em_desvio = 1;
+            registrarDesvio(r, canal, erro, 1);
+        }
+    } else {
+        c->ticks_desvio = 0;
+        if (c->em_desvio && absoluto < g->limite_erro / 2) {
+            c->em_desvio = 0;
+            registrarDesvio(r, canal, erro, 0);
+        }
+    }
+
+    if (comando < 0.0) comando = 0.0;
+    if (comando > ANGULO_MAX) comando = ANGULO_MAX;
+    return comando;
+}
+
+// Escreve o comando no servo. O passo guarda o duty comandado, mas o
+// ângulo da posição medida, que é o que o laço mostra (LEDs) e registra
+static void escreverComando(Servo *s, ControlePosicao *c, double comando) {
+    int duty = s->cfg.duty_min +
+               (int)lround(comando * (s->cfg.duty_max - s->cfg.duty_min) / ANGULO_MAX);
+    int angulo = (int)lround(c->valido ? c->medido : comando);
+    if (angulo < 0) angulo = 0;
+    if (angulo > ANGULO_MAX) angulo = ANGULO_MAX;
+
+    const PassoTabela *ultimo = s->ultimo;
+    if (ultimo && ultimo == c->escrito && ultimo->duty == duty && ultimo->angulo == angulo) {
+        return;
+    }
+
+    PassoTabela *p = &c->passos[c->indice];
+    c->indice ^= 1;
+    preencherPasso(p, duty, &s->cal->tabela);
+    p->angulo = (int16_t)angulo;
+    if (!ultimo || ultimo->duty != duty) {
+        setPWMDutyCycleTexto(&s->pwm, p->duty, p->texto, p->len);
+    }
+    s->ultimo = p;
+    c->escrito = p;
+}
+
+// Função para executar um tick em malha fechada
+int avancarServosRealimentados(GrupoServos *grupo) {
+    Realimentacao *r = grupo->realimentacao;
+    double medias[SERVOS_MAX];
+    int movendo = 0;
+
+    int scans = lerSensorIIO(&r->sensor, medias);
+    r->ticks++;
+    if (scans == 0) {
+        r->ticks_sem_amostra++;
+    }
+
+    for (int i = 0; i < grupo->num; i++) {
+        Servo *s = &grupo->servos[i];
+        ControlePosicao *c = &r->canais[i];
+
+        // Referência: o passo da trajetória; parado, a última posição
+        // pedida. Uma escrita direta de outro módulo (fluxo, memória
+        // compartilhada) vira a nova referência
+        c->referencia_anterior = c->referencia;
+        if (s->atual) {
+            c->referencia = anguloDoDuty(s, s->atual->passos[s->passo].duty);
+            if (++s->passo == s->atual->num_ticks) {
+                s->atual = NULL;
+            }
+            movendo++;
+        } else if (s->ultimo && s->ultimo != c->escrito) {
+            c->referencia = anguloDoDuty(s, s->ultimo->duty);
+        }
+
+        if (scans > 0) {
+            const ConfigSensor *cfg = &c->sensor;
+            c->medido_anterior = c->valido ? c->medido : 0.0;
+            c->medido = (medias[i] - cfg->bruto_min) * ANGULO_MAX /
+                        (cfg->bruto_max - cfg->bruto_min);
+            if (!c->valido) {
+                c->medido_anterior = c->medido;
+                c->valido = 1;
+            }
+            s->angulo_medido = c->medido;
+            s->medido = 1;
+        }
+
+        escreverComando(s, c, calcularComando(r, i, scans > 0));
+        if (c->em_desvio) {
+            s->falhas |= FALHA_DESVIO;
+        } else {
+            s->falhas &= ~FALHA_DESVIO;
+        }
+    }
+    return movendo;
+}
+
+// Função para encerrar a realimentação
+void fecharRealimentacao(Realimentacao *r) {
+    SensorIIO *s = &r->sensor;
+    if (s->num == 0 || s->fd < 0) {
+        return;                     // Não foi aberta
+    }
+    close(s->fd);
+    s->fd = -1;
+    escreverAtributoIIO(s->dir, "buffer/enable", "0");
+
+    printf("\n===== Realimentação =====\n");
+    printf("%lu ticks | %lu scans | %lu tick(s) sem amostra nova\n",
+           r->ticks, s->scans, r->ticks_sem_amostra);
+    for (int i = 0; i < s->num; i++) {
+        const ControlePosicao *c = &r->canais[i];
+        printf("Servo %d: erro máximo %.2f° | RMS %.2f°\n", i, c->erro_max,
+               c->amostras ? sqrt(c->soma_erro2 / c->amostras) : 0.0);
+    }
+}
@@ -0,0 +1,131 @@
+#ifndef REALIMENTACAO_H
+#define REALIMENTACAO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "servos.h"
+#include "registro.h"
+
+// Diretório dos dispositivos IIO no sysfs
+#define IIO_DISPOSITIVOS "/sys/bus/iio/devices"
+
+// Profundidade do buffer do kernel (em scans)
+#define IIO_BUFFER_SCANS 64
+
+// Scans lidos por chamada de read()
+#define IIO_LEITURA_SCANS 32
+
+// Maior scan aceito (um canal de até 8 bytes por servo)
+#define IIO_SCAN_MAX (SERVOS_MAX * 8)
+
+// Ganhos padrão do controlador
+#define KP_PADRAO 0.5
+#define KI_PADRAO 2.0               // 1/s
+#define KD_PADRAO 0.0               // s
+#define INTEGRAL_MAX_PADRAO 20.0    // Correção máxima do termo integral (graus)
+#define LIMITE_ERRO_PADRAO 10.0     // Desvio registrado acima disto (graus)
+
+// Por quanto tempo o erro precisa passar do limite para ser registrado (ms)
+#define TEMPO_DESVIO_MS 250
+
+// Sensor de posição de um servo: canal do ADC e leituras nos extremos
+typedef struct {
+    int canal_adc;                  // in_voltageN
+    int bruto_min;                  // Leitura em 0°
+    int bruto_max;                  // Leitura em 180° (-1 = fundo de escala)
+} ConfigSensor;
+
+// Ganhos do controlador (erros e correções em graus)
+typedef struct {
+    double kp;
+    double ki;
+    double kd;
+    double antecipacao;             // Feed-forward: s de velocidade da referência
+    double integral_max;
+    double limite_erro;
+} GanhosControle;
+
+// Um canal do scan do IIO (formato de scan_elements/in_voltageN_type)
+typedef struct {
+    int indice;                     // Ordem no scan
+    size_t deslocamento;            // Posição no scan (bytes)
+    int bytes;
+    int bits;
+    int shift;
+    int com_sinal;
+    int big_endian;
+} CanalIIO;
+
+// Captura em buffer de um ADC IIO. O disparo vem de um trigger do kernel
+// (hrtimer ou o do próprio ADC), independente do laço de controle; a cada
+// tick o laço lê de uma vez, sem bloquear, todos os scans acumulados no
+// buffer e usa a média deles.
+typedef struct {
+    char dir[PWM_TAM_CAMINHO];      // iio:deviceN no sysfs
+    int fd;                         // /dev/iio:deviceN
+    CanalIIO canais[SERVOS_MAX];    // Um por servo
+    int num;
+    size_t tamanho_scan;
+    unsigned long scans;
+    uint8_t buffer[IIO_LEITURA_SCANS * IIO_SCAN_MAX];
+} SensorIIO;
+
+// Estado do controlador de um servo
+typedef struct {
+    ConfigSensor sensor;
+    double referencia;              // Posição pedida (graus)
+    double referencia_anterior;
+    double medido;                  // Posição medida (graus)
+    double medido_anterior;
+    double integral;
+    int valido;                     // 1 = já houve amostra
+    const PassoTabela *escrito;     // Último passo escrito pelo controlador
+    PassoTabela passos[2];          // Alternados, como nos escritores diretos
+    int indice;
+    int ticks_desvio;
+    int em_desvio;
+    double erro_max;
+    double soma_erro2;
+    unsigned long amostras;
+} ControlePosicao;
+
+// Malha fechada de posição de todos os servos do grupo.
+// Roda a cada tick do agendador, que dá a taxa fixa do controle: a
+// referência é o passo da trajetória (ou a última posição escrita, com o
+// servo parado) e o duty escrito é a referência corrigida pelo PID sobre o
+// erro medido, mais a antecipação proporcional à velocidade da referência.
+// O ângulo do passo escrito (e com ele os LEDs) vem da posição medida, e
+// anguloAtual() passa a devolver a medida. Um desvio longo marca
+// FALHA_DESVIO no servo.
+typedef struct Realimentacao {
+    SensorIIO sensor;
+    ControlePosicao canais[SERVOS_MAX];
+    GanhosControle ganhos;
+    double periodo_s;
+    int ticks_limite_desvio;
+    FilaRegistro *log;              // NULL = sem registro de desvios
+    unsigned long ticks;
+    unsigned long ticks_sem_amostra;
+} Realimentacao;
+
+// Interpreta "CANAL[:MIN:MAX]"; retorna 0 ou -1
+int interpretarSensor(ConfigSensor *cfg, const char *texto);
+
+// Interpreta "KP:KI:KD"; retorna 0 ou -1
+int interpretarGanhos(GanhosControle *ganhos, const char *texto);
+
+// Configura o buffer do ADC (canais, trigger, tamanho) e o habilita.
+// dispositivo é iio:deviceN ou o caminho do diretório no sysfs; gatilho
+// é o nome do trigger (NULL = manter o atual)
+int abrirRealimentacao(Realimentacao *r, const char *dispositivo,
+                       const char *gatilho, const ConfigSensor *sensores,
+                       int num, const GanhosControle *ganhos, long periodo_ns);
+
+// Liga a malha fechada no grupo, partindo da posição atual de cada servo
+void conectarRealimentacao(Realimentacao *r, GrupoServos *grupo, FilaRegistro *log);
+
+// Desabilita o buffer e imprime o resumo dos erros de seguimento
+void fecharRealimentacao(Realimentacao *r);
+
+#endif
@@ -0,0 +1,239 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+#include "registro.h"
+#include "tabela.h"
+#include "leds.h"
+#include "protocolo.h"
+#include "entradas.h"
+#include "supervisor.h"
+
+#define REGISTRO_MASCARA (REGISTRO_CAPACIDADE - 1)
+
+_Static_assert((REGISTRO_CAPACIDADE & REGISTRO_MASCARA) == 0,
+               "REGISTRO_CAPACIDADE deve ser potência de 2");
+
+// Função para iniciar a fila de registros
+void iniciarFilaRegistro(FilaRegistro *fila) {
+    atomic_init(&fila->cabeca, 0);
+    atomic_init(&fila->cauda, 0);
+    atomic_init(&fila->descartados, 0);
+    atomic_init(&fila->ativo, 0);
+    fila->suprimir_passos = 0;
+}
+
+// Função para enfileirar um registro (lado do produtor)
+int registrar(FilaRegistro *fila, const RegistroLog *reg) {
+    size_t cabeca = atomic_load_explicit(&fila->cabeca, memory_order_relaxed);
+    size_t cauda = atomic_load_explicit(&fila->cauda, memory_order_acquire);
+
+    if (cabeca - cauda == REGISTRO_CAPACIDADE) {
+        atomic_fetch_add_explicit(&fila->descartados, 1, memory_order_relaxed);
+        return -1;
+    }
+    fila->itens[cabeca & REGISTRO_MASCARA] = *reg;
+    atomic_store_explicit(&fila->cabeca, cabeca + 1, memory_order_release);
+    return 0;
+}
+
+// Função para registrar um passo da varredura
+int registrarPasso(FilaRegistro *fila, int duty, int angulo, int leds) {
+    if (fila->suprimir_passos) {
+        return 0;
+    }
+    RegistroLog reg;
+    reg.tipo = REG_PASSO;
+    reg.passo.duty = duty;
+    reg.passo.angulo = (int16_t)angulo;
+    reg.passo.leds = (uint8_t)leds;
+    return registrar(fila, &reg);
+}
+
+// Função para registrar um evento sem carga
+int registrarEvento(FilaRegistro *fila, TipoRegistro tipo) {
+    RegistroLog reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.tipo = tipo;
+    return registrar(fila, &reg);
+}
+
+// Função para retirar um registro (lado do consumidor)
+int consumirRegistro(FilaRegistro *fila, RegistroLog *reg) {
+    size_t cauda = atomic_load_explicit(&fila->cauda, memory_order_relaxed);
+    size_t cabeca = atomic_load_explicit(&fila->cabeca, memory_order_acquire);
+
+    if (cauda == cabeca) {
+        return 0;
+    }
+    *reg = fila->itens[cauda & REGISTRO_MASCARA];
+    atomic_store_explicit(&fila->cauda, cauda + 1, memory_order_release);
+    return 1;
+}
+
+// Converte um registro binário no texto mostrado no console
+static void imprimirRegistro(const RegistroLog *reg) {
+    switch (reg->tipo) {
+    case REG_PASSO:
+        printf("Ângulo: %3d° | LED1: %s | LED2: %s", reg->passo.angulo,
+               (reg->passo.leds & LED1_BIT) ? "ON " : "OFF",
+               (reg->passo.leds & LED2_BIT) ? "ON" : "OFF");
+        if (reg->passo.leds & ~(LED1_BIT | LED2_BIT)) {
+            printf(" | LEDs: 0x%02x", reg->passo.leds);  // Linhas além das duas
+        }
+        printf("\n");
+        break;
+    case REG_SUBIDA:
+        printf("Movendo de 0° para 180°...\n");
+        break;
+    case REG_DESCIDA:
+        printf("Movendo de 180° para 0°...\n");
+        break;
+    case REG_FIM_VARREDURA:
+        printf("\n");
+        break;
+    case REG_CICLO:
+        printf("\nCiclo %u: %u overrun(s) | atraso máximo: %u us | total: %u\n\n",
+               reg->ciclo.numero, reg->ciclo.overruns,
+               reg->ciclo.atraso_max_us, reg->ciclo.overruns_total);
+        break;
+    case REG_COMANDO:
+        if (reg->comando.status == ACK_OK) {
+            printf("Comando #%u: servo %u -> %.1f° (aplicado em %u us)\n",
+                   reg->comando.sequencia, reg->comando.canal,
+                   reg->comando.angulo_mgraus / 1000.0,
+                   reg->comando.latencia_ns / 1000);
+        } else if (reg->comando.status == ACK_SUBSTITUIDO) {
+            printf("Comando #%u: servo %u -> %.1f° substituído antes do tick\n",
+                   reg->comando.sequencia, reg->comando.canal,
+                   reg->comando.angulo_mgraus / 1000.0);
+        } else {
+            printf("Comando #%u rejeitado: %s\n", reg->comando.sequencia,
+                   descreverStatusAck(reg->comando.status));
+        }
+        break;
+    case REG_FLUXO:
+        if (reg->fluxo.inicio) {
+            printf("Fluxo do servo %u iniciado\n", reg->fluxo.canal);
+        } else {
+            printf("Fluxo do servo %u encerrado: %u ponto(s) | %u subfluxo(s) | "
+                   "%u descartado(s)\n", reg->fluxo.canal, reg->fluxo.recebidos,
+                   reg->fluxo.subfluxos, reg->fluxo.descartados);
+        }
+        break;
+    case REG_ENTRADA:
+        if (reg->entrada.tipo == ENTRADA_EMERGENCIA) {
+            printf("Emergência (linha %u) %s", reg->entrada.pino,
+                   reg->entrada.ativo ? "ACIONADA: PWM desligado" : "liberada");
+        } else {
+            printf("Fim de curso %s do servo %u (linha %u) %s",
+                   reg->entrada.tipo == ENTRADA_FIM_MIN ? "mínimo" : "máximo",
+                   reg->entrada.canal, reg->entrada.pino,
+                   reg->entrada.ativo ? "acionado" : "liberado");
+        }
+        printf(" (tratado em %u us)\n", reg->entrada.atraso_us);
+        break;
+    case REG_DESVIO:
+        if (reg->desvio.ativo) {
+            printf("Servo %u travado ou atrasado: medido %.1f° | erro %.1f°\n",
+                   reg->desvio.canal, reg->desvio.medido_mgraus / 1000.0,
+                   reg->desvio.erro_mgraus / 1000.0);
+        } else {
+            printf("Servo %u de volta à referência (medido %.1f°)\n",
+                   reg->desvio.canal, reg->desvio.medido_mgraus / 1000.0);
+        }
+        break;
+    case REG_ROTEIRO:
+        if (reg->roteiro.inicio) {
+            printf("Roteiro: passada %u a partir de %.3fs\n", reg->roteiro.passada,
+                   reg->roteiro.posicao_ms / 1000.0);
+        } else {
+            printf("Roteiro: passada %u concluída\n\n", reg->roteiro.passada);
+        }
+        break;
+    case REG_SUPERVISOR:
+        switch (reg->supervisor.nivel) {
+        case SUPERVISOR_NORMAL:
+            printf("Supervisor: laço em dia de novo\n");
+            break;
+        case SUPERVISOR_AVISO:
+            printf("Supervisor: %u deadline(s) perdido(s) em ticks seguidos\n",
+                   reg->supervisor.perdas);
+            break;
+        case SUPERVISOR_DEGRADADO:
+            printf("Supervisor: %u deadline(s) perdido(s) seguidos: degradado (sem "
+                   "registro de passos, métricas a cada %d ticks)\n",
+                   reg->supervisor.perdas, SUPERVISOR_DIVISOR_METRICAS);
+            break;
+        default:
+            printf("Supervisor: %u deadline(s) perdido(s) seguidos: estacionando\n",
+                   reg->supervisor.perdas);
+            break;
+        }
+        break;
+    }
+}
+
+// Esvazia a fila no stdout e avisa sobre registros descartados
+static void esvaziarFila(FilaRegistro *fila, unsigned long *descartados_vistos) {
+    RegistroLog reg;
+    int escritos = 0;
+
+    while (consumirRegistro(fila, &reg)) {
+        imprimirRegistro(&reg);
+        escritos++;
+    }
+
+    unsigned long descartados =
+        atomic_load_explicit(&fila->descartados, memory_order_relaxed);
+    if (descartados != *descartados_vistos) {
+        printf("[registro] %lu registro(s) descartado(s) (total: %lu)\n",
+               descartados - *descartados_vistos, descartados);
+        *descartados_vistos = descartados;
+        escritos++;
+    }
+    if (escritos > 0) {
+        fflush(stdout);
+    }
+}
+
+// Corpo da thread consumidora
+static void *threadConsumidor(void *arg) {
+    FilaRegistro *fila = arg;
+    unsigned long descartados_vistos = 0;
+    struct timespec intervalo = { 0, REGISTRO_INTERVALO_NS };
+
+    // Menor prioridade possível no escalonador normal
+    setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 19);
+
+    while (atomic_load_explicit(&fila->ativo, memory_order_acquire)) {
+        esvaziarFila(fila, &descartados_vistos);
+        nanosleep(&intervalo, NULL);
+    }
+    esvaziarFila(fila, &descartados_vistos);
+    return NULL;
+}
+
+// Função para criar a thread consumidora
+int iniciarConsumidorRegistro(FilaRegistro *fila) {
+    atomic_store(&fila->ativo, 1);
+    int ret = pthread_create(&fila->thread, NULL, threadConsumidor, fila);
+    if (ret != 0) {
+        atomic_store(&fila->ativo, 0);
+        fprintf(stderr, "Erro ao criar thread de registro: %s\n", strerror(ret));
+        return -1;
+    }
+    pthread_setname_np(fila->thread, "servo_log");
+    return 0;
+}
+
+// Função para encerrar a thread consumidora
+void pararConsumidorRegistro(FilaRegistro *fila) {
+    if (atomic_exchange(&fila->ativo, 0)) {
+        pthread_join(fila->thread, NULL);
+    }
+}
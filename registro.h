@@ -0,0 +1,119 @@
+#ifndef REGISTRO_H
+#define REGISTRO_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+// Capacidade da fila de registros (potência de 2)
+#define REGISTRO_CAPACIDADE 1024
+
+// Intervalo de sono do consumidor quando a fila está vazia (em ns)
+#define REGISTRO_INTERVALO_NS 10000000L
+
+// Tipos de registro emitidos pelo laço de controle
+typedef enum {
+    REG_PASSO,              // Um passo da varredura
+    REG_SUBIDA,             // Início da varredura 0° -> 180°
+    REG_DESCIDA,            // Início da varredura 180° -> 0°
+    REG_FIM_VARREDURA,      // Fim de uma meia varredura
+    REG_CICLO,              // Relatório de overruns de um ciclo completo
+    REG_COMANDO,            // Comando de posição recebido pelo servidor
+    REG_FLUXO,              // Início ou fim do fluxo de pontos de um canal
+    REG_ENTRADA,            // Mudança de uma entrada digital
+    REG_DESVIO,             // Posição medida longe da referência (ou de volta)
+    REG_ROTEIRO,            // Início ou fim de uma passada do roteiro
+    REG_SUPERVISOR          // Mudança de nível da escalada do supervisor
+} TipoRegistro;
+
+// Registro binário de tamanho fixo; a formatação em texto só acontece
+// na thread consumidora
+typedef struct {
+    uint32_t tipo;
+    union {
+        struct {
+            int32_t duty;
+            int16_t angulo;
+            uint8_t leds;           // Máscara aplicada nos LEDs (bit i = linha i)
+        } passo;
+        struct {
+            uint32_t numero;
+            uint32_t overruns;
+            uint32_t atraso_max_us;
+            uint32_t overruns_total;
+        } ciclo;
+        struct {
+            uint32_t sequencia;
+            int32_t angulo_mgraus;  // Alvo em milésimos de grau
+            uint32_t latencia_ns;   // Chegada do pacote -> escrita do duty
+            uint8_t canal;
+            uint8_t status;         // ACK_* (protocolo.h)
+        } comando;
+        struct {
+            uint32_t recebidos;
+            uint32_t subfluxos;
+            uint32_t descartados;   // Buffer cheio ou fora de ordem
+            uint8_t canal;
+            uint8_t inicio;         // 1 = início, 0 = fim
+        } fluxo;
+        struct {
+            uint32_t atraso_us;     // Borda (kernel) -> tratamento
+            uint8_t tipo;           // TipoEntrada (entradas.h)
+            uint8_t pino;
+            uint8_t canal;
+            uint8_t ativo;          // 1 = acionada
+        } entrada;
+        struct {
+            int32_t erro_mgraus;    // Referência - medido
+            int32_t medido_mgraus;
+            uint8_t canal;
+            uint8_t ativo;          // 1 = desvio começou, 0 = terminou
+        } desvio;
+        struct {
+            uint32_t passada;       // 1 = primeira
+            uint32_t posicao_ms;    // Posição no roteiro
+            uint8_t inicio;         // 1 = início, 0 = fim
+        } roteiro;
+        struct {
+            uint32_t perdas;        // Deadlines perdidos em ticks seguidos
+            uint8_t nivel;          // NivelSupervisor (supervisor.h)
+        } supervisor;
+    };
+} RegistroLog;
+
+// Fila SPSC sem trava entre o laço de controle (produtor) e a thread de
+// console (consumidor). O produtor nunca bloqueia: com a fila cheia o
+// registro é descartado e apenas contado.
+typedef struct {
+    _Alignas(64) atomic_size_t cabeca;      // Escrito só pelo produtor
+    _Alignas(64) atomic_size_t cauda;       // Escrito só pelo consumidor
+    _Alignas(64) atomic_ulong descartados;
+    atomic_int ativo;
+    int suprimir_passos;                    // 1 = passos descartados na origem
+    pthread_t thread;
+    RegistroLog itens[REGISTRO_CAPACIDADE];
+} FilaRegistro;
+
+// Inicia a fila vazia
+void iniciarFilaRegistro(FilaRegistro *fila);
+
+// Enfileira um registro; retorna 0 ou -1 se a fila estava cheia
+int registrar(FilaRegistro *fila, const RegistroLog *reg);
+
+// Atalho para registrar um passo da varredura (nada, com suprimir_passos:
+// o supervisor degradou o laço)
+int registrarPasso(FilaRegistro *fila, int duty, int angulo, int leds);
+
+// Atalho para registrar um evento sem carga (subida, descida, fim)
+int registrarEvento(FilaRegistro *fila, TipoRegistro tipo);
+
+// Retira um registro; retorna 1 se havia registro ou 0 se a fila está vazia
+int consumirRegistro(FilaRegistro *fila, RegistroLog *reg);
+
+// Cria a thread consumidora de baixa prioridade que escreve no stdout
+int iniciarConsumidorRegistro(FilaRegistro *fila);
+
+// Esvazia a fila e encerra a thread consumidora
+void pararConsumidorRegistro(FilaRegistro *fila);
+
+#endif
@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <math.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "reproducao.h"
+
+#define NS_POR_S 1000000000LL
+
+_Static_assert(ROTEIRO_CANAIS_MAX == SERVOS_MAX,
+               "ROTEIRO_CANAIS_MAX deve acompanhar SERVOS_MAX");
+
+// Confere o quadro k: ângulos no curso e instante depois do anterior
+static int quadroValido(const Reproducao *r, uint64_t k) {
+    const QuadroRoteiro *q = quadroRoteiro(r->cab, k);
+    for (uint32_t c = 0; c < r->cab->num_canais; c++) {
+        if (q->angulo_mgraus[c] < 0 || q->angulo_mgraus[c] > ANGULO_MAX * 1000) {
+            return 0;
+        }
+    }
+    return k == 0 || q->instante_ns > quadroRoteiro(r->cab, k - 1)->instante_ns;
+}
+
+// Leva o cursor ao último quadro com instante <= posicao_ns; retorna 0 se
+// encontrou um quadro inválido pelo caminho
+static int moverCursor(Reproducao *r) {
+    while (r->cursor + 1 < r->cab->num_quadros &&
+           quadroRoteiro(r->cab, r->cursor + 1)->instante_ns <= r->posicao_ns) {
+        r->cursor++;
+        if (!quadroValido(r, r->cursor)) {
+            return 0;
+        }
+    }
+    if (r->cursor + 1 < r->cab->num_quadros && !quadroValido(r, r->cursor + 1)) {
+        return 0;
+    }
+
+    // Pede a próxima janela assim que a leitura entra na atual: a leitura
+    // antecipada corre no kernel enquanto esta é consumida
+    size_t offset = (size_t)((const char *)quadroRoteiro(r->cab, r->cursor) -
+                             (const char *)r->cab);
+    if (offset >= r->janela) {
+        r->janela = (offset / ROTEIRO_JANELA + 1) * ROTEIRO_JANELA;
+        if (r->janela < r->tamanho) {
+            size_t n = r->tamanho - r->janela;
+            madvise((char *)r->cab + r->janela, n < ROTEIRO_JANELA ? n : ROTEIRO_JANELA,
+                    MADV_WILLNEED);
+        }
+    }
+    return 1;
+}
+
+// Ângulo do canal na posição atual (milésimos de grau)
+static int32_t anguloRoteiro(const Reproducao *r, uint32_t canal) {
+    const QuadroRoteiro *a = quadroRoteiro(r->cab, r->cursor);
+    if (r->cursor + 1 == r->cab->num_quadros || r->posicao_ns <= a->instante_ns) {
+        return a->angulo_mgraus[canal];
+    }
+    const QuadroRoteiro *b = quadroRoteiro(r->cab, r->cursor + 1);
+    double fracao = (double)(r->posicao_ns - a->instante_ns) /
+                    (double)(b->instante_ns - a->instante_ns);
+    return (int32_t)lround(a->angulo_mgraus[canal] +
+                           fracao * (b->angulo_mgraus[canal] - a->angulo_mgraus[canal]));
+}
+
+// Função para mapear o roteiro
+int abrirReproducao(Reproducao *r, const char *caminho, int num_servos,
+                    double velocidade, double inicio_s, unsigned long repeticoes,
+                    long periodo_ns) {
+    struct stat st;
+
+    memset(r, 0, sizeof(*r));
+    if (velocidade <= 0.0 || inicio_s < 0.0) {
+        fprintf(stderr, "Velocidade e início do roteiro devem ser positivos\n");
+        return -1;
+    }
+    int fd = open(caminho, O_RDONLY | O_CLOEXEC);
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        perror(caminho);
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    if ((size_t)st.st_size < sizeof(CabecalhoRoteiro)) {
+        fprintf(stderr, "%s: arquivo curto demais para um roteiro\n", caminho);
+        close(fd);
+        return -1;
+    }
+    r->tamanho = (size_t)st.st_size;
+    const CabecalhoRoteiro *c = mmap(NULL, r->tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (c == MAP_FAILED) {
+        perror("mmap");
+        return -1;
+    }
+    r->cab = c;
+
+    if (c->magico != ROTEIRO_MAGICO || c->versao != ROTEIRO_VERSAO ||
+        c->num_canais == 0 || c->num_canais > ROTEIRO_CANAIS_MAX ||
+        c->tamanho_quadro != roteiroTamanhoQuadro(c->num_canais) || c->num_quadros == 0 ||
+        (r->tamanho - sizeof(*c)) / c->tamanho_quadro < c->num_quadros) {
+        fprintf(stderr, "%s: não é um roteiro versão %d válido\n", caminho, ROTEIRO_VERSAO);
+        fecharReproducao(r);
+        return -1;
+    }
+    if ((int)c->num_canais > num_servos) {
+        fprintf(stderr, "%s: roteiro de %u canais para %d servo(s)\n",
+                caminho, c->num_canais, num_servos);
+        fecharReproducao(r);
+        return -1;
+    }
+    if (!quadroValido(r, 0) ||
+        quadroRoteiro(c, c->num_quadros - 1)->instante_ns != c->duracao_ns) {
+        fprintf(stderr, "%s: primeiro quadro ou duração inválidos\n", caminho);
+        fecharReproducao(r);
+        return -1;
+    }
+
+    // Leitura em ordem: o kernel lê à frente e descarta o que já passou
+    madvise((void *)c, r->tamanho, MADV_SEQUENTIAL);
+
+    r->inicio_ns = (long long)llround(inicio_s * NS_POR_S);
+    r->avanco_ns = (long long)llround(periodo_ns * velocidade);
+    r->repeticoes = repeticoes;
+    r->periodo_ns = periodo_ns;
+    r->posicao_ns = r->inicio_ns;
+    if (r->inicio_ns > c->duracao_ns) {
+        fprintf(stderr, "%s: início em %.3fs, depois do fim do roteiro (%.3fs)\n",
+                caminho, inicio_s, c->duracao_ns / 1e9);
+        fecharReproducao(r);
+        return -1;
+    }
+    if (r->avanco_ns <= 0 || !moverCursor(r)) {
+        fprintf(stderr, "%s: quadro inválido antes de %.3fs\n", caminho, inicio_s);
+        fecharReproducao(r);
+        return -1;
+    }
+
+    printf("Roteiro: %s | %u canal(is) | %llu quadros | %.3fs | velocidade %.2fx\n",
+           caminho, c->num_canais, (unsigned long long)c->num_quadros,
+           c->duracao_ns / 1e9, velocidade);
+    return 0;
+}
+
+// Função para iniciar a aproximação do ângulo da posição atual
+int planejarEntradaReproducao(Reproducao *r, GrupoServos *grupo,
+                              const PerfilMovimento *perfil) {
+    for (uint32_t i = 0; i < r->cab->num_canais; i++) {
+        Servo *s = &grupo->servos[i];
+        Trajetoria *t = planejarMovimento(s, r->entradas[i], perfil,
+                                          anguloRoteiro(r, i) / 1000.0, r->periodo_ns);
+        if (!t) {
+            return -1;
+        }
+        // O passo 0 é a posição atual
+        s->atual = NULL;
+        if (t->num_ticks > 1) {
+            iniciarMovimento(s, t);
+            s->passo = 1;
+        }
+    }
+    return 0;
+}
+
+// Função para escrever o tick atual do roteiro
+int avancarReproducao(Reproducao *r, GrupoServos *grupo) {
+    adotarCalibracao(grupo);
+    if (!moverCursor(r)) {
+        r->quadros_invalidos++;
+        return 0;
+    }
+    for (uint32_t i = 0; i < r->cab->num_canais; i++) {
+        Servo *s = &grupo->servos[i];
+        s->atual = NULL;
+        if (!escreverAnguloServo(s, r->diretos[i], &r->indice_direto[i],
+                                 anguloRoteiro(r, i), 0)) {
+            contarRepouso(grupo, s);
+        }
+    }
+    for (int i = (int)r->cab->num_canais; i < grupo->num; i++) {
+        contarRepouso(grupo, &grupo->servos[i]);
+    }
+
+    int ultimo = r->posicao_ns >= r->cab->duracao_ns;
+    r->posicao_ns += r->avanco_ns;
+    return !ultimo;
+}
+
+// Função para fechar a passada
+int proximaPassadaReproducao(Reproducao *r) {
+    r->passadas++;
+    if (r->quadros_invalidos || (r->repeticoes && r->passadas >= r->repeticoes)) {
+        return 0;
+    }
+    r->posicao_ns = 0;
+    r->cursor = 0;
+    r->janela = 0;
+    return 1;
+}
+
+// Função para desfazer o mapeamento
+void fecharReproducao(Reproducao *r) {
+    if (r->cab) {
+        munmap((void *)r->cab, r->tamanho);
+        r->cab = NULL;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef REPRODUCAO_H
+#define REPRODUCAO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "roteiro.h"
+#include "servos.h"
+#include "trajetoria.h"
+
+// Janela de leitura antecipada do mapeamento (bytes): ao entrar em uma,
+// a seguinte é pedida ao kernel com MADV_WILLNEED
+#define ROTEIRO_JANELA (256 * 1024)
+
+// Reprodução de um roteiro pelos ticks do agendador.
+// O arquivo fica mapeado somente para leitura e é percorrido em ordem,
+// sem cópia: a cada tick a posição no roteiro avança velocidade períodos,
+// o cursor anda até o quadro que a contém e o ângulo de cada canal é
+// interpolado entre esse quadro e o seguinte. Antes de cada passada os
+// servos vão da posição atual até o primeiro ângulo com o perfil do
+// programa, para o roteiro nunca começar com um salto.
+typedef struct {
+    const CabecalhoRoteiro *cab;
+    size_t tamanho;                 // Bytes mapeados
+    long long inicio_ns;            // Posição da primeira passada (--inicio)
+    long long avanco_ns;            // Avanço por tick (período * velocidade)
+    unsigned long repeticoes;       // Passadas a fazer (0 = sem fim)
+    unsigned long passadas;         // Passadas concluídas
+    long long posicao_ns;           // Posição atual no roteiro
+    uint64_t cursor;                // Quadro com instante <= posicao_ns
+    size_t janela;                  // Próxima janela a pedir ao kernel
+    long periodo_ns;
+    PassoTabela diretos[SERVOS_MAX][2];
+    int indice_direto[SERVOS_MAX];
+    Trajetoria entradas[SERVOS_MAX][2];     // Aproximação do primeiro ângulo
+    unsigned long quadros_invalidos;
+} Reproducao;
+
+// Mapeia e confere o roteiro para num_servos servos; inicio_s é onde a
+// primeira passada começa, velocidade escala o tempo (2 = o dobro da
+// velocidade) e repeticoes é o número de passadas (0 = sem fim).
+// Retorna 0 ou -1
+int abrirReproducao(Reproducao *r, const char *caminho, int num_servos,
+                    double velocidade, double inicio_s, unsigned long repeticoes,
+                    long periodo_ns);
+
+// Planeja e inicia, em cada canal do roteiro, o movimento da posição atual
+// até o ângulo da posição do roteiro; retorna 0 ou -1
+int planejarEntradaReproducao(Reproducao *r, GrupoServos *grupo,
+                              const PerfilMovimento *perfil);
+
+// Escreve o tick atual do roteiro e avança a posição; retorna 1 enquanto
+// a passada continua ou 0 quando ela terminou (com o último quadro já
+// escrito) ou encontrou um quadro inválido
+int avancarReproducao(Reproducao *r, GrupoServos *grupo);
+
+// Fecha a passada; retorna 1 se outra passada começa (do início do
+// roteiro) ou 0 se todas já foram feitas
+int proximaPassadaReproducao(Reproducao *r);
+
+// Desfaz o mapeamento
+void fecharReproducao(Reproducao *r);
+
+#endif
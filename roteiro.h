@@ -0,0 +1,42 @@
+#ifndef ROTEIRO_H
+#define ROTEIRO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Layout do arquivo de roteiro (usado também pela ferramenta de
+// importação). Um cabeçalho e uma sequência de quadros de tamanho fixo,
+// em ordem crescente de instante; cada quadro traz o ângulo de todos os
+// canais naquele instante, e entre dois quadros o ângulo é interpolado
+// linearmente. O arquivo é lido direto do mapeamento, quadro a quadro.
+
+#define ROTEIRO_MAGICO 0x31544F52u      // "ROT1"
+#define ROTEIRO_VERSAO 1
+#define ROTEIRO_CANAIS_MAX 8            // Igual a SERVOS_MAX
+
+typedef struct {
+    uint32_t magico;
+    uint32_t versao;
+    uint32_t num_canais;
+    uint32_t tamanho_quadro;    // roteiroTamanhoQuadro(num_canais)
+    uint64_t num_quadros;
+    int64_t duracao_ns;         // Instante do último quadro
+} CabecalhoRoteiro;
+
+// Um quadro: instante desde o início e um ângulo por canal
+typedef struct {
+    int64_t instante_ns;
+    int32_t angulo_mgraus[];    // num_canais valores, 0..180000
+} QuadroRoteiro;
+
+// Tamanho de um quadro (múltiplo de 8, para o instante ficar alinhado)
+static inline uint32_t roteiroTamanhoQuadro(uint32_t num_canais) {
+    return (uint32_t)(sizeof(int64_t) + ((num_canais + 1) / 2) * 2 * sizeof(int32_t));
+}
+
+// Quadro k de um roteiro mapeado
+static inline const QuadroRoteiro *quadroRoteiro(const CabecalhoRoteiro *c, uint64_t k) {
+    return (const QuadroRoteiro *)((const char *)(c + 1) + k * c->tamanho_quadro);
+}
+
+#endif
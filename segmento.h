@@ -0,0 +1,110 @@
+#ifndef SEGMENTO_H
+#define SEGMENTO_H
+
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+
+// Interface de memória compartilhada com processos na mesma placa.
+// O segmento POSIX (shm_open) tem um bloco de alvos, escrito pelo cliente,
+// e um bloco de estado, escrito pela thread de controle a cada tick. Cada
+// bloco é protegido por um seqlock: o escritor deixa o contador ímpar
+// durante a escrita, e o leitor repete a cópia se o contador mudou ou
+// estava ímpar. Ninguém bloqueia e nenhum lado faz chamadas de sistema
+// depois do mmap. Cada bloco admite um único escritor. A thread de
+// controle não repete a cópia dos alvos: o cliente pode morrer ou parar
+// no meio de uma escrita e deixar o contador ímpar, então ela faz uma
+// única tentativa por tick e, se falhar, segue com os alvos anteriores.
+
+#define SEGMENTO_NOME_PADRAO "/controle_servo"
+#define SEGMENTO_MAGICO 0x314D4853u     // "SHM1"
+#define SEGMENTO_VERSAO 2
+#define SEGMENTO_CANAIS 8               // Igual a SERVOS_MAX
+
+// Valores de AlvoSegmento.perfil além de TipoPerfil
+#define SEGMENTO_PERFIL_PADRAO 0xFF     // Perfil padrão do controle
+#define SEGMENTO_DIRETO 0xFE            // Sem trajetória: o alvo vai direto ao próximo tick
+
+// Alvo de um canal
+typedef struct {
+    int32_t angulo_mgraus;      // 0..180000
+    uint8_t perfil;             // TipoPerfil, SEGMENTO_PERFIL_PADRAO ou SEGMENTO_DIRETO
+    uint8_t ativo;              // 1 = o canal segue este alvo
+    uint16_t reservado;
+    uint32_t sequencia;         // O cliente incrementa a cada alvo novo
+} AlvoSegmento;
+
+typedef struct {
+    _Alignas(64) atomic_uint seq;
+    AlvoSegmento alvos[SEGMENTO_CANAIS];
+} BlocoAlvos;
+
+// Estado publicado de um canal
+typedef struct {
+    int32_t duty;               // Último duty escrito (ns)
+    int32_t angulo_mgraus;      // Ângulo correspondente
+    uint32_t sequencia;         // Último alvo aceito
+    uint8_t em_movimento;       // 1 = trajetória em curso
+    uint8_t em_repouso;         // 1 = saída em repouso (sem retenção)
+    uint8_t reservado[2];
+} EstadoCanalSegmento;
+
+typedef struct {
+    _Alignas(64) atomic_uint seq;
+    uint64_t atualizado_ns;     // CLOCK_MONOTONIC da última publicação
+    uint64_t ticks;
+    uint64_t overruns;
+    uint32_t leds;              // Máscara LED1_BIT / LED2_BIT
+    uint32_t num_canais;
+    uint32_t leituras_adiadas;  // Ticks em que o bloco de alvos estava em escrita
+    uint32_t reservado;
+    EstadoCanalSegmento canais[SEGMENTO_CANAIS];
+} BlocoEstado;
+
+typedef struct {
+    uint32_t magico;
+    uint32_t versao;
+    uint32_t tamanho;           // sizeof(SegmentoControle)
+    uint32_t periodo_tick_ns;
+    BlocoAlvos alvos;           // Escrito pelo cliente
+    BlocoEstado estado;         // Escrito pela thread de controle
+} SegmentoControle;
+
+// Início e fim de escrita em um bloco (único escritor)
+static inline void iniciarEscritaSeq(atomic_uint *seq) {
+    unsigned s = atomic_load_explicit(seq, memory_order_relaxed);
+    atomic_store_explicit(seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void terminarEscritaSeq(atomic_uint *seq) {
+    unsigned s = atomic_load_explicit(seq, memory_order_relaxed);
+    atomic_store_explicit(seq, s + 1, memory_order_release);
+}
+
+// Copia tamanho bytes de origem para destino com uma leitura consistente
+static inline void lerSeq(const atomic_uint *seq, void *destino,
+                          const void *origem, size_t tamanho) {
+    unsigned antes, depois;
+    do {
+        antes = atomic_load_explicit(seq, memory_order_acquire);
+        memcpy(destino, origem, tamanho);
+        atomic_thread_fence(memory_order_acquire);
+        depois = atomic_load_explicit(seq, memory_order_relaxed);
+    } while ((antes & 1u) || antes != depois);
+}
+
+// Uma única tentativa de leitura consistente; retorna 1, ou 0 se o bloco
+// estava em escrita (destino pode ter ficado com uma cópia misturada)
+static inline int tentarLerSeq(const atomic_uint *seq, void *destino,
+                               const void *origem, size_t tamanho) {
+    unsigned antes = atomic_load_explicit(seq, memory_order_acquire);
+    if (antes & 1u) {
+        return 0;
+    }
+    memcpy(destino, origem, tamanho);
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(seq, memory_order_relaxed) == antes;
+}
+
+#endif
@@ -0,0 +1,902 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+
+#include "servidor.h"
+#include "protocolo.h"
+#include "instrumentacao.h"
+
+#define NS_POR_S 1000000000LL
+
+_Static_assert(COORDENADO_EIXOS_MAX <= SERVOS_MAX,
+               "Um comando coordenado não passa do número de servos");
+
+static long long paraNs(const struct timespec *t) {
+    return (long long)t->tv_sec * NS_POR_S + t->tv_nsec;
+}
+
+static long long agoraMonotonicoNs(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return paraNs(&t);
+}
+
+// Registra o início ou o fim do fluxo de um canal
+static void registrarFluxo(Servidor *sv, int canal, int inicio) {
+    const CanalFluxo *c = &sv->fluxo.canais[canal];
+    RegistroLog reg;
+    reg.tipo = REG_FLUXO;
+    reg.fluxo.recebidos = (uint32_t)c->recebidos;
+    reg.fluxo.subfluxos = (uint32_t)c->subfluxos;
+    reg.fluxo.descartados = (uint32_t)(c->descartados + c->fora_de_ordem);
+    reg.fluxo.canal = (uint8_t)canal;
+    reg.fluxo.inicio = (uint8_t)inicio;
+    registrar(sv->log, &reg);
+}
+
+// Para o movimento do canal: trajetória e fluxo
+static void pararCanal(Servidor *sv, int canal) {
+    sv->servos->servos[canal].atual = NULL;
+    if (sv->fluxo.canais[canal].ativo) {
+        pararFluxoCanal(&sv->fluxo, canal);
+        registrarFluxo(sv, canal, 0);
+    }
+}
+
+// 1 se ir de atual até alvo (milésimos de grau) aproxima o canal de um fim
+// de curso acionado
+static int rumoAoFimDeCurso(const Servidor *sv, int canal, int32_t alvo_mgraus) {
+    double atual = anguloAtual(&sv->servos->servos[canal]) * 1000.0;
+    return (alvo_mgraus < atual &&
+            entradaAtiva(sv->entradas, ENTRADA_FIM_MIN, canal)) ||
+           (alvo_mgraus > atual &&
+            entradaAtiva(sv->entradas, ENTRADA_FIM_MAX, canal));
+}
+
+// Confere o alvo de um canal; retorna o status
+static int conferirAlvo(const Servidor *sv, int canal, int32_t alvo_mgraus) {
+    if (canal >= sv->servos->num) {
+        return ACK_CANAL_INVALIDO;
+    }
+    if (alvo_mgraus < 0 || alvo_mgraus > ANGULO_MAX * 1000) {
+        return ACK_ANGULO_INVALIDO;
+    }
+    if (sv->emergencia) {
+        return ACK_EMERGENCIA;
+    }
+    if (rumoAoFimDeCurso(sv, canal, alvo_mgraus)) {
+        return ACK_FIM_DE_CURSO;
+    }
+    return ACK_OK;
+}
+
+// Ativa o carimbo de tempo de chegada do kernel (CLOCK_REALTIME) no socket
+static void ativarCarimbo(int fd) {
+    int um = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &um, sizeof(um)) < 0) {
+        perror("SO_TIMESTAMPNS");
+    }
+}
+
+// Abre o socket UDP de comandos em todas as interfaces
+static int abrirUDP(int porta) {
+    struct sockaddr_in end;
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("socket UDP");
+        return -1;
+    }
+
+    memset(&end, 0, sizeof(end));
+    end.sin_family = AF_INET;
+    end.sin_addr.s_addr = htonl(INADDR_ANY);
+    end.sin_port = htons((uint16_t)porta);
+    if (bind(fd, (struct sockaddr *)&end, sizeof(end)) < 0) {
+        perror("bind UDP");
+        close(fd);
+        return -1;
+    }
+    ativarCarimbo(fd);
+    return fd;
+}
+
+// Abre o socket Unix de datagramas, substituindo um arquivo antigo
+static int abrirUnix(const char *caminho) {
+    struct sockaddr_un end;
+    int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("socket Unix");
+        return -1;
+    }
+
+    memset(&end, 0, sizeof(end));
+    end.sun_family = AF_UNIX;
+    if (strlen(caminho) >= sizeof(end.sun_path)) {
+        fprintf(stderr, "Caminho do socket muito longo: %s\n", caminho);
+        close(fd);
+        return -1;
+    }
+    strcpy(end.sun_path, caminho);
+    unlink(caminho);
+    if (bind(fd, (struct sockaddr *)&end, sizeof(end)) < 0) {
+        perror(caminho);
+        close(fd);
+        return -1;
+    }
+    ativarCarimbo(fd);
+    return fd;
+}
+
+// Mostra nos LEDs o estado do primeiro servo; seguir o fluxo conta como
+// movimento
+static unsigned int atualizarIndicador(Servidor *sv) {
+    const Servo *s = &sv->servos->servos[0];
+    EstadoIndicador estado = estadoServo(s);
+    if (estado == INDICADOR_PARADO && sv->fluxo.canais[0].ativo) {
+        estado = INDICADOR_MOVENDO;
+    }
+    int angulo = s->ultimo ? s->ultimo->angulo : (int)anguloAtual(s);
+    return indicarLeds(sv->leds, estado, angulo);
+}
+
+// Arma o timer no deadline atual da grade, contando os já perdidos
+static void armarTick(Servidor *sv) {
+    struct itimerspec t;
+
+    prepararTick(&sv->agendador);
+    memset(&t.it_interval, 0, sizeof(t.it_interval));
+    t.it_value = sv->agendador.proximo;
+    timerfd_settime(sv->fd_timer, TFD_TIMER_ABSTIME, &t, NULL);
+    sv->em_movimento = 1;
+}
+
+// Inicia a grade neste instante se nada estava em movimento
+static void garantirTicks(Servidor *sv) {
+    if (!sv->em_movimento) {
+        iniciarAgendador(&sv->agendador, &RELOGIO_MONOTONICO, sv->periodo_ns);
+        armarTick(sv);
+    }
+}
+
+// Preenche o cabeçalho do ACK de um comando, com status ACK_OK
+static void prepararAck(const MensagemPosicao *msg, MensagemAck *ack) {
+    memset(ack, 0, sizeof(*ack));
+    ack->magico = PROTOCOLO_MAGICO;
+    ack->tipo = MSG_ACK;
+    ack->canal = msg->canal;
+    ack->sequencia = msg->sequencia;
+    ack->timestamp_ns = msg->timestamp_ns;
+}
+
+// Perfil pedido em um comando: o do servidor com o tipo trocado
+static PerfilMovimento perfilDoComando(const Servidor *sv, uint8_t tipo) {
+    PerfilMovimento perfil = sv->perfil;
+    if (tipo != PERFIL_PADRAO_SERVIDOR) {
+        perfil.tipo = (TipoPerfil)tipo;
+    }
+    return perfil;
+}
+
+// Latência desde a chegada do pacote até agora
+static uint32_t latenciaDesde(const struct timespec *chegada) {
+    struct timespec aplicado;
+    clock_gettime(CLOCK_REALTIME, &aplicado);
+    long long latencia = paraNs(&aplicado) - paraNs(chegada);
+    return latencia > 0 ? (uint32_t)latencia : 0;
+}
+
+// Prepara o ACK do comando e confere o pedido; retorna o status
+static int validarComando(Servidor *sv, const MensagemPosicao *msg, MensagemAck *ack) {
+    prepararAck(msg, ack);
+    if (msg->perfil != PERFIL_PADRAO_SERVIDOR && msg->perfil > PERFIL_SCURVE) {
+        ack->status = ACK_PERFIL_INVALIDO;
+    } else {
+        ack->status = (uint8_t)conferirAlvo(sv, msg->canal, msg->angulo_mgraus);
+    }
+    if (ack->status != ACK_OK) {
+        sv->rejeitados++;
+    }
+    return ack->status;
+}
+
+// Planeja o movimento pedido; imediato = 1 escreve o primeiro passo já,
+// senão ele sai no avanço do tick em curso. Preenche o ACK
+static void aplicarComando(Servidor *sv, const MensagemPosicao *msg,
+                           const struct timespec *chegada, MensagemAck *ack,
+                           int imediato) {
+    if (validarComando(sv, msg, ack) != ACK_OK) {
+        return;
+    }
+    PerfilMovimento perfil = perfilDoComando(sv, msg->perfil);
+
+    // O movimento parte do último duty escrito, que pode estar no meio de
+    // outro movimento
+    Servo *s = &sv->servos->servos[msg->canal];
+    Trajetoria *t = planejarMovimento(s, sv->trajetorias[msg->canal], &perfil,
+                                      msg->angulo_mgraus / 1000.0, sv->periodo_ns);
+    if (!t) {
+        ack->status = ACK_ERRO_PLANEJAMENTO;
+        sv->rejeitados++;
+        return;
+    }
+
+    // O passo 0 é a posição atual: o passo 1 é escrito agora (ou pelo
+    // tick). Com o grupo parado a grade recomeça neste instante; com outro
+    // movimento em curso, o novo segue na grade existente a partir do
+    // próximo tick. Um comando de posição tira o canal do fluxo
+    pararCanal(sv, msg->canal);
+    if (t->num_ticks > 1) {
+        iniciarMovimento(s, t);
+        s->passo = 1;
+        if (imediato) {
+            avancarServo(s);
+            sv->caixas[msg->canal].escrito_ns = agoraMonotonicoNs();
+        }
+        if (s->atual) {
+            garantirTicks(sv);
+        }
+    }
+
+    ack->latencia_ns = latenciaDesde(chegada);
+    ack->duracao_ms = (uint32_t)((t->num_ticks - 1) * (sv->periodo_ns / 1000000L));
+    sv->comandos++;
+}
+
+// Preenche o cabeçalho do ACK de um comando coordenado, com status ACK_OK
+static void prepararAckCoordenado(const MensagemCoordenada *msg, MensagemAck *ack) {
+    memset(ack, 0, sizeof(*ack));
+    ack->magico = PROTOCOLO_MAGICO;
+    ack->tipo = MSG_ACK;
+    ack->canal = ACK_CANAL_GRUPO;
+    ack->sequencia = msg->sequencia;
+    ack->timestamp_ns = msg->timestamp_ns;
+}
+
+// Prepara o ACK do comando coordenado e confere os eixos; retorna o status
+static int validarCoordenado(Servidor *sv, const MensagemCoordenada *msg, size_t tamanho,
+                             MensagemAck *ack) {
+    unsigned int canais = 0;
+
+    prepararAckCoordenado(msg, ack);
+    if (msg->num_eixos == 0 || msg->num_eixos > COORDENADO_EIXOS_MAX ||
+        tamanho != TAMANHO_COORDENADO(msg->num_eixos)) {
+        ack->status = ACK_COORDENADO_INVALIDO;
+    } else if (msg->perfil != PERFIL_PADRAO_SERVIDOR && msg->perfil > PERFIL_SCURVE) {
+        ack->status = ACK_PERFIL_INVALIDO;
+    }
+    for (int e = 0; e < msg->num_eixos && ack->status == ACK_OK; e++) {
+        const EixoCoordenado *eixo = &msg->eixos[e];
+        int status = conferirAlvo(sv, eixo->canal, eixo->angulo_mgraus);
+
+        // O bit do canal só é usado depois de o canal ser conferido: o
+        // índice vem do pacote
+        if (status == ACK_OK && eixo->canal < sv->servos->num &&
+            (canais & (1u << eixo->canal))) {
+            status = ACK_COORDENADO_INVALIDO;
+        }
+        if (status != ACK_OK) {
+            ack->status = (uint8_t)status;
+            ack->canal = eixo->canal;
+            break;
+        }
+        canais |= 1u << eixo->canal;
+    }
+    if (ack->status != ACK_OK) {
+        sv->rejeitados++;
+    }
+    return ack->status;
+}
+
+// Planeja o comando coordenado; o primeiro passo de todos os eixos sai no
+// avanço do tick em curso. Preenche o ACK
+static void aplicarCoordenado(Servidor *sv, const MensagemCoordenada *msg,
+                              const struct timespec *chegada, MensagemAck *ack) {
+    int indices[SERVOS_MAX];
+    double alvos[SERVOS_MAX];
+    Trajetoria *destinos[SERVOS_MAX];
+
+    if (validarCoordenado(sv, msg, TAMANHO_COORDENADO(msg->num_eixos), ack) != ACK_OK) {
+        return;
+    }
+    PerfilMovimento perfil = perfilDoComando(sv, msg->perfil);
+    for (int e = 0; e < msg->num_eixos; e++) {
+        int canal = msg->eixos[e].canal;
+        indices[e] = canal;
+        alvos[e] = msg->eixos[e].angulo_mgraus / 1000.0;
+        destinos[e] = trajetoriaLivre(&sv->servos->servos[canal], sv->trajetorias[canal]);
+    }
+    int ticks = planejarMovimentoCoordenado(sv->servos, indices, alvos, msg->num_eixos,
+                                            destinos, &perfil, msg->duracao_ms / 1000.0,
+                                            sv->periodo_ns);
+    if (ticks < 0) {
+        ack->status = ACK_ERRO_PLANEJAMENTO;
+        sv->rejeitados++;
+        return;
+    }
+
+    // O passo 0 é a posição atual de cada eixo; o passo 1 de todos sai
+    // neste tick
+    for (int e = 0; e < msg->num_eixos; e++) {
+        Servo *s = &sv->servos->servos[indices[e]];
+        pararCanal(sv, indices[e]);
+        if (ticks > 1) {
+            iniciarMovimento(s, destinos[e]);
+            s->passo = 1;
+        }
+    }
+    ack->latencia_ns = latenciaDesde(chegada);
+    ack->duracao_ms = (uint32_t)((ticks - 1) * (sv->periodo_ns / 1000000L));
+    sv->comandos++;
+}
+
+// Envia o ACK (se o cliente tem endereço)
+static void enviarAck(int fd, const struct sockaddr_storage *origem, socklen_t tamanho,
+                      const MensagemAck *ack) {
+    // Cliente Unix sem endereço próprio não pode receber o ACK
+    if (tamanho > sizeof(sa_family_t)) {
+        sendto(fd, ack, sizeof(*ack), MSG_DONTWAIT, (const struct sockaddr *)origem, tamanho);
+    }
+}
+
+// Registra o resultado de um comando para um canal
+static void registrarComando(Servidor *sv, uint32_t sequencia, int canal,
+                             int32_t angulo_mgraus, const MensagemAck *ack) {
+    RegistroLog reg;
+    reg.tipo = REG_COMANDO;
+    reg.comando.sequencia = sequencia;
+    reg.comando.angulo_mgraus = angulo_mgraus;
+    reg.comando.latencia_ns = ack->latencia_ns;
+    reg.comando.canal = (uint8_t)canal;
+    reg.comando.status = ack->status;
+    registrar(sv->log, &reg);
+}
+
+// Envia o ACK de um comando (se o cliente tem endereço) e o registra
+static void responderComando(Servidor *sv, int fd, const struct sockaddr_storage *origem,
+                             socklen_t tamanho, const MensagemPosicao *msg,
+                             const MensagemAck *ack) {
+    enviarAck(fd, origem, tamanho, ack);
+    registrarComando(sv, msg->sequencia, msg->canal, msg->angulo_mgraus, ack);
+}
+
+// Envia o ACK de um comando coordenado e registra cada eixo (um recusado
+// é registrado uma vez)
+static void responderCoordenado(Servidor *sv, int fd, const struct sockaddr_storage *origem,
+                                socklen_t tamanho, const MensagemCoordenada *msg,
+                                const MensagemAck *ack) {
+    enviarAck(fd, origem, tamanho, ack);
+    if (ack->status != ACK_OK && ack->status != ACK_SUBSTITUIDO) {
+        registrarComando(sv, msg->sequencia, ack->canal, 0, ack);
+        return;
+    }
+    for (int e = 0; e < msg->num_eixos; e++) {
+        registrarComando(sv, msg->sequencia, msg->eixos[e].canal,
+                         msg->eixos[e].angulo_mgraus, ack);
+    }
+}
+
+// 1 se há um comando coordenado guardado com um eixo no canal
+static int coordenadoPendente(const Servidor *sv, int canal) {
+    const CaixaCoordenada *c = &sv->coordenada;
+    for (int e = 0; c->pendente && e < c->msg.num_eixos; e++) {
+        if (c->msg.eixos[e].canal == canal) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 1 se um comando para o canal deve esperar o tick: o canal já tem passo
+// para o tick (trajetória, fluxo ou comando guardado, também coordenado)
+// ou já foi escrito por um comando neste período
+static int canalOcupado(const Servidor *sv, int canal, long long agora) {
+    const CaixaComando *c = &sv->caixas[canal];
+    return sv->servos->servos[canal].atual || sv->fluxo.canais[canal].ativo ||
+           c->pendente || coordenadoPendente(sv, canal) ||
+           agora - c->escrito_ns < sv->periodo_ns;
+}
+
+// Descarta o comando guardado na caixa do canal, com o ACK correspondente
+static void substituirCaixa(Servidor *sv, CaixaComando *c) {
+    MensagemAck ack;
+    prepararAck(&c->msg, &ack);
+    ack.status = ACK_SUBSTITUIDO;
+    responderComando(sv, c->fd, &c->origem, c->tamanho_origem, &c->msg, &ack);
+    c->pendente = 0;
+    c->substituidos++;
+    sv->substituidos++;
+}
+
+// Guarda o comando na caixa do canal; um comando ainda pendente é
+// substituído e recebe o ACK correspondente
+static void guardarComando(Servidor *sv, int fd, const struct sockaddr_storage *origem,
+                           socklen_t tamanho, const MensagemPosicao *msg,
+                           const struct timespec *chegada) {
+    CaixaComando *c = &sv->caixas[msg->canal];
+
+    if (c->pendente) {
+        substituirCaixa(sv, c);
+    }
+    c->pendente = 1;
+    c->msg = *msg;
+    c->chegada = *chegada;
+    c->fd = fd;
+    c->origem = *origem;
+    c->tamanho_origem = tamanho;
+    garantirTicks(sv);
+}
+
+// Guarda o comando coordenado na caixa do grupo. Ele é mais novo que o
+// coordenado pendente e que os comandos guardados dos seus canais, que
+// são substituídos
+static void guardarCoordenado(Servidor *sv, int fd, const struct sockaddr_storage *origem,
+                              socklen_t tamanho, const MensagemCoordenada *msg,
+                              const struct timespec *chegada) {
+    CaixaCoordenada *c = &sv->coordenada;
+
+    if (c->pendente) {
+        MensagemAck ack;
+        prepararAckCoordenado(&c->msg, &ack);
+        ack.status = ACK_SUBSTITUIDO;
+        responderCoordenado(sv, c->fd, &c->origem, c->tamanho_origem, &c->msg, &ack);
+        sv->substituidos++;
+    }
+    for (int e = 0; e < msg->num_eixos; e++) {
+        CaixaComando *caixa = &sv->caixas[msg->eixos[e].canal];
+        if (caixa->pendente) {
+            substituirCaixa(sv, caixa);
+        }
+    }
+    c->pendente = 1;
+    memcpy(&c->msg, msg, TAMANHO_COORDENADO(msg->num_eixos));
+    c->chegada = *chegada;
+    c->fd = fd;
+    c->origem = *origem;
+    c->tamanho_origem = tamanho;
+    garantirTicks(sv);
+}
+
+// Aplica os comandos guardados; o primeiro passo de cada um sai no avanço
+// deste tick, no lugar do passo do movimento anterior. O coordenado vem
+// antes: um comando de canal guardado depois dele é mais novo
+static void aplicarCaixas(Servidor *sv) {
+    CaixaCoordenada *cc = &sv->coordenada;
+    if (cc->pendente) {
+        MensagemAck ack;
+        cc->pendente = 0;
+        aplicarCoordenado(sv, &cc->msg, &cc->chegada, &ack);
+        responderCoordenado(sv, cc->fd, &cc->origem, cc->tamanho_origem, &cc->msg, &ack);
+    }
+    for (int i = 0; i < sv->servos->num; i++) {
+        CaixaComando *c = &sv->caixas[i];
+        if (!c->pendente) {
+            continue;
+        }
+        MensagemAck ack;
+        c->pendente = 0;
+        aplicarComando(sv, &c->msg, &c->chegada, &ack, 0);
+        responderComando(sv, c->fd, &c->origem, c->tamanho_origem, &c->msg, &ack);
+    }
+}
+
+// Escreve o passo de cada servo em movimento (trajetória ou fluxo) e
+// atualiza LEDs e console com o primeiro servo, como na varredura
+static void executarTick(Servidor *sv) {
+    GrupoServos *servos = sv->servos;
+    const PassoTabela *anterior = servos->servos[0].ultimo;
+    int fluxos = 0;
+
+    INSTR_INICIO(t_pwm);
+    aplicarCaixas(sv);
+    avancarServos(servos);
+    long long agora = agoraMonotonicoNs();
+    for (int i = 0; i < servos->num; i++) {
+        int estava_ativo = sv->fluxo.canais[i].ativo;
+        fluxos += aplicarFluxo(&sv->fluxo, i, &servos->servos[i], agora);
+        if (estava_ativo && !sv->fluxo.canais[i].ativo) {
+            registrarFluxo(sv, i, 0);
+        }
+    }
+    INSTR_FIM(FASE_PWM, t_pwm);
+
+    const PassoTabela *p = servos->servos[0].ultimo;
+    unsigned int leds = 0;
+    if (p) {
+        INSTR_INICIO(t_gpio);
+        leds = atualizarIndicador(sv);
+        INSTR_FIM(FASE_GPIO, t_gpio);
+    }
+    if (p != anterior && !sv->silencioso) {
+        INSTR_INICIO(t_reg);
+        registrarPasso(sv->log, p->duty, p->angulo, leds);
+        INSTR_FIM(FASE_REGISTRO, t_reg);
+    }
+    publicarMetricas(sv->metricas, &sv->agendador, 1);
+    gravarPassos(sv->gravador, &sv->agendador, 1);
+    baterSupervisor(sv->supervisor, &sv->agendador);
+
+    // Em malha fechada o controle roda em todos os ticks, mesmo parado; o
+    // prazo de repouso também só corre com ticks
+    fluxos |= servos->realimentacao != NULL || repousoPendente(servos);
+    for (int i = 0; i < servos->num && !fluxos; i++) {
+        fluxos = servos->servos[i].atual != NULL;
+    }
+    if (fluxos) {
+        armarTick(sv);
+    } else {
+        sv->em_movimento = 0;
+    }
+}
+
+// Tick da grade: o timer é de disparo único e é rearmado a cada tick
+static void tratarTimer(Servidor *sv, FonteEvento *fonte) {
+    uint64_t expiracoes;
+
+    if (read(fonte->fd, &expiracoes, sizeof(expiracoes)) != sizeof(expiracoes)) {
+        return;
+    }
+    concluirTick(&sv->agendador);
+    executarTick(sv);
+}
+
+// Guarda os pontos de um lote no buffer de jitter; preenche o ACK
+static void aplicarLote(Servidor *sv, const MensagemLote *lote, size_t tamanho,
+                        MensagemAckLote *ack) {
+    GrupoServos *servos = sv->servos;
+    long long agora = agoraMonotonicoNs();
+    long long folga = -1;
+    unsigned presentes = 0;         // Canais com ponto neste lote
+
+    memset(ack, 0, sizeof(*ack));
+    ack->magico = PROTOCOLO_MAGICO;
+    ack->tipo = MSG_ACK_LOTE;
+    ack->sequencia = lote->sequencia;
+    ack->timestamp_ns = lote->timestamp_ns;
+
+    if (lote->num_pontos == 0 || lote->num_pontos > LOTE_PONTOS_MAX ||
+        tamanho != TAMANHO_LOTE(lote->num_pontos)) {
+        ack->status = ACK_LOTE_INVALIDO;
+        sv->rejeitados++;
+        return;
+    }
+
+    // Um fluxo novo (ou o primeiro depois de todos os canais pararem)
+    // recomeça o mapeamento do relógio do cliente
+    int algum_ativo = 0;
+    for (int i = 0; i < servos->num; i++) {
+        algum_ativo |= sv->fluxo.canais[i].ativo;
+    }
+    if ((lote->flags & LOTE_INICIO) || !algum_ativo) {
+        reiniciarRelogioFluxo(&sv->fluxo);
+    }
+
+    for (int i = 0; i < lote->num_pontos; i++) {
+        const PontoLote *p = &lote->pontos[i];
+        int status = conferirAlvo(sv, p->canal, p->angulo_mgraus);
+
+        if (status == ACK_OK) {
+            int estava_ativo = sv->fluxo.canais[p->canal].ativo;
+            status = inserirPontoFluxo(&sv->fluxo, p->canal, p->instante_ns,
+                                       p->angulo_mgraus, agora);
+            if (!estava_ativo && sv->fluxo.canais[p->canal].ativo) {
+                // O fluxo substitui a trajetória do canal
+                servos->servos[p->canal].atual = NULL;
+                registrarFluxo(sv, p->canal, 1);
+            }
+            presentes |= 1u << p->canal;
+        }
+        if (status == ACK_OK) {
+            ack->aceitos++;
+        } else if (ack->status == ACK_OK) {
+            ack->status = (uint8_t)status;
+        }
+    }
+
+    for (int i = 0; i < servos->num; i++) {
+        if (presentes & (1u << i)) {
+            long long f = folgaFluxo(&sv->fluxo, i, agora);
+            if (folga < 0 || f < folga) folga = f;
+        }
+    }
+    ack->folga_ms = (int32_t)(folga / 1000000);
+    ack->subfluxos = (uint32_t)sv->fluxo.subfluxos;
+    if (ack->aceitos > 0) {
+        garantirTicks(sv);
+    }
+}
+
+// Lê os datagramas pendentes de um socket de comandos e responde cada um
+static void tratarSocket(Servidor *sv, FonteEvento *fonte) {
+    for (int i = 0; i < SERVIDOR_LOTE_RECEPCAO; i++) {
+        union {
+            MensagemPosicao posicao;
+            MensagemLote lote;
+            MensagemCoordenada coordenada;
+        } msg;
+        struct sockaddr_storage origem;
+        char controle[CMSG_SPACE(sizeof(struct timespec))];
+        struct iovec iov = { &msg, sizeof(msg) };
+        struct msghdr mh;
+
+        memset(&mh, 0, sizeof(mh));
+        mh.msg_name = &origem;
+        mh.msg_namelen = sizeof(origem);
+        mh.msg_iov = &iov;
+        mh.msg_iovlen = 1;
+        mh.msg_control = controle;
+        mh.msg_controllen = sizeof(controle);
+
+        ssize_t n = recvmsg(fonte->fd, &mh, 0);
+        if (n < 0) {
+            return;                 // EAGAIN: nada mais pendente
+        }
+
+        // Instante de chegada: carimbo do kernel, ou agora se não houver
+        struct timespec chegada;
+        struct cmsghdr *c = CMSG_FIRSTHDR(&mh);
+        if (c && c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS) {
+            memcpy(&chegada, CMSG_DATA(c), sizeof(chegada));
+        } else {
+            clock_gettime(CLOCK_REALTIME, &chegada);
+        }
+
+        if (n < (ssize_t)sizeof(MensagemPosicao) ||
+            msg.posicao.magico != PROTOCOLO_MAGICO) {
+            sv->rejeitados++;
+            continue;               // Não é do protocolo: sem resposta
+        }
+
+        if (msg.posicao.tipo == MSG_LOTE) {
+            MensagemAckLote ack;
+            aplicarLote(sv, &msg.lote, (size_t)n, &ack);
+            if (mh.msg_namelen > sizeof(sa_family_t)) {
+                sendto(fonte->fd, &ack, sizeof(ack), MSG_DONTWAIT,
+                       (struct sockaddr *)&origem, mh.msg_namelen);
+            }
+            continue;
+        }
+        if (msg.posicao.tipo == MSG_COORDENADO) {
+            // Sempre espera o tick: todos os eixos escrevem no mesmo avanço
+            MensagemAck ack;
+            if (validarCoordenado(sv, &msg.coordenada, (size_t)n, &ack) == ACK_OK) {
+                guardarCoordenado(sv, fonte->fd, &origem, mh.msg_namelen,
+                                  &msg.coordenada, &chegada);
+            } else {
+                responderCoordenado(sv, fonte->fd, &origem, mh.msg_namelen,
+                                    &msg.coordenada, &ack);
+            }
+            continue;
+        }
+        if (msg.posicao.tipo != MSG_POSICAO || n != sizeof(MensagemPosicao)) {
+            sv->rejeitados++;
+            continue;
+        }
+
+        // Canal ocupado: o comando espera o tick na caixa do canal
+        MensagemAck ack;
+        if (validarComando(sv, &msg.posicao, &ack) == ACK_OK &&
+            canalOcupado(sv, msg.posicao.canal, agoraMonotonicoNs())) {
+            guardarComando(sv, fonte->fd, &origem, mh.msg_namelen, &msg.posicao, &chegada);
+            continue;
+        }
+        if (ack.status == ACK_OK) {
+            aplicarComando(sv, &msg.posicao, &chegada, &ack, 1);
+        }
+        responderComando(sv, fonte->fd, &origem, mh.msg_namelen, &msg.posicao, &ack);
+    }
+}
+
+// Aplica a mudança de uma entrada: a emergência desliga o PWM de todos os
+// servos até ser liberada; um fim de curso para o servo dele
+static void aplicarEntrada(Servidor *sv, int indice, int ativo, long long atraso_ns) {
+    const ConfigEntrada *cfg = &sv->entradas->cfg[indice];
+    GrupoServos *servos = sv->servos;
+
+    if (cfg->tipo == ENTRADA_EMERGENCIA) {
+        int emergencia = entradaAtiva(sv->entradas, ENTRADA_EMERGENCIA, -1);
+        if (emergencia && !sv->emergencia) {
+            for (int i = 0; i < servos->num; i++) {
+                pararCanal(sv, i);
+                habilitarPWM(&servos->servos[i].pwm, 0);
+            }
+        } else if (!emergencia && sv->emergencia) {
+            // O duty não mudou enquanto desligado: o servo volta a segurar
+            // a última posição escrita (um servo em repouso continua nele)
+            for (int i = 0; i < servos->num; i++) {
+                if (!servos->servos[i].em_repouso) {
+                    habilitarPWM(&servos->servos[i].pwm, 1);
+                }
+            }
+        }
+        sv->emergencia = emergencia;
+    } else if (ativo && cfg->canal < servos->num) {
+        pararCanal(sv, cfg->canal);
+    }
+
+    // Falhas de cada servo, para o indicador
+    for (int i = 0; i < servos->num; i++) {
+        Servo *s = &servos->servos[i];
+        s->falhas &= ~(unsigned int)(FALHA_EMERGENCIA | FALHA_FIM_DE_CURSO);
+        if (sv->emergencia) {
+            s->falhas |= FALHA_EMERGENCIA;
+        }
+        if (entradaAtiva(sv->entradas, ENTRADA_FIM_MIN, i) ||
+            entradaAtiva(sv->entradas, ENTRADA_FIM_MAX, i)) {
+            s->falhas |= FALHA_FIM_DE_CURSO;
+        }
+    }
+    atualizarIndicador(sv);
+
+    RegistroLog reg;
+    reg.tipo = REG_ENTRADA;
+    reg.entrada.atraso_us = atraso_ns > 0 ? (uint32_t)(atraso_ns / 1000) : 0;
+    reg.entrada.tipo = (uint8_t)cfg->tipo;
+    reg.entrada.pino = (uint8_t)cfg->pino;
+    reg.entrada.canal = (uint8_t)(cfg->canal < 0 ? 0 : cfg->canal);
+    reg.entrada.ativo = (uint8_t)ativo;
+    registrar(sv->log, &reg);
+}
+
+// Lê as bordas pendentes das entradas digitais
+static void tratarEntradas(Servidor *sv, FonteEvento *fonte) {
+    EventoEntrada eventos[ENTRADAS_EVENTOS];
+    int n = lerEventosEntradas(fonte->dados, eventos, ENTRADAS_EVENTOS);
+    long long agora = agoraMonotonicoNs();
+
+    for (int i = 0; i < n; i++) {
+        aplicarEntrada(sv, eventos[i].indice, eventos[i].ativo,
+                       agora - (long long)eventos[i].instante_ns);
+    }
+}
+
+// Sinal de encerramento: o laço termina ao fim deste lote de eventos
+static void tratarEncerramento(Servidor *sv, FonteEvento *fonte) {
+    if (encerramentoPedido(fonte->dados)) {
+        sv->encerrar = 1;
+    }
+}
+
+// Função para acrescentar um descritor ao laço de eventos
+int adicionarFonte(Servidor *sv, int fd,
+                   void (*tratar)(Servidor *sv, FonteEvento *fonte),
+                   void *dados) {
+    if (sv->num_fontes == SERVIDOR_FONTES_MAX) {
+        fprintf(stderr, "Servidor: no máximo %d fontes de eventos\n",
+                SERVIDOR_FONTES_MAX);
+        return -1;
+    }
+
+    FonteEvento *f = &sv->fontes[sv->num_fontes];
+    f->fd = fd;
+    f->tratar = tratar;
+    f->dados = dados;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = f;
+    if (epoll_ctl(sv->fd_epoll, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        perror("epoll_ctl");
+        return -1;
+    }
+    sv->num_fontes++;
+    return 0;
+}
+
+// Função para abrir o servidor de comandos
+int abrirServidor(Servidor *sv, const ConfigServidor *cfg,
+                  GrupoServos *servos, LedsIndicadores *leds,
+                  FilaRegistro *log, const PerfilMovimento *perfil,
+                  long periodo_ns) {
+    memset(sv, 0, sizeof(*sv));
+    sv->servos = servos;
+    sv->leds = leds;
+    sv->log = log;
+    sv->perfil = *perfil;
+    sv->periodo_ns = periodo_ns;
+    sv->fd_udp = sv->fd_unix = -1;
+    iniciarFluxo(&sv->fluxo, cfg->atraso_fluxo_ns, cfg->subfluxo);
+
+    sv->fd_epoll = epoll_create1(EPOLL_CLOEXEC);
+    sv->fd_timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (sv->fd_epoll < 0 || sv->fd_timer < 0) {
+        perror("epoll/timerfd");
+        fecharServidor(sv);
+        return -1;
+    }
+    if (adicionarFonte(sv, sv->fd_timer, tratarTimer, NULL) < 0) {
+        fecharServidor(sv);
+        return -1;
+    }
+
+    if (cfg->porta > 0) {
+        sv->fd_udp = abrirUDP(cfg->porta);
+        if (sv->fd_udp < 0 || adicionarFonte(sv, sv->fd_udp, tratarSocket, NULL) < 0) {
+            fecharServidor(sv);
+            return -1;
+        }
+        printf("Servidor de comandos: UDP porta %d\n", cfg->porta);
+    }
+    if (cfg->caminho) {
+        sv->fd_unix = abrirUnix(cfg->caminho);
+        if (sv->fd_unix < 0 || adicionarFonte(sv, sv->fd_unix, tratarSocket, NULL) < 0) {
+            fecharServidor(sv);
+            return -1;
+        }
+        sv->caminho_unix = cfg->caminho;
+        printf("Servidor de comandos: socket Unix %s\n", cfg->caminho);
+    }
+    return 0;
+}
+
+// Função para acompanhar as entradas digitais
+int adicionarEntradasServidor(Servidor *sv, EntradasDigitais *entradas) {
+    if (adicionarFonte(sv, descritorEntradas(entradas), tratarEntradas, entradas) < 0) {
+        return -1;
+    }
+    sv->entradas = entradas;
+
+    // Uma entrada já acionada na partida não gera borda
+    for (unsigned int i = 0; i < entradas->num; i++) {
+        if ((entradas->ativas >> i) & 1u) {
+            aplicarEntrada(sv, (int)i, 1, 0);
+        }
+    }
+    printf("Servidor de comandos: %u entrada(s) digital(is)\n", entradas->num);
+    return 0;
+}
+
+// Função para acompanhar o sinal de encerramento
+int adicionarEncerramentoServidor(Servidor *sv, Encerramento *encerramento) {
+    return adicionarFonte(sv, descritorEncerramento(encerramento),
+                          tratarEncerramento, encerramento);
+}
+
+// Função para executar o laço de eventos
+void executarServidor(Servidor *sv) {
+    struct epoll_event eventos[SERVIDOR_FONTES_MAX];
+
+    if (sv->servos->realimentacao || repousoPendente(sv->servos)) {
+        garantirTicks(sv);
+    }
+    while (!sv->encerrar) {
+        // Parado, o laço pode esperar sem prazo: o batimento fica suspenso
+        // até o próximo evento
+        if (!sv->em_movimento) {
+            suspenderSupervisor(sv->supervisor);
+        }
+        int n = epoll_wait(sv->fd_epoll, eventos, SERVIDOR_FONTES_MAX, -1);
+        if (n < 0 && errno != EINTR) {
+            perror("epoll_wait");
+            return;
+        }
+        renovarSupervisor(sv->supervisor, 0);
+        for (int i = 0; i < n; i++) {
+            FonteEvento *f = eventos[i].data.ptr;
+            f->tratar(sv, f);
+        }
+        publicarMetricas(sv->metricas, &sv->agendador, 0);
+        gravarPassos(sv->gravador, &sv->agendador, 0);
+    }
+}
+
+// Função para fechar o servidor
+void fecharServidor(Servidor *sv) {
+    if (sv->fd_unix >= 0) {
+        close(sv->fd_unix);
+        if (sv->caminho_unix) {
+            unlink(sv->caminho_unix);
+        }
+    }
+    if (sv->fd_udp >= 0) close(sv->fd_udp);
+    if (sv->fd_timer >= 0) close(sv->fd_timer);
+    if (sv->fd_epoll >= 0) close(sv->fd_epoll);
+    sv->fd_unix = sv->fd_udp = sv->fd_timer = sv->fd_epoll = -1;
+}
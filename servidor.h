@@ -0,0 +1,157 @@
+#ifndef SERVIDOR_H
+#define SERVIDOR_H
+
+#include <sys/socket.h>
+
+#include "protocolo.h"
+#include "servos.h"
+#include "leds.h"
+#include "registro.h"
+#include "agendador.h"
+#include "trajetoria.h"
+#include "fluxo.h"
+#include "entradas.h"
+#include "indicador.h"
+#include "encerramento.h"
+#include "metricas.h"
+#include "supervisor.h"
+#include "gravador.h"
+
+// Número máximo de descritores acompanhados pelo laço de eventos
+#define SERVIDOR_FONTES_MAX 8
+
+// Datagramas lidos por evento antes de voltar ao epoll
+#define SERVIDOR_LOTE_RECEPCAO 16
+
+typedef struct Servidor Servidor;
+
+// Um descritor no laço de eventos e a função chamada quando fica pronto
+typedef struct FonteEvento {
+    int fd;
+    void (*tratar)(Servidor *sv, struct FonteEvento *fonte);
+    void *dados;
+} FonteEvento;
+
+// Comando de posição guardado para o próximo tick (o mais novo vence)
+typedef struct {
+    int pendente;
+    MensagemPosicao msg;
+    struct timespec chegada;
+    int fd;                         // Socket da resposta
+    struct sockaddr_storage origem;
+    socklen_t tamanho_origem;       // <= sizeof(sa_family_t): sem ACK
+    long long escrito_ns;           // Última escrita imediata de um comando
+    unsigned long substituidos;     // Comandos descartados por um mais novo
+} CaixaComando;
+
+// Comando coordenado guardado para o próximo tick (o mais novo vence)
+typedef struct {
+    int pendente;
+    MensagemCoordenada msg;
+    struct timespec chegada;
+    int fd;
+    struct sockaddr_storage origem;
+    socklen_t tamanho_origem;
+} CaixaCoordenada;
+
+// Onde o servidor escuta
+typedef struct {
+    int porta;                      // Porta UDP (0 = sem UDP)
+    const char *caminho;            // Socket Unix (NULL = sem socket Unix)
+    long atraso_fluxo_ns;           // Profundidade do buffer de jitter
+    ModoSubfluxo subfluxo;          // Buffer vazio: manter ou extrapolar
+} ConfigServidor;
+
+// Servidor de comandos.
+// Substitui a varredura fixa: um único laço epoll, na thread de controle,
+// acompanha os sockets de comando e um timerfd que dispara os ticks da
+// grade do agendador. Um comando para um canal parado é planejado e tem o
+// primeiro passo escrito já no tratamento do datagrama, sem esperar o
+// próximo tick; os passos seguintes saem nos ticks. Com o canal ocupado
+// (em movimento, no fluxo ou já escrito por um comando neste período) o
+// comando vai para a caixa do canal, onde o mais novo substitui o
+// anterior, e é aplicado no próximo tick: uma rajada de comandos custa no
+// máximo uma escrita por tick e por canal, e o servo recebe o último
+// alvo. O ACK sai quando o comando é aplicado (ou substituído). Um
+// comando coordenado (vários eixos que chegam juntos) sempre espera o
+// tick, na caixa do grupo, e substitui os comandos guardados dos seus
+// canais; no tick ele é aplicado antes das caixas dos canais e o primeiro
+// passo de todos os eixos sai no mesmo avanço. Lotes de pontos com
+// instante vão para o buffer de jitter (fluxo.h) e são consumidos nos
+// mesmos ticks. Sem
+// movimento em curso o timer fica desarmado e o laço dorme só no epoll.
+// As entradas digitais, quando configuradas, são mais uma fonte do mesmo
+// laço: uma borda de emergência ou de fim de curso é tratada assim que o
+// kernel a entrega, entre dois ticks. O signalfd do encerramento também:
+// um SIGTERM faz o laço terminar depois dos eventos já entregues. Com o
+// exportador, as métricas são publicadas a cada tick e depois de cada
+// lote de eventos, para os contadores de comandos andarem com o servo parado.
+struct Servidor {
+    GrupoServos *servos;
+    LedsIndicadores *leds;
+    FilaRegistro *log;
+    PerfilMovimento perfil;         // Limites usados por todos os comandos
+    long periodo_ns;                // Intervalo entre ticks
+    int silencioso;                 // 1 = não registrar cada passo
+
+    int fd_epoll;
+    int fd_timer;
+    int fd_udp;
+    int fd_unix;
+    const char *caminho_unix;
+    FonteEvento fontes[SERVIDOR_FONTES_MAX];
+    int num_fontes;
+
+    Agendador agendador;
+    int em_movimento;               // 1 = timer armado na grade
+
+    // Duas trajetórias por servo: um comando novo é planejado na que não
+    // está em reprodução e só então substitui a atual
+    Trajetoria trajetorias[SERVOS_MAX][2];
+
+    // Pontos recebidos em lote, reproduzidos no relógio local
+    FluxoSetpoints fluxo;
+
+    EntradasDigitais *entradas;     // NULL = sem entradas
+    int emergencia;                 // 1 = PWM desligado, comandos recusados
+    int encerrar;                   // 1 = sinal de encerramento recebido
+
+    unsigned long comandos;         // Comandos aplicados
+    unsigned long rejeitados;       // Comandos inválidos
+    unsigned long substituidos;     // Comandos descartados nas caixas
+
+    // Último comando de cada canal ocupado, aplicado no próximo tick
+    CaixaComando caixas[SERVOS_MAX];
+    CaixaCoordenada coordenada;     // Último comando coordenado
+
+    Metricas *metricas;             // NULL = sem exportador
+    Gravador *gravador;             // NULL = sem gravação
+    Supervisor *supervisor;         // NULL = sem supervisor
+};
+
+// Abre os sockets, o timerfd e o epoll; retorna 0 ou -1
+int abrirServidor(Servidor *sv, const ConfigServidor *cfg,
+                  GrupoServos *servos, LedsIndicadores *leds,
+                  FilaRegistro *log, const PerfilMovimento *perfil,
+                  long periodo_ns);
+
+// Acrescenta um descritor ao laço de eventos (leitura); retorna 0 ou -1
+int adicionarFonte(Servidor *sv, int fd,
+                   void (*tratar)(Servidor *sv, FonteEvento *fonte),
+                   void *dados);
+
+// Acompanha as entradas digitais no laço de eventos e aplica o estado
+// inicial delas; retorna 0 ou -1
+int adicionarEntradasServidor(Servidor *sv, EntradasDigitais *entradas);
+
+// Termina o laço de eventos quando o sinal de encerramento chegar;
+// retorna 0 ou -1
+int adicionarEncerramentoServidor(Servidor *sv, Encerramento *encerramento);
+
+// Executa o laço de eventos até o encerramento ser pedido
+void executarServidor(Servidor *sv);
+
+// Fecha os descritores e remove o socket Unix
+void fecharServidor(Servidor *sv);
+
+#endif
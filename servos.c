@@ -0,0 +1,296 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "servos.h"
+
+// Função para interpretar a configuração de um servo na linha de comando
+int interpretarConfigServo(ConfigServo *cfg, const char *texto,
+                           int duty_min, int duty_max) {
+    char nome[PWM_TAM_CAMINHO];
+    int canal;
+    int campos;
+
+    cfg->duty_min = duty_min;
+    cfg->duty_max = duty_max;
+    campos = sscanf(texto, "%63[^:]:%d:%d:%d", nome, &canal,
+                    &cfg->duty_min, &cfg->duty_max);
+    if ((campos != 2 && campos != 4) || canal < 0 ||
+        cfg->duty_max <= cfg->duty_min) {
+        fprintf(stderr, "Servo inválido: '%s' (use chip:canal[:min:max])\n", texto);
+        return -1;
+    }
+
+    if (nome[0] == '/') {
+        snprintf(cfg->chip, sizeof(cfg->chip), "%s", nome);
+    } else {
+        snprintf(cfg->chip, sizeof(cfg->chip), PWM_CLASSE "/%.79s", nome);
+    }
+    cfg->canal = canal;
+    return 0;
+}
+
+// Função para abrir todos os servos do grupo
+int abrirServos(GrupoServos *grupo, const Backend *backend,
+                const ConfigServo *cfg, int num, int periodo) {
+    grupo->num = 0;
+    grupo->realimentacao = NULL;
+    grupo->ticks_repouso = 0;
+    grupo->modo_repouso = REPOUSO_DESLIGAR;
+    atomic_init(&grupo->nova, NULL);
+    atomic_init(&grupo->aposentada, NULL);
+
+    if (num < 1 || num > SERVOS_MAX) {
+        fprintf(stderr, "Número de servos inválido: %d\n", num);
+        return -1;
+    }
+    grupo->calibracao = calloc(1, sizeof(*grupo->calibracao));
+    if (!grupo->calibracao) {
+        perror("calloc");
+        return -1;
+    }
+    grupo->calibracao->geracao = grupo->geracoes = 1;
+
+    for (int i = 0; i < num; i++) {
+        Servo *s = &grupo->servos[i];
+        s->cfg = cfg[i];
+        s->atual = NULL;
+        s->ultimo = NULL;
+        s->medido = 0;
+        s->falhas = 0;
+        s->ticks_parado = 0;
+        s->em_repouso = 0;
+        s->repousos = 0;
+        s->cal = &grupo->calibracao->servos[i];
+
+        if (construirTabela(&grupo->calibracao->servos[i].tabela,
+                            cfg[i].duty_min, cfg[i].duty_max) < 0) {
+            fecharServos(grupo);
+            return -1;
+        }
+        if (backend->abrirPWM(&s->pwm, cfg[i].chip, cfg[i].canal, periodo,
+                              cfg[i].duty_min) < 0) {
+            fprintf(stderr, "Erro ao inicializar %s/pwm%d\n",
+                    cfg[i].chip, cfg[i].canal);
+            fecharServos(grupo);
+            return -1;
+        }
+        s->pwm.alternancias = 0;    // Conta só as do repouso em diante
+
+        // O duty da abertura vale como último passo escrito: nenhum laço
+        // encontra um servo sem posição, mesmo antes do primeiro movimento
+        preencherPasso(&s->retido, cfg[i].duty_min, &s->cal->tabela);
+        s->ultimo = &s->retido;
+        grupo->num++;
+    }
+    return 0;
+}
+
+// Gera as trajetórias da varredura a partir da tabela da calibração
+static int gerarVarredura(CalibracaoServo *c, const PerfilMovimento *perfil,
+                          long periodo_tick_ns) {
+    if (gerarTrajetoria(&c->subida, perfil, &c->tabela, 0, ANGULO_MAX,
+                        periodo_tick_ns) < 0 ||
+        gerarTrajetoria(&c->descida, perfil, &c->tabela, ANGULO_MAX, 0,
+                        periodo_tick_ns) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// Função para gerar as trajetórias da varredura de todos os servos
+int planejarVarredura(GrupoServos *grupo, const PerfilMovimento *perfil,
+                      long periodo_tick_ns) {
+    for (int i = 0; i < grupo->num; i++) {
+        if (gerarVarredura(&grupo->calibracao->servos[i], perfil, periodo_tick_ns) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Função para montar uma geração nova das calibrações
+CalibracaoGrupo *montarCalibracao(const GrupoServos *grupo, const ConfigServo *cfg,
+                                  const PerfilMovimento *perfil, long periodo_tick_ns) {
+    CalibracaoGrupo *c = calloc(1, sizeof(*c));
+    if (!c) {
+        perror("calloc");
+        return NULL;
+    }
+    for (int i = 0; i < grupo->num; i++) {
+        if (construirTabela(&c->servos[i].tabela, cfg[i].duty_min, cfg[i].duty_max) < 0 ||
+            gerarVarredura(&c->servos[i], perfil, periodo_tick_ns) < 0) {
+            free(c);
+            return NULL;
+        }
+    }
+    return c;
+}
+
+// Função para publicar uma geração para o laço
+int publicarCalibracao(GrupoServos *grupo, CalibracaoGrupo *nova) {
+    free(atomic_exchange_explicit(&grupo->aposentada, NULL, memory_order_acquire));
+
+    nova->geracao = grupo->geracoes + 1;
+    CalibracaoGrupo *vazio = NULL;
+    if (!atomic_compare_exchange_strong_explicit(&grupo->nova, &vazio, nova,
+                                                 memory_order_release,
+                                                 memory_order_relaxed)) {
+        return -1;
+    }
+    grupo->geracoes = nova->geracao;
+    return 0;
+}
+
+// 1 se o passo está nas tabelas da calibração
+static int passoDaCalibracao(const PassoTabela *p, const CalibracaoServo *c) {
+    return p && (const void *)p >= (const void *)c && (const void *)p < (const void *)(c + 1);
+}
+
+// Função para adotar a geração publicada
+void adotarCalibracaoPublicada(GrupoServos *grupo) {
+    CalibracaoGrupo *antiga = grupo->calibracao;
+
+    // No meio da subida ou da descida a troca espera o fim do movimento:
+    // os passos restantes seriam de outra faixa
+    for (int i = 0; i < grupo->num; i++) {
+        const Servo *s = &grupo->servos[i];
+        if (s->atual == &s->cal->subida || s->atual == &s->cal->descida) {
+            return;
+        }
+    }
+
+    CalibracaoGrupo *nova = atomic_exchange_explicit(&grupo->nova, NULL,
+                                                     memory_order_acquire);
+    for (int i = 0; i < grupo->num; i++) {
+        Servo *s = &grupo->servos[i];
+
+        // O último passo escrito continua valendo como posição atual
+        if (passoDaCalibracao(s->ultimo, s->cal)) {
+            s->retido = *s->ultimo;
+            s->ultimo = &s->retido;
+        }
+        s->cal = &nova->servos[i];
+        s->cfg.duty_min = nova->servos[i].tabela.duty_min;
+        s->cfg.duty_max = nova->servos[i].tabela.duty_max;
+    }
+    grupo->calibracao = nova;
+    atomic_store_explicit(&grupo->aposentada, antiga, memory_order_release);
+}
+
+// Função para planejar um movimento a partir da posição atual
+Trajetoria *planejarMovimento(Servo *servo, Trajetoria par[2],
+                              const PerfilMovimento *perfil, double alvo,
+                              long periodo_ns) {
+    Trajetoria *t = trajetoriaLivre(servo, par);
+
+    if (gerarTrajetoria(t, perfil, &servo->cal->tabela, anguloAtual(servo), alvo,
+                        periodo_ns) < 0) {
+        return NULL;
+    }
+    return t;
+}
+
+// Função para planejar um movimento coordenado
+int planejarMovimentoCoordenado(const GrupoServos *grupo, const int *indices,
+                                const double *alvos, int num, Trajetoria *const *destinos,
+                                const PerfilMovimento *perfil, double duracao,
+                                long periodo_ns) {
+    double base[SERVOS_MAX];        // Duty de partida (ns, + 0,5 para arredondar)
+    double curso[SERVOS_MAX];       // Duty do alvo menos o de partida (ns)
+    int32_t duty[SERVOS_MAX];
+    double fracoes[TRAJETORIA_TICKS_MAX];
+    double maior = 0.0;
+
+    if (num <= 0 || num > SERVOS_MAX) {
+        return -1;
+    }
+    for (int i = 0; i < num; i++) {
+        const Servo *s = &grupo->servos[indices[i]];
+        const TabelaCalibracao *t = &s->cal->tabela;
+        double ns_por_grau = (double)(t->duty_max - t->duty_min) / ANGULO_MAX;
+        double inicio = anguloAtual(s);
+        base[i] = t->duty_min + inicio * ns_por_grau + 0.5;
+        curso[i] = (alvos[i] - inicio) * ns_por_grau;
+        maior = fmax(maior, fabs(alvos[i] - inicio));
+    }
+
+    // O eixo de maior curso define a duração e a curva de todos
+    PerfilMovimento p = *perfil;
+    if (maior > 0.0 && duracao > duracaoMovimento(&p, maior) &&
+        escalarPerfil(&p, maior, duracao) < 0) {
+        return -1;
+    }
+    int n = amostrarPerfil(fracoes, &p, maior, periodo_ns);
+    if (n < 0) {
+        return -1;
+    }
+
+    // Um tick de cada vez para todos os eixos: o laço interno é só
+    // aritmética sobre vetores contíguos, sem desvios
+    for (int k = 0; k < n; k++) {
+        double f = fracoes[k];
+        for (int i = 0; i < num; i++) {
+            duty[i] = (int32_t)(base[i] + curso[i] * f);
+        }
+        for (int i = 0; i < num; i++) {
+            preencherPasso(&destinos[i]->passos[k], duty[i],
+                           &grupo->servos[indices[i]].cal->tabela);
+        }
+    }
+    for (int i = 0; i < num; i++) {
+        destinos[i]->num_ticks = n;
+    }
+    return n;
+}
+
+// Função para escrever um ângulo direto no servo
+int escreverAnguloServo(Servo *servo, PassoTabela par[2], int *indice,
+                        int32_t angulo_mgraus, int acordar) {
+    if (angulo_mgraus < 0) angulo_mgraus = 0;
+    if (angulo_mgraus > ANGULO_MAX * 1000) angulo_mgraus = ANGULO_MAX * 1000;
+
+    int duty = servo->cfg.duty_min +
+               (int)lround((double)angulo_mgraus *
+                           (servo->cfg.duty_max - servo->cfg.duty_min) /
+                           (ANGULO_MAX * 1000.0));
+    // Em repouso a saída está desligada (ou em duty 0): um alvo novo no
+    // mesmo duty ainda precisa ser escrito para o servo voltar a segurar
+    // a posição
+    if (servo->ultimo && servo->ultimo->duty == duty &&
+        !(acordar && servo->em_repouso)) {
+        return 0;
+    }
+
+    PassoTabela *p = &par[*indice];
+    *indice ^= 1;
+    preencherPasso(p, duty, &servo->cal->tabela);
+    escreverPassoServo(servo, p);
+    return 1;
+}
+
+// Função para imprimir as métricas do repouso
+void imprimirRepousoServos(const GrupoServos *grupo) {
+    if (grupo->ticks_repouso == 0) {
+        return;
+    }
+    for (int i = 0; i < grupo->num; i++) {
+        const Servo *s = &grupo->servos[i];
+        printf("Servo %d: %lu repouso(s) | %lu alternância(s) do enable%s\n",
+               i, s->repousos, s->pwm.alternancias,
+               s->em_repouso ? " | em repouso" : "");
+    }
+}
+
+// Função para desativar todos os servos do grupo
+void fecharServos(GrupoServos *grupo) {
+    for (int i = 0; i < grupo->num; i++) {
+        desativarPWM(&grupo->servos[i].pwm);
+    }
+    grupo->num = 0;
+    free(atomic_exchange(&grupo->nova, NULL));
+    free(atomic_exchange(&grupo->aposentada, NULL));
+    free(grupo->calibracao);
+    grupo->calibracao = NULL;
+}
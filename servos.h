@@ -0,0 +1,260 @@
+#ifndef SERVOS_H
+#define SERVOS_H
+
+#include <stdatomic.h>
+
+#include "pwm.h"
+#include "tabela.h"
+#include "trajetoria.h"
+#include "backend.h"
+
+// Número máximo de servos controlados pelo mesmo laço
+#define SERVOS_MAX 8
+
+// Diretório padrão dos pwmchips no sysfs
+#define PWM_CLASSE "/sys/class/pwm"
+
+// Falhas que o indicador mostra (bits de Servo.falhas)
+#define FALHA_EMERGENCIA 0x01
+#define FALHA_FIM_DE_CURSO 0x02
+#define FALHA_DESVIO 0x04
+
+// O que o repouso faz com a saída de um servo parado
+typedef enum {
+    REPOUSO_DESLIGAR,       // enable = 0: sem pulsos e sem corrente de retenção
+    REPOUSO_ZERAR,          // duty = 0 com a saída ligada (mantém a fase do quadro)
+} ModoRepouso;
+
+// Configuração de um canal: onde está e qual a sua calibração
+typedef struct {
+    char chip[PWM_TAM_CAMINHO];     // Ex.: /sys/class/pwm/pwmchip0
+    int canal;                      // Índice pwmN dentro do chip
+    int duty_min;                   // Duty em 0° (ns)
+    int duty_max;                   // Duty em 180° (ns)
+} ConfigServo;
+
+// Tabelas derivadas da calibração de um servo
+typedef struct {
+    TabelaCalibracao tabela;
+    Trajetoria subida;              // 0° -> 180°
+    Trajetoria descida;             // 180° -> 0°
+} CalibracaoServo;
+
+// Uma geração das calibrações do grupo, montada inteira fora do laço
+typedef struct {
+    unsigned long geracao;
+    CalibracaoServo servos[SERVOS_MAX];
+} CalibracaoGrupo;
+
+// Um servo: canal PWM aberto, calibração e trajetórias da varredura
+typedef struct {
+    ConfigServo cfg;
+    CanalPWM pwm;
+    const CalibracaoServo *cal;     // Na geração em uso pelo laço
+    const Trajetoria *atual;        // Trajetória em reprodução (NULL = parado)
+    int passo;                      // Próximo passo de atual
+    const PassoTabela *ultimo;      // Último passo escrito no canal (o da abertura
+                                    // antes do primeiro movimento)
+    PassoTabela retido;             // Cópia do último passo ao trocar de geração
+    double angulo_medido;           // Posição lida pela realimentação (graus)
+    int medido;                     // 1 = angulo_medido é válido
+    unsigned int falhas;            // FALHA_* ativas
+    int ticks_parado;               // Ticks desde a última escrita
+    int em_repouso;                 // 1 = saída em repouso (ver GrupoServos)
+    unsigned long repousos;         // Vezes que o prazo de repouso venceu
+} Servo;
+
+struct Realimentacao;
+
+// Todos os servos dirigidos pelo mesmo tick do agendador.
+// Com ticks_repouso, um servo que passa esse número de ticks sem escrita
+// entra em repouso: sai um único enable = 0 (ou duty = 0) e o servo deixa
+// de segurar a posição. A próxima escrita o tira do repouso antes do passo
+// com um único enable = 1 (no modo zerar, o próprio passo basta). O estado
+// de enable fica em cache no CanalPWM, então nada é escrito duas vezes.
+// As calibrações são trocadas como o indicador: uma geração nova é
+// montada fora do laço e publicada em nova; o laço a adota no início de
+// um tick em que nenhum servo está no meio da varredura, troca os
+// ponteiros e devolve a antiga em aposentada, para quem publicou liberar.
+typedef struct {
+    Servo servos[SERVOS_MAX];
+    int num;
+    struct Realimentacao *realimentacao;    // NULL = malha aberta
+    int ticks_repouso;                      // 0 = sem repouso
+    ModoRepouso modo_repouso;
+    CalibracaoGrupo *calibracao;            // Geração em uso (só o laço troca)
+    _Atomic(CalibracaoGrupo *) nova;        // Publicada, ainda não adotada
+    _Atomic(CalibracaoGrupo *) aposentada;  // Já sem uso pelo laço
+    unsigned long geracoes;                 // Última publicada (só quem publica)
+} GrupoServos;
+
+// Interpreta "chip:canal[:duty_min:duty_max]" (chip pode ser pwmchipN ou
+// um caminho absoluto); retorna 0 ou -1 se o texto for inválido
+int interpretarConfigServo(ConfigServo *cfg, const char *texto,
+                           int duty_min, int duty_max);
+
+// Abre os canais no backend, monta as calibrações e deixa todos na
+// posição 0°
+int abrirServos(GrupoServos *grupo, const Backend *backend,
+                const ConfigServo *cfg, int num, int periodo);
+
+// Gera as trajetórias de subida e descida de cada servo com o perfil
+int planejarVarredura(GrupoServos *grupo, const PerfilMovimento *perfil,
+                      long periodo_tick_ns);
+
+// Monta uma geração nova para os servos do grupo com as faixas de cfg
+// (um ConfigServo por servo, na mesma ordem) e as trajetórias da
+// varredura. Roda fora do laço; retorna a geração ou NULL
+CalibracaoGrupo *montarCalibracao(const GrupoServos *grupo, const ConfigServo *cfg,
+                                  const PerfilMovimento *perfil, long periodo_tick_ns);
+
+// Publica a geração para o laço adotar e libera a que ele já aposentou.
+// Retorna 0, ou -1 se a publicação anterior ainda não foi adotada (a
+// geração continua de quem chamou)
+int publicarCalibracao(GrupoServos *grupo, CalibracaoGrupo *nova);
+
+// Adota a geração publicada (ver adotarCalibracao)
+void adotarCalibracaoPublicada(GrupoServos *grupo);
+
+// Chamada pelo laço no início do tick: sem publicação é uma única leitura
+static inline void adotarCalibracao(GrupoServos *grupo) {
+    if (atomic_load_explicit(&grupo->nova, memory_order_relaxed)) {
+        adotarCalibracaoPublicada(grupo);
+    }
+}
+
+// Inicia a reprodução de uma trajetória no servo
+static inline void iniciarMovimento(Servo *servo, const Trajetoria *traj) {
+    servo->atual = traj;
+    servo->passo = 0;
+}
+
+// Escreve um passo no servo, tirando a saída do repouso antes
+static inline void escreverPassoServo(Servo *s, const PassoTabela *p) {
+    if (s->em_repouso) {
+        habilitarPWM(&s->pwm, 1);
+        s->em_repouso = 0;
+    }
+    setPWMDutyCycleTexto(&s->pwm, p->duty, p->texto, p->len);
+    s->ultimo = p;
+    s->ticks_parado = 0;
+}
+
+// Conta um tick sem escrita no servo e o põe em repouso quando o prazo
+// do grupo vence
+static inline void contarRepouso(GrupoServos *grupo, Servo *s) {
+    if (grupo->ticks_repouso == 0 || s->em_repouso ||
+        ++s->ticks_parado < grupo->ticks_repouso) {
+        return;
+    }
+    if (grupo->modo_repouso == REPOUSO_ZERAR) {
+        setPWMDutyCycle(&s->pwm, 0);
+    } else {
+        habilitarPWM(&s->pwm, 0);
+    }
+    s->em_repouso = 1;
+    s->repousos++;
+}
+
+// 1 se algum servo do grupo ainda vai entrar em repouso
+static inline int repousoPendente(const GrupoServos *grupo) {
+    for (int i = 0; i < grupo->num && grupo->ticks_repouso; i++) {
+        if (!grupo->servos[i].em_repouso) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Escreve o próximo passo do servo, se estiver em movimento; retorna 1 se
+// escreveu
+static inline int avancarServo(Servo *s) {
+    if (!s->atual) {
+        return 0;
+    }
+    escreverPassoServo(s, &s->atual->passos[s->passo]);
+    if (++s->passo == s->atual->num_ticks) {
+        s->atual = NULL;
+    }
+    return 1;
+}
+
+// Tick em malha fechada (realimentacao.c)
+int avancarServosRealimentados(GrupoServos *grupo);
+
+// Escreve o próximo passo de cada servo em movimento, em sequência, no
+// início do tick; retorna quantos servos estavam em movimento. Os parados
+// contam o prazo de repouso. Com realimentação, todos os servos são
+// corrigidos pela posição medida, em movimento ou não. Uma calibração
+// publicada é adotada antes
+static inline int avancarServos(GrupoServos *grupo) {
+    adotarCalibracao(grupo);
+    if (grupo->realimentacao) {
+        return avancarServosRealimentados(grupo);
+    }
+    int escritos = 0;
+    for (int i = 0; i < grupo->num; i++) {
+        Servo *s = &grupo->servos[i];
+        if (avancarServo(s)) {
+            escritos++;
+        } else {
+            contarRepouso(grupo, s);
+        }
+    }
+    return escritos;
+}
+
+// Ângulo atual do servo (graus, com fração): o medido, com realimentação,
+// ou o do último duty escrito
+static inline double anguloAtual(const Servo *s) {
+    if (s->medido) {
+        return s->angulo_medido;
+    }
+    int duty = s->ultimo ? s->ultimo->duty : s->cfg.duty_min;
+    return (double)(duty - s->cfg.duty_min) * ANGULO_MAX /
+           (s->cfg.duty_max - s->cfg.duty_min);
+}
+
+// Das duas trajetórias de par, a que não contém o último passo escrito:
+// a outra pode estar em reprodução e continua válida até ser substituída
+static inline Trajetoria *trajetoriaLivre(const Servo *servo, Trajetoria par[2]) {
+    int em_primeira = servo->ultimo >= par[0].passos &&
+                      servo->ultimo < par[0].passos + TRAJETORIA_TICKS_MAX;
+    return &par[em_primeira];
+}
+
+// Planeja um movimento da posição atual até alvo (graus) na trajetória
+// livre de par (ver trajetoriaLivre). Retorna a trajetória ou NULL
+Trajetoria *planejarMovimento(Servo *servo, Trajetoria par[2],
+                              const PerfilMovimento *perfil, double alvo,
+                              long periodo_ns);
+
+// Planeja um movimento coordenado: o servo indices[i] vai da posição
+// atual até alvos[i] (graus) em destinos[i], e todos partem e chegam no
+// mesmo tick. O eixo de maior curso segue o perfil (esticado até duracao
+// segundos, se for mais longa que o mínimo) e os demais percorrem a mesma
+// curva normalizada na escala do próprio curso, então nenhum passa dos
+// limites do perfil e o grupo anda em linha reta no espaço dos ângulos.
+// Os passos de cada tick são calculados para todos os eixos de uma vez,
+// sobre vetores por eixo. Retorna o número de ticks (igual em todos) ou -1
+int planejarMovimentoCoordenado(const GrupoServos *grupo, const int *indices,
+                                const double *alvos, int num, Trajetoria *const *destinos,
+                                const PerfilMovimento *perfil, double duracao,
+                                long periodo_ns);
+
+// Escreve um ângulo (milésimos de grau) direto no servo, sem trajetória.
+// O passo é montado em par[*indice] e os dois se alternam, como em
+// planejarMovimento(). acordar = 1 quando o ângulo é um alvo novo: tira a
+// saída do repouso mesmo com o duty igual; quem repete o mesmo ângulo a
+// cada tick passa 0, e o prazo de repouso continua valendo. Retorna 1 se
+// escreveu ou 0 se o duty não mudou
+int escreverAnguloServo(Servo *servo, PassoTabela par[2], int *indice,
+                        int32_t angulo_mgraus, int acordar);
+
+// Imprime por servo quantas vezes o repouso venceu e as escritas em enable
+void imprimirRepousoServos(const GrupoServos *grupo);
+
+// Desativa e libera todos os canais
+void fecharServos(GrupoServos *grupo);
+
+#endif
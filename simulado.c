@@ -0,0 +1,220 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "simulado.h"
+#include "tabela.h"
+
+#define NS_POR_S 1000000000LL
+
+// Estado de um canal PWM simulado
+typedef struct {
+    int habilitado;
+    int duty;
+    int duty_min_visto;
+    int duty_max_visto;
+    int maior_salto;                // Maior |duty - duty anterior|
+    unsigned long escritas;
+    unsigned long escritas_desligado;
+    long long ultima_escrita_ns;
+    long long intervalo_min_ns;
+    long long intervalo_max_ns;
+} CanalSimulado;
+
+static struct {
+    long long agora_ns;             // Relógio virtual
+    long latencia_escrita_ns;
+    CanalSimulado canais[SIM_CANAIS_MAX];
+    int num_canais;
+    unsigned int leds;
+    unsigned long transicoes_leds;
+    unsigned long padroes_leds;     // Padrões entregues às saídas temporizadas
+    unsigned long leds_simultaneos; // LED1 e LED2 acesos juntos
+    struct timespec inicio_real;
+} sim;
+
+static long long paraNs(const struct timespec *t) {
+    return (long long)t->tv_sec * NS_POR_S + t->tv_nsec;
+}
+
+static void deNs(long long ns, struct timespec *t) {
+    t->tv_sec = (time_t)(ns / NS_POR_S);
+    t->tv_nsec = (long)(ns % NS_POR_S);
+}
+
+// ===== Relógio virtual =====
+
+static void agoraSimulado(const Relogio *r, struct timespec *t) {
+    (void)r;
+    deNs(sim.agora_ns, t);
+}
+
+static void dormirSimulado(const Relogio *r, const struct timespec *t) {
+    (void)r;
+    long long alvo = paraNs(t);
+    if (alvo > sim.agora_ns) {
+        sim.agora_ns = alvo;
+    }
+}
+
+static const Relogio RELOGIO_SIMULADO = { agoraSimulado, dormirSimulado, NULL };
+
+// ===== PWM =====
+
+static int escreverDutySimulado(CanalPWM *pwm, int duty, const char *texto, int len) {
+    CanalSimulado *c = pwm->privado;
+    (void)texto;
+    (void)len;
+
+    if (c->escritas > 0) {
+        int salto = abs(duty - c->duty);
+        long long intervalo = sim.agora_ns - c->ultima_escrita_ns;
+        if (salto > c->maior_salto) c->maior_salto = salto;
+        if (intervalo < c->intervalo_min_ns) c->intervalo_min_ns = intervalo;
+        if (intervalo > c->intervalo_max_ns) c->intervalo_max_ns = intervalo;
+    }
+    if (!c->habilitado) c->escritas_desligado++;
+    if (duty < c->duty_min_visto) c->duty_min_visto = duty;
+    if (duty > c->duty_max_visto) c->duty_max_visto = duty;
+
+    c->duty = duty;
+    c->escritas++;
+    c->ultima_escrita_ns = sim.agora_ns;
+    sim.agora_ns += sim.latencia_escrita_ns;
+    return 0;
+}
+
+static int habilitarSimulado(CanalPWM *pwm, int habilitado) {
+    CanalSimulado *c = pwm->privado;
+    c->habilitado = habilitado != 0;
+    if (habilitado) {
+        deNs(sim.agora_ns, &pwm->habilitado_em);
+    }
+    return 0;
+}
+
+static void fecharSimulado(CanalPWM *pwm) {
+    habilitarSimulado(pwm, 0);
+}
+
+static const OperacoesPWM OPERACOES_PWM_SIMULADO = {
+    escreverDutySimulado,
+    habilitarSimulado,
+    fecharSimulado,
+};
+
+static int abrirPWMSimulado(CanalPWM *pwm, const char *chip, int canal,
+                            int periodo, int duty_inicial) {
+    (void)periodo;
+
+    if (sim.num_canais == SIM_CANAIS_MAX) {
+        fprintf(stderr, "Simulação: no máximo %d canais\n", SIM_CANAIS_MAX);
+        return -1;
+    }
+    if (sim.num_canais == 0) {
+        clock_gettime(CLOCK_MONOTONIC, &sim.inicio_real);
+    }
+
+    CanalSimulado *c = &sim.canais[sim.num_canais++];
+    memset(c, 0, sizeof(*c));
+    c->duty_min_visto = INT_MAX;
+    c->duty_max_visto = INT_MIN;
+    c->intervalo_min_ns = LLONG_MAX;
+
+    memset(pwm, 0, sizeof(*pwm));
+    snprintf(pwm->chip, sizeof(pwm->chip), "%s", chip);
+    pwm->canal = canal;
+    pwm->fd_periodo = pwm->fd_duty = pwm->fd_enable = -1;
+    pwm->ops = &OPERACOES_PWM_SIMULADO;
+    pwm->privado = c;
+
+    setPWMDutyCycle(pwm, duty_inicial);
+    habilitarPWM(pwm, 1);
+    return 0;
+}
+
+// ===== LEDs =====
+
+static int escreverLedsSimulado(LedsIndicadores *leds, unsigned int mascara) {
+    (void)leds;
+    if ((mascara & (LED1_BIT | LED2_BIT)) == (LED1_BIT | LED2_BIT)) {
+        sim.leds_simultaneos++;
+    }
+    sim.leds = mascara;
+    sim.transicoes_leds++;
+    return 0;
+}
+
+static int padraoLedsSimulado(LedsIndicadores *leds, unsigned int linha,
+                              const PadraoLed *p) {
+    (void)leds;
+    (void)linha;
+    (void)p;
+    sim.padroes_leds++;
+    return 0;
+}
+
+static void fecharLedsSimulado(LedsIndicadores *leds) {
+    (void)leds;
+}
+
+static const OperacoesLeds OPERACOES_LEDS_SIMULADO = {
+    escreverLedsSimulado,
+    padraoLedsSimulado,
+    fecharLedsSimulado,
+};
+
+static int abrirLedsSimulado(LedsIndicadores *leds, const char *chip,
+                             const ConfigSaidaLed *saidas, unsigned int num) {
+    (void)chip;
+    memset(leds, 0, sizeof(*leds));
+    if (num == 0 || num > LEDS_MAX) {
+        fprintf(stderr, "Número de LEDs inválido: %u\n", num);
+        return -1;
+    }
+    for (unsigned int i = 0; i < num; i++) {
+        leds->saidas[i].cfg = saidas[i];
+        leds->num_gpio += saidas[i].tipo == SAIDA_GPIO;
+    }
+    leds->ops = &OPERACOES_LEDS_SIMULADO;
+    leds->num = num;
+    return 0;
+}
+
+// ===== Configuração e relatório =====
+
+// Função para configurar a latência virtual das escritas
+void configurarSimulado(long latencia_escrita_ns) {
+    sim.latencia_escrita_ns = latencia_escrita_ns;
+}
+
+// Função para imprimir o relatório da simulação
+void imprimirRelatorioSimulado(void) {
+    struct timespec fim_real;
+    clock_gettime(CLOCK_MONOTONIC, &fim_real);
+
+    printf("\n===== Simulação =====\n");
+    printf("Tempo virtual: %.3fs | tempo real: %.3fs\n",
+           sim.agora_ns / 1e9,
+           (paraNs(&fim_real) - paraNs(&sim.inicio_real)) / 1e9);
+    for (int i = 0; i < sim.num_canais; i++) {
+        const CanalSimulado *c = &sim.canais[i];
+        printf("Canal %d: %lu escritas | duty %d..%d ns | maior salto %d ns | "
+               "intervalo %.3f..%.3f ms | %lu com saída desligada\n",
+               i, c->escritas, c->duty_min_visto, c->duty_max_visto,
+               c->maior_salto,
+               c->escritas > 1 ? c->intervalo_min_ns / 1e6 : 0.0,
+               c->intervalo_max_ns / 1e6, c->escritas_desligado);
+    }
+    printf("LEDs: %lu transições | %lu padrões temporizados | %lu com LED1 e LED2 acesos\n",
+           sim.transicoes_leds, sim.padroes_leds, sim.leds_simultaneos);
+}
+
+const Backend BACKEND_SIMULADO = {
+    "simulado",
+    abrirPWMSimulado,
+    abrirLedsSimulado,
+    &RELOGIO_SIMULADO,
+    imprimirRelatorioSimulado,
+};
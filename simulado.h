@@ -0,0 +1,22 @@
+#ifndef SIMULADO_H
+#define SIMULADO_H
+
+#include "backend.h"
+
+// Número máximo de canais PWM simulados
+#define SIM_CANAIS_MAX 16
+
+// Backend simulado.
+// Canais PWM e LEDs existem só em memória e o relógio é virtual: esperar
+// um deadline apenas avança o tempo até ele, então milhares de ciclos de
+// varredura rodam em milissegundos. Cada escrita é verificada (saltos de
+// duty, intervalo entre escritas, escrita com a saída desligada, LEDs
+// acesos ao mesmo tempo) e o resumo sai em imprimirRelatorioSimulado().
+
+// Custo virtual de cada escrita no PWM, para exercitar overruns
+void configurarSimulado(long latencia_escrita_ns);
+
+// Imprime as estatísticas acumuladas pela simulação
+void imprimirRelatorioSimulado(void);
+
+#endif
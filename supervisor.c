@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <linux/watchdog.h>
+
+#include "supervisor.h"
+
+// Função para interpretar os limites da escalada
+int interpretarEscalada(const char *texto, int limites[3]) {
+    int v[3];
+    char resto;
+
+    if (sscanf(texto, "%d:%d:%d%c", &v[0], &v[1], &v[2], &resto) != 3 ||
+        v[0] < 0 || v[1] < 0 || v[2] < 0) {
+        fprintf(stderr, "Escalada inválida: '%s' (use AVISO:DEGRADAR:PARQUE)\n", texto);
+        return -1;
+    }
+    // Os níveis ligados sobem em ordem
+    int anterior = 0;
+    for (int i = 0; i < 3; i++) {
+        if (v[i] == 0) {
+            continue;
+        }
+        if (v[i] <= anterior) {
+            fprintf(stderr, "Escalada inválida: '%s' (os limites devem crescer)\n", texto);
+            return -1;
+        }
+        anterior = v[i];
+    }
+    memcpy(limites, v, sizeof(v));
+    return 0;
+}
+
+// Manda uma linha do protocolo de notificação do systemd
+static void notificar(Supervisor *s, const char *texto) {
+    if (s->fd_notificacao >= 0) {
+        sendto(s->fd_notificacao, texto, strlen(texto), MSG_NOSIGNAL,
+               (const struct sockaddr *)&s->endereco, s->tamanho_endereco);
+    }
+}
+
+// Abre o socket do NOTIFY_SOCKET, se o processo roda sob o systemd, e lê
+// o intervalo do WatchdogSec (só se o WATCHDOG_PID, quando presente, for
+// o deste processo)
+static void abrirNotificacao(Supervisor *s) {
+    const char *caminho = getenv("NOTIFY_SOCKET");
+    size_t tamanho = caminho ? strlen(caminho) : 0;
+
+    if (tamanho == 0 || (caminho[0] != '/' && caminho[0] != '@') ||
+        tamanho >= sizeof(s->endereco.sun_path)) {
+        return;
+    }
+    s->endereco.sun_family = AF_UNIX;
+    memcpy(s->endereco.sun_path, caminho, tamanho);
+    if (caminho[0] == '@') {
+        s->endereco.sun_path[0] = '\0';     // Socket abstrato
+    }
+    s->tamanho_endereco = (socklen_t)(offsetof(struct sockaddr_un, sun_path) + tamanho);
+    s->fd_notificacao = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (s->fd_notificacao < 0) {
+        perror("NOTIFY_SOCKET");
+        return;
+    }
+
+    const char *usec = getenv("WATCHDOG_USEC");
+    const char *pid = getenv("WATCHDOG_PID");
+    if (usec && (!pid || atol(pid) == (long)getpid())) {
+        long long intervalo = atoll(usec);
+        if (intervalo > 0) {
+            s->intervalo_systemd_ns = intervalo * 1000LL / 2;
+        }
+    }
+}
+
+// Abre (e com isso arma) o watchdog de hardware; retorna 0 ou -1
+static int abrirWatchdog(Supervisor *s, const char *dispositivo) {
+    s->fd_watchdog = open(dispositivo, O_WRONLY | O_CLOEXEC);
+    if (s->fd_watchdog < 0) {
+        perror(dispositivo);
+        return -1;
+    }
+    ioctl(s->fd_watchdog, WDIOC_KEEPALIVE, 0);
+    if (ioctl(s->fd_watchdog, WDIOC_GETTIMEOUT, &s->timeout_watchdog) < 0) {
+        s->timeout_watchdog = 0;
+    }
+    return 0;
+}
+
+// Thread do supervisor: confere a idade do batimento e, enquanto ele é
+// recente, alimenta o watchdog e o systemd
+static void *vigiarLaco(void *arg) {
+    Supervisor *s = arg;
+    struct timespec intervalo = { 0, SUPERVISOR_INTERVALO_MS * 1000000L };
+    long long ultimo_systemd = 0;
+
+    while (atomic_load_explicit(&s->ativo, memory_order_relaxed)) {
+        long long batimento = atomic_load_explicit(&s->batimento_ns, memory_order_relaxed);
+        long long agora = agoraSupervisor();
+        int vivo = batimento == 0 || agora - batimento < s->prazo_ns;
+
+        if (!vivo && !s->travado) {
+            s->travado = 1;
+            s->travamentos++;
+            fprintf(stderr, "Supervisor: laço de controle sem batimento há %lld ms%s\n",
+                    (agora - batimento) / 1000000,
+                    s->fd_watchdog >= 0 || s->intervalo_systemd_ns
+                        ? "; watchdog deixa de ser alimentado" : "");
+            notificar(s, "STATUS=Laço de controle travado");
+        } else if (vivo && s->travado) {
+            s->travado = 0;
+            fprintf(stderr, "Supervisor: laço de controle batendo de novo\n");
+            notificar(s, "STATUS=Em controle");
+        }
+
+        if (vivo) {
+            if (s->fd_watchdog >= 0) {
+                ioctl(s->fd_watchdog, WDIOC_KEEPALIVE, 0);
+            }
+            if (s->intervalo_systemd_ns && agora - ultimo_systemd >= s->intervalo_systemd_ns) {
+                notificar(s, "WATCHDOG=1");
+                ultimo_systemd = agora;
+            }
+        }
+        nanosleep(&intervalo, NULL);
+    }
+    return NULL;
+}
+
+// Função para iniciar o supervisor
+int iniciarSupervisor(Supervisor *s, const ConfigSupervisor *cfg,
+                      FilaRegistro *log, Metricas *metricas) {
+    memset(s, 0, sizeof(*s));
+    s->fd_watchdog = -1;
+    s->fd_notificacao = -1;
+    s->log = log;
+    s->metricas = metricas;
+    memcpy(s->limites, cfg->limites, sizeof(s->limites));
+    atomic_init(&s->batimento_ns, 0);
+    atomic_init(&s->ativo, 0);
+
+    if (cfg->prazo_ms <= 0) {
+        fprintf(stderr, "Prazo do batimento inválido: %ld ms\n", cfg->prazo_ms);
+        return -1;
+    }
+    s->prazo_ns = cfg->prazo_ms * 1000000LL;
+    if (cfg->watchdog && abrirWatchdog(s, cfg->watchdog) < 0) {
+        return -1;
+    }
+    abrirNotificacao(s);
+
+    atomic_store(&s->ativo, 1);
+    if (pthread_create(&s->thread, NULL, vigiarLaco, s) != 0) {
+        atomic_store(&s->ativo, 0);
+        fprintf(stderr, "Erro ao criar a thread do supervisor\n");
+        fecharSupervisor(s);
+        return -1;
+    }
+
+    printf("Supervisor: prazo do batimento %ld ms | escalada %d:%d:%d\n",
+           cfg->prazo_ms, s->limites[0], s->limites[1], s->limites[2]);
+    if (s->fd_watchdog >= 0) {
+        printf("Watchdog: %s (timeout %d s)\n", cfg->watchdog, s->timeout_watchdog);
+    }
+    if (s->intervalo_systemd_ns) {
+        printf("systemd: WATCHDOG=1 a cada %lld ms\n", s->intervalo_systemd_ns / 1000000);
+    }
+    notificar(s, "READY=1\nSTATUS=Em controle");
+    return 0;
+}
+
+// Sobe ou desce a escalada e aplica o que o nível pede
+static void mudarNivel(Supervisor *s, NivelSupervisor nivel) {
+    int degradado = nivel >= SUPERVISOR_DEGRADADO;
+
+    if (degradado && s->nivel < SUPERVISOR_DEGRADADO) {
+        s->degradacoes++;
+    }
+    s->log->suprimir_passos = degradado;
+    if (s->metricas) {
+        s->metricas->divisor = degradado ? SUPERVISOR_DIVISOR_METRICAS : 1;
+    }
+    s->nivel = nivel;
+
+    RegistroLog reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.tipo = REG_SUPERVISOR;
+    reg.supervisor.perdas = (uint32_t)s->perdas_seguidas;
+    reg.supervisor.nivel = (uint8_t)nivel;
+    registrar(s->log, &reg);
+
+    // O encerramento chega ao laço pelo signalfd, como um sinal externo
+    if (nivel == SUPERVISOR_PARQUE) {
+        kill(getpid(), SIGTERM);
+    }
+}
+
+// Função para bater a cada tick
+void baterSupervisorTick(Supervisor *s, const Agendador *ag) {
+    atomic_store_explicit(&s->batimento_ns, agoraSupervisor(), memory_order_relaxed);
+
+    // A grade do servidor é reiniciada a cada movimento
+    if (ag->overruns_total < s->overruns_vistos) {
+        s->overruns_vistos = 0;
+    }
+    unsigned long perdidos = ag->overruns_total - s->overruns_vistos;
+    s->overruns_vistos = ag->overruns_total;
+
+    if (perdidos == 0) {
+        s->perdas_seguidas = 0;
+        if (s->nivel != SUPERVISOR_NORMAL && s->nivel != SUPERVISOR_PARQUE &&
+            ++s->ticks_em_dia >= SUPERVISOR_TICKS_RECUPERACAO) {
+            mudarNivel(s, SUPERVISOR_NORMAL);
+        }
+        return;
+    }
+    s->ticks_em_dia = 0;
+    s->perdas_seguidas += perdidos;
+    if (s->perdas_seguidas > s->pior_sequencia) {
+        s->pior_sequencia = s->perdas_seguidas;
+    }
+    for (int n = SUPERVISOR_PARQUE; n > (int)s->nivel; n--) {
+        if (s->limites[n - 1] && s->perdas_seguidas >= (unsigned long)s->limites[n - 1]) {
+            mudarNivel(s, (NivelSupervisor)n);
+            break;
+        }
+    }
+}
+
+// Função para encerrar o supervisor
+void fecharSupervisor(Supervisor *s) {
+    if (atomic_exchange(&s->ativo, 0)) {
+        pthread_join(s->thread, NULL);
+    }
+    if (s->fd_watchdog >= 0) {
+        // Fechamento mágico: sem ele (ou com nowayout no driver) a placa
+        // reinicia quando o timeout vencer
+        if (write(s->fd_watchdog, "V", 1) != 1) {
+            perror("watchdog");
+        }
+        close(s->fd_watchdog);
+        s->fd_watchdog = -1;
+    }
+    if (s->fd_notificacao >= 0) {
+        notificar(s, "STOPPING=1");
+        close(s->fd_notificacao);
+        s->fd_notificacao = -1;
+    }
+}
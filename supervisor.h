@@ -0,0 +1,142 @@
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include <time.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "agendador.h"
+#include "registro.h"
+#include "metricas.h"
+
+// Dispositivo padrão do watchdog de hardware
+#define SUPERVISOR_WATCHDOG_PADRAO "/dev/watchdog"
+
+// Prazo padrão sem batimento até o laço ser dado como travado (ms)
+#define SUPERVISOR_PRAZO_MS_PADRAO 500
+
+// Intervalo com que a thread do supervisor confere o batimento e alimenta
+// o watchdog (ms)
+#define SUPERVISOR_INTERVALO_MS 100
+
+// Deadlines perdidos seguidos que levam a cada nível (0 = nível desligado)
+#define SUPERVISOR_AVISO_PADRAO 5
+#define SUPERVISOR_DEGRADAR_PADRAO 20
+#define SUPERVISOR_PARQUE_PADRAO 100
+
+// Ticks em dia seguidos para voltar ao nível normal
+#define SUPERVISOR_TICKS_RECUPERACAO 50
+
+// No nível degradado as métricas são publicadas 1 vez a cada N ticks
+#define SUPERVISOR_DIVISOR_METRICAS 10
+
+// Níveis da escalada
+typedef enum {
+    SUPERVISOR_NORMAL,
+    SUPERVISOR_AVISO,           // Só registra o evento
+    SUPERVISOR_DEGRADADO,       // Sem registro de passos, métricas espaçadas
+    SUPERVISOR_PARQUE           // Encerramento pedido: os servos estacionam
+} NivelSupervisor;
+
+// Configuração do supervisor
+typedef struct {
+    const char *watchdog;       // Dispositivo do watchdog (NULL = sem)
+    long prazo_ms;              // Prazo do batimento
+    int limites[3];             // Aviso, degradação e parque (ver acima)
+} ConfigSupervisor;
+
+// Supervisor do laço de controle.
+// O laço bate a cada tick: grava o instante no relógio monotônico real
+// (uma leitura do vDSO e um store atômico) e compara os overruns do
+// agendador com os do tick anterior. Deadlines perdidos em ticks
+// seguidos sobem a escalada: aviso, depois degradação (os passos deixam de
+// entrar na fila de registro e as métricas são publicadas a cada
+// SUPERVISOR_DIVISOR_METRICAS ticks) e por fim o estacionamento, pedido
+// com um SIGTERM ao próprio processo, que segue o caminho normal do
+// encerramento. Ticks em dia desfazem o aviso e a degradação.
+// Uma thread à parte, no escalonamento normal (não rebaixada: é ela que
+// precisa rodar quando o resto está sobrecarregado), confere a idade do
+// batimento. Enquanto ele é recente, alimenta o watchdog de hardware e,
+// sob o systemd com WatchdogSec, manda WATCHDOG=1 pelo NOTIFY_SOCKET.
+// Se o laço passar do prazo sem bater (preso em uma escrita, por
+// exemplo), o travamento é avisado e as duas alimentações param: o
+// watchdog reinicia a placa e o systemd reinicia o serviço. Um laço que
+// espera eventos sem prazo (o servidor parado) suspende o batimento, e
+// uma etapa longa conhecida (o estacionamento) o renova com folga.
+typedef struct {
+    _Alignas(64) _Atomic long long batimento_ns;    // 0 = suspenso
+
+    // Estado da escalada (só o laço de controle)
+    FilaRegistro *log;
+    Metricas *metricas;             // NULL = sem exportador
+    unsigned long overruns_vistos;
+    unsigned long perdas_seguidas;  // Deadlines perdidos em ticks seguidos
+    int ticks_em_dia;
+    NivelSupervisor nivel;
+    int limites[3];
+    unsigned long degradacoes;
+    unsigned long pior_sequencia;
+
+    // Thread do supervisor
+    long long prazo_ns;
+    int fd_watchdog;                // -1 = sem watchdog de hardware
+    int timeout_watchdog;           // s
+    int fd_notificacao;             // -1 = fora do systemd
+    struct sockaddr_un endereco;
+    socklen_t tamanho_endereco;
+    long long intervalo_systemd_ns; // Metade do WATCHDOG_USEC (0 = sem)
+    int travado;                    // 1 = batimento vencido
+    atomic_int ativo;               // 1 = thread do supervisor rodando
+    pthread_t thread;
+    unsigned long travamentos;
+} Supervisor;
+
+// Interpreta "AVISO:DEGRADAR:PARQUE" (deadlines perdidos seguidos; 0
+// desliga o nível); retorna 0 ou -1
+int interpretarEscalada(const char *texto, int limites[3]);
+
+// Abre o watchdog e o NOTIFY_SOCKET, cria a thread e avisa READY=1 ao
+// systemd; retorna 0 ou -1
+int iniciarSupervisor(Supervisor *s, const ConfigSupervisor *cfg,
+                      FilaRegistro *log, Metricas *metricas);
+
+// Batimento de um tick, com a escalada dos deadlines perdidos
+void baterSupervisorTick(Supervisor *s, const Agendador *ag);
+
+// Instante atual no relógio monotônico real (ns)
+static inline long long agoraSupervisor(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (long long)t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+// Atalho para os laços, em que o supervisor é opcional
+static inline void baterSupervisor(Supervisor *s, const Agendador *ag) {
+    if (s) {
+        baterSupervisorTick(s, ag);
+    }
+}
+
+// Bate sem tick; com folga_ns, o laço tem esse tempo a mais até o
+// próximo batimento (uma etapa longa conhecida)
+static inline void renovarSupervisor(Supervisor *s, long long folga_ns) {
+    if (s) {
+        atomic_store_explicit(&s->batimento_ns, agoraSupervisor() + folga_ns,
+                              memory_order_relaxed);
+    }
+}
+
+// Suspende o batimento antes de uma espera sem prazo
+static inline void suspenderSupervisor(Supervisor *s) {
+    if (s) {
+        atomic_store_explicit(&s->batimento_ns, 0, memory_order_relaxed);
+    }
+}
+
+// Encerra a thread, desarma o watchdog (escrita do 'V') e avisa
+// STOPPING=1 ao systemd
+void fecharSupervisor(Supervisor *s);
+
+#endif
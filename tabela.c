@@ -0,0 +1,31 @@
+#include <stdio.h>
+
+#include "tabela.h"
+
+// Função para converter duty cycle em ângulo (0-180°)
+int dutyParaAngulo(int duty_cycle, int duty_min, int duty_max) {
+    return ((duty_cycle - duty_min) * ANGULO_MAX) / (duty_max - duty_min);
+}
+
+// Função para preencher um passo pré-calculado
+void preencherPasso(PassoTabela *p, int duty, const TabelaCalibracao *tabela) {
+    p->duty = duty;
+    p->angulo = (int16_t)dutyParaAngulo(duty, tabela->duty_min, tabela->duty_max);
+    p->len = (uint8_t)formatarInteiro(p->texto, duty);
+}
+
+// Função para montar a tabela de calibração
+int construirTabela(TabelaCalibracao *tabela, int duty_min, int duty_max) {
+    if (duty_max <= duty_min) {
+        fprintf(stderr, "Calibração inválida: %d a %d ns\n", duty_min, duty_max);
+        return -1;
+    }
+
+    tabela->duty_min = duty_min;
+    tabela->duty_max = duty_max;
+    for (int a = 0; a <= ANGULO_MAX; a++) {
+        tabela->duty_por_angulo[a] =
+            duty_min + (int)((long long)a * (duty_max - duty_min) / ANGULO_MAX);
+    }
+    return 0;
+}
@@ -0,0 +1,45 @@
+#ifndef TABELA_H
+#define TABELA_H
+
+#include <stdint.h>
+
+#include "pwm.h"
+
+// Faixa angular do servomotor
+#define ANGULO_MAX 180
+
+// Um passo pré-calculado de uma trajetória
+typedef struct {
+    int32_t duty;                   // Duty cycle em nanosegundos
+    int16_t angulo;                 // Ângulo correspondente (0-180°)
+    uint8_t len;                    // Tamanho do texto do duty
+    char texto[PWM_TAM_VALOR];      // Duty já formatado para o sysfs
+} PassoTabela;
+
+// Calibração de um servo e tabela inversa ângulo -> duty.
+// É montada uma única vez antes do laço de controle; os passos das
+// trajetórias são preenchidos a partir dela já com ângulo e o texto
+// pronto para o pwrite(), sem divisões nem formatação no laço.
+typedef struct {
+    int duty_min;
+    int duty_max;
+    int32_t duty_por_angulo[ANGULO_MAX + 1];
+} TabelaCalibracao;
+
+// Converte duty cycle em ângulo (0-180°) para a calibração informada
+int dutyParaAngulo(int duty_cycle, int duty_min, int duty_max);
+
+// Monta a tabela de calibração entre duty_min e duty_max
+int construirTabela(TabelaCalibracao *tabela, int duty_min, int duty_max);
+
+// Preenche um passo (ângulo e texto) para o duty informado
+void preencherPasso(PassoTabela *p, int duty, const TabelaCalibracao *tabela);
+
+// Consulta inversa: duty cycle que posiciona o servo no ângulo informado
+static inline int anguloParaDuty(const TabelaCalibracao *tabela, int angulo) {
+    if (angulo < 0) angulo = 0;
+    if (angulo > ANGULO_MAX) angulo = ANGULO_MAX;
+    return tabela->duty_por_angulo[angulo];
+}
+
+#endif
@@ -0,0 +1,105 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "tempo_real.h"
+
+// Argumentos repassados para a thread de tempo real
+typedef struct {
+    void *(*funcao)(void *);
+    void *arg;
+} ArgsThreadRT;
+
+// Função para descobrir um núcleo isolado do escalonador
+int cpuIsolada(void) {
+    FILE *fp = fopen("/sys/devices/system/cpu/isolated", "r");
+    int cpu = -1;
+
+    if (fp == NULL) {
+        return -1;
+    }
+    if (fscanf(fp, "%d", &cpu) != 1) {
+        cpu = -1;
+    }
+    fclose(fp);
+    return cpu;
+}
+
+// Toca cada página da pilha para evitar page faults no laço de controle
+static void prefaultPilha(void) {
+    volatile unsigned char pilha[PILHA_RT_PREFAULT];
+    long pagina = sysconf(_SC_PAGESIZE);
+
+    for (long i = 0; i < PILHA_RT_PREFAULT; i += pagina) {
+        pilha[i] = 0;
+    }
+    (void)pilha[0];
+}
+
+// Corpo da thread de tempo real
+static void *threadTempoReal(void *p) {
+    ArgsThreadRT *args = p;
+
+    prefaultPilha();
+    return args->funcao(args->arg);
+}
+
+// Função para executar o laço de controle com ou sem tempo real
+int executarTempoReal(const ConfigTempoReal *cfg,
+                      void *(*funcao)(void *), void *arg) {
+    if (!cfg->ativo) {
+        funcao(arg);
+        return 0;
+    }
+
+    // Travar as páginas atuais e futuras na RAM
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+        perror("Aviso: mlockall falhou, seguindo sem tempo real");
+        funcao(arg);
+        return 0;
+    }
+
+    int cpu = cfg->cpu >= 0 ? cfg->cpu : cpuIsolada();
+    if (cpu < 0) {
+        cpu = (int)sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    }
+
+    pthread_attr_t attr;
+    struct sched_param param;
+    cpu_set_t cpus;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = cfg->prioridade;
+    pthread_attr_setschedparam(&attr, &param);
+    pthread_attr_setstacksize(&attr, PTHREAD_STACK_MIN + 2 * PILHA_RT_PREFAULT);
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+
+    ArgsThreadRT args = { funcao, arg };
+    pthread_t thread;
+    int ret = pthread_create(&thread, &attr, threadTempoReal, &args);
+    pthread_attr_destroy(&attr);
+
+    if (ret != 0) {
+        fprintf(stderr, "Aviso: thread SCHED_FIFO indisponível (%s), "
+                "seguindo sem tempo real\n", strerror(ret));
+        munlockall();
+        funcao(arg);
+        return 0;
+    }
+
+    printf("Modo tempo real: SCHED_FIFO prioridade %d na CPU %d\n",
+           cfg->prioridade, cpu);
+    pthread_setname_np(thread, "servo_rt");
+    pthread_join(thread, NULL);
+    return 0;
+}
@@ -0,0 +1,28 @@
+#ifndef TEMPO_REAL_H
+#define TEMPO_REAL_H
+
+// Prioridade SCHED_FIFO padrão da thread de controle
+#define PRIORIDADE_RT_PADRAO 80
+
+// Quanto da pilha da thread de controle é pré-faltado (em bytes)
+#define PILHA_RT_PREFAULT (64 * 1024)
+
+// Configuração do modo de tempo real
+typedef struct {
+    int ativo;          // 1 = executar o laço em uma thread SCHED_FIFO
+    int prioridade;     // Prioridade SCHED_FIFO (1-99)
+    int cpu;            // Núcleo para fixar a thread (-1 = escolher isolado)
+} ConfigTempoReal;
+
+// Retorna o primeiro núcleo listado em isolated (isolcpus) ou -1
+int cpuIsolada(void);
+
+// Executa funcao(arg) até o fim.
+// Com cfg->ativo, trava a memória (mlockall), cria uma thread SCHED_FIFO
+// fixada no núcleo escolhido e pré-falta a pilha antes de chamar funcao.
+// Se faltar permissão para qualquer passo, avisa e executa funcao na thread
+// atual com o escalonamento normal.
+int executarTempoReal(const ConfigTempoReal *cfg,
+                      void *(*funcao)(void *), void *arg);
+
+#endif
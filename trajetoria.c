@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "trajetoria.h"
+
+// Subpassos de integração da velocidade dentro de um tick
+#define SUBPASSOS 32
+
+// Parâmetros de um movimento já planejado
+typedef struct {
+    TipoPerfil tipo;
+    double v_pico;          // Velocidade de cruzeiro alcançada
+    double a_pico;          // Aceleração máxima alcançada
+    double t_jerk;          // Duração das rampas de aceleração (S-curve)
+    double t_acel;          // Duração da aceleração (= desaceleração)
+    double t_cruzeiro;      // Duração em velocidade constante
+    double total;
+} Plano;
+
+static const char *const NOMES_PERFIL[] = { "linear", "trapezoidal", "scurve" };
+
+// Função para converter o nome do perfil
+int interpretarPerfil(const char *nome, TipoPerfil *tipo) {
+    for (int i = 0; i <= PERFIL_SCURVE; i++) {
+        if (strcmp(nome, NOMES_PERFIL[i]) == 0) {
+            *tipo = (TipoPerfil)i;
+            return 0;
+        }
+    }
+    fprintf(stderr, "Perfil inválido: '%s' (linear, trapezoidal ou scurve)\n", nome);
+    return -1;
+}
+
+// Função para obter o nome do perfil
+const char *nomePerfil(TipoPerfil tipo) {
+    return NOMES_PERFIL[tipo];
+}
+
+// Aceleração S-curve de 0 até v: preenche a_pico, t_jerk e t_acel e
+// retorna a distância percorrida (a curva é simétrica, velocidade média v/2)
+static double acelerarSCurve(const PerfilMovimento *perfil, double v, Plano *pl) {
+    double a = perfil->acel_max;
+    double j = perfil->jerk_max;
+
+    if (v >= a * a / j) {
+        pl->a_pico = a;
+        pl->t_jerk = a / j;
+        pl->t_acel = v / a + pl->t_jerk;
+    } else {
+        pl->a_pico = sqrt(v * j);
+        pl->t_jerk = pl->a_pico / j;
+        pl->t_acel = 2.0 * pl->t_jerk;
+    }
+    return v * pl->t_acel / 2.0;
+}
+
+// Planeja o movimento de menor duração que respeita os limites do perfil
+static void planejar(const PerfilMovimento *perfil, double d, Plano *pl) {
+    double v = perfil->vel_max;
+    double a = perfil->acel_max;
+
+    memset(pl, 0, sizeof(*pl));
+    pl->tipo = perfil->tipo;
+
+    switch (perfil->tipo) {
+    case PERFIL_LINEAR:
+        pl->v_pico = v;
+        pl->t_cruzeiro = d / v;
+        break;
+
+    case PERFIL_TRAPEZOIDAL:
+        // Triangular quando não há distância para chegar a vel_max
+        pl->v_pico = d >= v * v / a ? v : sqrt(d * a);
+        pl->a_pico = a;
+        pl->t_acel = pl->v_pico / a;
+        pl->t_cruzeiro = (d - pl->v_pico * pl->t_acel) / pl->v_pico;
+        break;
+
+    case PERFIL_SCURVE:
+        if (2.0 * acelerarSCurve(perfil, v, pl) > d) {
+            // Busca a maior velocidade de pico que cabe na distância
+            double baixo = 0.0, alto = v;
+            for (int i = 0; i < 60; i++) {
+                double meio = (baixo + alto) / 2.0;
+                if (2.0 * acelerarSCurve(perfil, meio, pl) > d) {
+                    alto = meio;
+                } else {
+                    baixo = meio;
+                }
+            }
+            v = baixo;
+        }
+        pl->v_pico = v;
+        pl->t_cruzeiro = (d - 2.0 * acelerarSCurve(perfil, v, pl)) / v;
+        break;
+    }
+
+    if (pl->t_cruzeiro < 0.0) {
+        pl->t_cruzeiro = 0.0;
+    }
+    pl->total = 2.0 * pl->t_acel + pl->t_cruzeiro;
+}
+
+// Velocidade durante a fase de aceleração, t em [0, t_acel]
+static double velocidadeAcelerando(const Plano *pl, double t) {
+    if (pl->tipo == PERFIL_TRAPEZOIDAL) {
+        return pl->v_pico * t / pl->t_acel;
+    }
+
+    double j = pl->a_pico / pl->t_jerk;
+    if (t < pl->t_jerk) {
+        return j * t * t / 2.0;
+    }
+    if (t < pl->t_acel - pl->t_jerk) {
+        return j * pl->t_jerk * pl->t_jerk / 2.0 + pl->a_pico * (t - pl->t_jerk);
+    }
+    double r = pl->t_acel - t;
+    return pl->v_pico - j * r * r / 2.0;
+}
+
+// Velocidade do movimento no instante t
+static double velocidade(const Plano *pl, double t) {
+    if (t < 0.0 || t >= pl->total) {
+        return 0.0;
+    }
+    if (t < pl->t_acel) {
+        return velocidadeAcelerando(pl, t);
+    }
+    if (t < pl->t_acel + pl->t_cruzeiro) {
+        return pl->v_pico;
+    }
+    return velocidadeAcelerando(pl, pl->total - t);
+}
+
+// Função para calcular a duração de um movimento
+double duracaoMovimento(const PerfilMovimento *perfil, double distancia) {
+    Plano pl;
+
+    if (distancia <= 0.0) {
+        return 0.0;
+    }
+    planejar(perfil, distancia, &pl);
+    return pl.total;
+}
+
+// Função para escalar o perfil para uma duração fixa
+int escalarPerfil(PerfilMovimento *perfil, double distancia, double duracao) {
+    double atual = duracaoMovimento(perfil, distancia);
+
+    if (duracao <= 0.0 || atual <= 0.0) {
+        fprintf(stderr, "Duração inválida: %.3fs\n", duracao);
+        return -1;
+    }
+
+    // Reduzir o tempo por k multiplica a velocidade por k, a aceleração
+    // por k² e o jerk por k³, mantendo a forma do perfil
+    double k = atual / duracao;
+    perfil->vel_max *= k;
+    perfil->acel_max *= k * k;
+    perfil->jerk_max *= k * k * k;
+    return 0;
+}
+
+// Função para amostrar a fração percorrida a cada tick
+int amostrarPerfil(double *fracoes, const PerfilMovimento *perfil, double distancia,
+                   long periodo_ns) {
+    double dt = periodo_ns / 1e9;
+    Plano pl;
+
+    if (perfil->vel_max <= 0.0 ||
+        (perfil->tipo != PERFIL_LINEAR && perfil->acel_max <= 0.0) ||
+        (perfil->tipo == PERFIL_SCURVE && perfil->jerk_max <= 0.0)) {
+        fprintf(stderr, "Limites do perfil %s inválidos\n", nomePerfil(perfil->tipo));
+        return -1;
+    }
+
+    planejar(perfil, distancia, &pl);
+    int n = distancia > 0.0 ? (int)ceil(pl.total / dt - 1e-9) : 0;
+    if (n + 1 > TRAJETORIA_TICKS_MAX) {
+        fprintf(stderr, "Movimento de %.1f° leva %d ticks (máximo %d)\n",
+                distancia, n + 1, TRAJETORIA_TICKS_MAX);
+        return -1;
+    }
+
+    // Integra a velocidade com subpassos e guarda a posição de cada tick
+    double pos = 0.0;
+    double h = dt / SUBPASSOS;
+    fracoes[0] = 0.0;
+    for (int k = 1; k <= n; k++) {
+        for (int s = 0; s < SUBPASSOS; s++) {
+            pos += velocidade(&pl, (k - 1) * dt + (s + 0.5) * h) * h;
+        }
+        fracoes[k] = pos;
+    }
+
+    // Normaliza para terminar exatamente no alvo
+    for (int k = 1; k <= n; k++) {
+        fracoes[k] /= pos;
+    }
+    return n + 1;
+}
+
+// Função para gerar os passos de um movimento
+int gerarTrajetoria(Trajetoria *traj, const PerfilMovimento *perfil,
+                    const TabelaCalibracao *cal, double angulo_inicio,
+                    double angulo_fim, long periodo_ns) {
+    double ns_por_grau = (double)(cal->duty_max - cal->duty_min) / ANGULO_MAX;
+    double fracoes[TRAJETORIA_TICKS_MAX];
+
+    int n = amostrarPerfil(fracoes, perfil, fabs(angulo_fim - angulo_inicio), periodo_ns);
+    if (n < 0) {
+        return -1;
+    }
+    for (int k = 0; k < n; k++) {
+        double angulo = angulo_inicio + (angulo_fim - angulo_inicio) * fracoes[k];
+        int duty = cal->duty_min + (int)lround(angulo * ns_por_grau);
+        preencherPasso(&traj->passos[k], duty, cal);
+    }
+    traj->num_ticks = n;
+    return 0;
+}
@@ -0,0 +1,63 @@
+#ifndef TRAJETORIA_H
+#define TRAJETORIA_H
+
+#include "tabela.h"
+
+// Maior número de ticks em um movimento (512 x 20ms = 10,24s)
+#define TRAJETORIA_TICKS_MAX 512
+
+// Limites padrão dos perfis (graus/s, graus/s², graus/s³)
+#define VEL_MAX_PADRAO 180.0
+#define ACEL_MAX_PADRAO 540.0
+#define JERK_MAX_PADRAO 5400.0
+
+// Perfis de movimento suportados
+typedef enum {
+    PERFIL_LINEAR,          // Velocidade constante, partida e parada instantâneas
+    PERFIL_TRAPEZOIDAL,     // Aceleração limitada
+    PERFIL_SCURVE           // Aceleração e jerk limitados
+} TipoPerfil;
+
+// Perfil de movimento e limites mecânicos
+typedef struct {
+    TipoPerfil tipo;
+    double vel_max;         // graus/s
+    double acel_max;        // graus/s² (trapezoidal e S-curve)
+    double jerk_max;        // graus/s³ (S-curve)
+} PerfilMovimento;
+
+// Sequência de duty por tick de um movimento, já pronta para o pwrite().
+// O laço de controle apenas reproduz os passos em ordem.
+typedef struct {
+    int num_ticks;
+    PassoTabela passos[TRAJETORIA_TICKS_MAX];
+} Trajetoria;
+
+// Converte o nome do perfil (linear, trapezoidal, scurve)
+int interpretarPerfil(const char *nome, TipoPerfil *tipo);
+
+// Nome do perfil para mensagens
+const char *nomePerfil(TipoPerfil tipo);
+
+// Duração mínima (s) de um movimento de distancia graus com o perfil
+double duracaoMovimento(const PerfilMovimento *perfil, double distancia);
+
+// Ajusta os limites do perfil para que um movimento de distancia graus
+// dure exatamente duracao segundos (escala de tempo: v*k, a*k², j*k³)
+int escalarPerfil(PerfilMovimento *perfil, double distancia, double duracao);
+
+// Amostra a cada periodo_ns a fração do percurso (0 a 1) de um movimento
+// de distancia graus com o perfil: a primeira é 0 e a última exatamente 1.
+// A mesma curva serve a qualquer eixo que percorra uma distância menor no
+// mesmo tempo. Retorna o número de ticks ou -1
+int amostrarPerfil(double *fracoes, const PerfilMovimento *perfil, double distancia,
+                   long periodo_ns);
+
+// Gera os passos de angulo_inicio a angulo_fim amostrados a cada
+// periodo_ns; o primeiro passo é a posição inicial e o último é
+// exatamente o alvo
+int gerarTrajetoria(Trajetoria *traj, const PerfilMovimento *perfil,
+                    const TabelaCalibracao *cal, double angulo_inicio,
+                    double angulo_fim, long periodo_ns);
+
+#endif